@@ -30,12 +30,27 @@ function(a_add_executable name)
             if (NOT "${fdir}" STREQUAL "")
                 set(fdir "${fdir}/")
             endif ()
-            add_custom_target("${fdir_u}${fname}${fext}.aet"
-                    COMMAND ameshc -i "${fabs}.aet.meta" -o "${fdir}${fname}${fext}.aet" -m "${fabs}"
-                    SOURCES ${file} ${file}.aet.meta)
+            # A "shader" entry in the meta file compiles the mesh for that shader's vertex layout.
+            file(READ "${fabs}.aet.meta" fmeta)
+            string(JSON fshader ERROR_VARIABLE fshader_missing GET "${fmeta}" "shader")
+            if (fshader_missing)
+                add_custom_target("${fdir_u}${fname}${fext}.aet"
+                        COMMAND ameshc -i "${fabs}.aet.meta" -o "${fdir}${fname}${fext}.aet" -m "${fabs}"
+                        SOURCES ${file} ${file}.aet.meta)
+                list(APPEND ASSET_DEPENDENCIES "${fdir_u}${fname}${fext}.aet")
+                list(APPEND ASSET_PATHS_RELATIVE "${fdir}${fname}${fext}.aet")
+            else ()
+                get_filename_component(fabs_dir "${fabs}" DIRECTORY)
+                get_filename_component(fshader_abs "${fshader}" ABSOLUTE BASE_DIR "${fabs_dir}")
+                add_custom_target("${fdir_u}${fname}${fext}.amesh"
+                        COMMAND ashaderc -i "${fshader_abs}" -o "${fdir}${fname}${fext}.layout.aet"
+                        COMMAND ameshc -i "${fabs}.aet.meta" -o "${fdir}${fname}${fext}.amesh" -m "${fabs}"
+                                -s "${fdir}${fname}${fext}.layout.aet"
+                        SOURCES ${file} ${file}.aet.meta ${fshader_abs})
+                list(APPEND ASSET_DEPENDENCIES "${fdir_u}${fname}${fext}.amesh")
+                list(APPEND ASSET_PATHS_RELATIVE "${fdir}${fname}${fext}.amesh")
+            endif ()
             file(COPY "${fabs}" DESTINATION "${fdir}")
-            list(APPEND ASSET_DEPENDENCIES "${fdir_u}${fname}${fext}.aet")
-            list(APPEND ASSET_PATHS_RELATIVE "${fdir}${fname}${fext}.aet")
         elseif ("${fext}" STREQUAL ".png" OR
                 "${fext}" STREQUAL ".jpg" OR
                 "${fext}" STREQUAL ".jpeg")
@@ -57,6 +72,6 @@ function(a_add_executable name)
     add_executable(${name} ${SOURCE})
     target_link_libraries(${name} PUBLIC aurora)
 
-    add_custom_target(${name}_index COMMAND amkindex -o assets.idx.aet -i ${ASSET_PATHS_RELATIVE} DEPENDS ${ASSET_DEPENDENCIES})
+    add_custom_target(${name}_index COMMAND amkpack -o assets.apack -i ${ASSET_PATHS_RELATIVE} DEPENDS ${ASSET_DEPENDENCIES})
     add_dependencies(${name} ${name}_index;${ASSET_DEPENDENCIES})
 endfunction()
@@ -0,0 +1,126 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "aether.h"
+#include "profiler.h"
+#include <cstring>
+#include <fstream>
+
+namespace aurora::aether {
+	namespace {
+		size_t idPadding(size_t pIdLength) {
+			return (16 - (sizeof(CompiledMesh::Header) + pIdLength) % 16) % 16;
+		}
+	}
+
+	CompiledMesh::CompiledMesh(std::string pId, const OptimisedMesh &pMesh, const Shader &pShader,
+	                           const Bounds &pBounds)
+		: id(std::move(pId)) {
+		AURORA_PROFILE_ZONE("CompiledMesh");
+
+		uint32_t stride = 0;
+		for(const auto &item: pShader.vertexNodes) { stride += item.size * sizeof(float); }
+		if(stride == 0) { throw std::runtime_error("shader has no vertex inputs"); }
+
+		auto vertexCount = pMesh.vertexData.size() * sizeof(float) / stride;
+		bool shortIndices = vertexCount <= UINT16_MAX + 1;
+
+		header.idLength = static_cast<uint32_t>(id.size());
+		header.layoutHash = hashLayout(pShader);
+		header.vertexStride = stride;
+		header.vertexCount = static_cast<uint32_t>(vertexCount);
+		header.indexCount = static_cast<uint32_t>(pMesh.indexData.size());
+		header.indexSize = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+		for(int i = 0; i < 3; ++i) {
+			header.boundsMin[i] = pBounds.min[i];
+			header.boundsMax[i] = pBounds.max[i];
+		}
+
+		m_VertexOffset = sizeof(Header) + id.size() + idPadding(id.size());
+		m_Bytes.resize(m_VertexOffset + getVertexDataSize() + getIndexDataSize());
+		m_Data = m_Bytes;
+
+		std::memcpy(m_Bytes.data(), &header, sizeof(Header));
+		std::memcpy(m_Bytes.data() + sizeof(Header), id.data(), id.size());
+		std::memcpy(m_Bytes.data() + m_VertexOffset, pMesh.vertexData.data(), getVertexDataSize());
+
+		auto indices = m_Bytes.data() + m_VertexOffset + getVertexDataSize();
+		if(shortIndices) {
+			for(size_t i = 0; i < pMesh.indexData.size(); ++i) {
+				auto index = static_cast<uint16_t>(pMesh.indexData[i]);
+				std::memcpy(indices + i * sizeof(uint16_t), &index, sizeof(uint16_t));
+			}
+		} else {
+			std::memcpy(indices, pMesh.indexData.data(), getIndexDataSize());
+		}
+	}
+
+	CompiledMesh::CompiledMesh(std::vector<uint8_t> pBytes) : m_Bytes(std::move(pBytes)), m_Data(m_Bytes) {
+		parse();
+	}
+
+	CompiledMesh::CompiledMesh(AssetLoader *, const AssetSource &pSource, const std::string &) {
+		if(pSource.isBorrowed()) { m_Data = pSource.getData(); }
+		else {
+			m_Bytes.assign(pSource.getData().begin(), pSource.getData().end());
+			m_Data = m_Bytes;
+		}
+
+		parse();
+	}
+
+	void CompiledMesh::parse() {
+		if(m_Data.size() < sizeof(Header)) { throw std::runtime_error("compiled mesh is truncated"); }
+		std::memcpy(&header, m_Data.data(), sizeof(Header));
+
+		if(header.magic != fileMagic) { throw std::runtime_error("not a compiled mesh"); }
+		if(header.version != fileVersion) {
+			throw std::runtime_error("unsupported compiled mesh version " + std::to_string(header.version));
+		}
+		if(header.indexSize != sizeof(uint16_t) && header.indexSize != sizeof(uint32_t)) {
+			throw std::runtime_error("invalid compiled mesh index size");
+		}
+
+		m_VertexOffset = sizeof(Header) + header.idLength + idPadding(header.idLength);
+		if(m_Data.size() < m_VertexOffset + getVertexDataSize() + getIndexDataSize()) {
+			throw std::runtime_error("compiled mesh is truncated");
+		}
+
+		id = std::string(reinterpret_cast<const char *>(m_Data.data() + sizeof(Header)), header.idLength);
+	}
+
+	uint32_t CompiledMesh::hashLayout(const Shader &pShader) {
+		// FNV-1a over every vertex node; the names are irrelevant to the data layout.
+		uint32_t hash = 2166136261u;
+		auto feed = [&hash](const std::string &pString) {
+			for(auto c: pString) {
+				hash ^= static_cast<uint8_t>(c);
+				hash *= 16777619u;
+			}
+			hash ^= 0xff;
+			hash *= 16777619u;
+		};
+
+		for(const auto &item: pShader.vertexNodes) {
+			feed(item.type);
+			feed(item.from);
+			feed(std::to_string(item.size));
+		}
+
+		return hash;
+	}
+
+	std::string CompiledMesh::readId(const std::filesystem::path &pPath) {
+		std::ifstream in(pPath, std::ios::binary);
+		Header h;
+		if(!in.read(reinterpret_cast<char *>(&h), sizeof(Header)) || h.magic != fileMagic) {
+			throw std::runtime_error("not a compiled mesh: " + pPath.string());
+		}
+
+		std::string id(h.idLength, '\0');
+		in.read(id.data(), h.idLength);
+		return id;
+	}
+}
@@ -4,9 +4,20 @@
  */
 
 #include "aether.h"
-#include <fstream>
 
 namespace aurora::aether {
+	Bounds Bounds::of(const std::vector<glm::vec3> &pPoints) {
+		if(pPoints.empty()) { return {}; }
+
+		Bounds b{pPoints[0], pPoints[0]};
+		for(const auto &item: pPoints) {
+			b.min = glm::min(b.min, item);
+			b.max = glm::max(b.max, item);
+		}
+
+		return b;
+	}
+
 	Mesh::Mesh(const nlohmann::json &pJson) : Resource(pJson) {
 		for(const auto &item: pJson[".p"]) {
 			positions.emplace_back(item[0], item[1], item[2]);
@@ -33,6 +44,13 @@ namespace aurora::aether {
 			tri.normalVertices[2] = item[8];
 			tris.emplace_back(tri);
 		}
+
+		if(pJson.contains(".b")) {
+			const auto &b = pJson[".b"];
+			bounds = {{b[0], b[1], b[2]}, {b[3], b[4], b[5]}};
+		} else {
+			bounds = Bounds::of(positions);
+		}
 	}
 
 	nlohmann::json Mesh::serialize() {
@@ -81,10 +99,18 @@ namespace aurora::aether {
 		j[".t"] = t;
 		j[".n"] = n;
 		j[".tris"] = ta;
+		j[".b"] = nlohmann::json::array({
+			                                bounds.min.x,
+			                                bounds.min.y,
+			                                bounds.min.z,
+			                                bounds.max.x,
+			                                bounds.max.y,
+			                                bounds.max.z
+		                                });
 
 		return j;
 	}
 
-	Mesh::Mesh(AssetLoader *, const std::filesystem::path &pPath, const std::string &)
-		: Mesh(nlohmann::json::from_cbor(std::ifstream(pPath))) {}
+	Mesh::Mesh(AssetLoader *, const AssetSource &pSource, const std::string &)
+		: Mesh(pSource.readCbor()) {}
 }
@@ -4,16 +4,22 @@
  */
 
 #include "aether.h"
+#include "profiler.h"
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
 
 namespace aurora::aether {
-	OptimisedMesh::OptimisedMesh(const Mesh &pMesh, const Shader &pShader, const glm::vec4 &pColor) {
+	namespace {
 		struct Vertex {
 			glm::vec3 position;
 			glm::vec2 texCoord;
 			glm::vec3 normal;
 
 			Vertex(const glm::vec3 &pPosition, const glm::vec2 &pTexCoord, const glm::vec3 &pNormal)
-				: position(pPosition), texCoord(pTexCoord), normal(pNormal) {}
+				// Adding zero folds -0.0 into +0.0 so that equal vertices also hash equally.
+				: position(pPosition + 0.0f), texCoord(pTexCoord + 0.0f), normal(pNormal + 0.0f) {}
 
 			bool operator==(const Vertex &pRhs) const {
 				return position == pRhs.position &&
@@ -24,65 +30,226 @@ namespace aurora::aether {
 			bool operator!=(const Vertex &pRhs) const {
 				return !(pRhs == *this);
 			}
+
+			[[nodiscard]] bool isNear(const Vertex &pRhs, float pEpsilon) const {
+				auto p = glm::abs(position - pRhs.position);
+				auto t = glm::abs(texCoord - pRhs.texCoord);
+				auto n = glm::abs(normal - pRhs.normal);
+				return p.x <= pEpsilon && p.y <= pEpsilon && p.z <= pEpsilon &&
+				       t.x <= pEpsilon && t.y <= pEpsilon &&
+				       n.x <= pEpsilon && n.y <= pEpsilon && n.z <= pEpsilon;
+			}
 		};
 
-		std::vector<Vertex> vertices;
-		for(const auto &item: pMesh.tris) {
-			for(int i = 0; i < 3; ++i) {
-				auto vtx = Vertex(pMesh.positions[item.vertices[i]],
-				                  pMesh.texCoords[item.texVertices[i]],
-				                  pMesh.normals[item.normalVertices[i]]);
-				auto iter = vertices.begin(), end = vertices.end();
-
-				bool done = false;
-
-				for(int j = 0; iter != end; iter++, j++) {
-					if(*iter == vtx) {
-						indexData.emplace_back(j);
-						done = true;
-						break;
-					}
+		inline size_t hashCombine(size_t pSeed, uint32_t pValue) {
+			return pSeed ^ (pValue + 0x9e3779b9 + (pSeed << 6) + (pSeed >> 2));
+		}
+
+		struct VertexHash {
+			size_t operator()(const Vertex &pVertex) const {
+				const float values[8]{
+					pVertex.position.x,
+					pVertex.position.y,
+					pVertex.position.z,
+					pVertex.texCoord.s,
+					pVertex.texCoord.t,
+					pVertex.normal.x,
+					pVertex.normal.y,
+					pVertex.normal.z
+				};
+
+				size_t seed = 0;
+				for(float value: values) { seed = hashCombine(seed, std::bit_cast<uint32_t>(value)); }
+				return seed;
+			}
+		};
+
+		/*
+		 * A cell of the weld grid. Coordinates are 64-bit and clamped, so that
+		 * a large position or a tiny epsilon cannot overflow the conversion
+		 * from float; vertices clamped into the same cell are still told apart
+		 * by Vertex::isNear().
+		 */
+		struct Cell {
+			int64_t x, y, z;
+
+			bool operator==(const Cell &pRhs) const = default;
+		};
+
+		struct CellHash {
+			size_t operator()(const Cell &pCell) const {
+				size_t seed = 0;
+				for(auto value: {pCell.x, pCell.y, pCell.z}) {
+					seed = hashCombine(seed, static_cast<uint32_t>(value));
+					seed = hashCombine(seed, static_cast<uint32_t>(static_cast<uint64_t>(value) >> 32));
 				}
+				return seed;
+			}
+		};
+
+		int64_t cellCoordinate(float pValue, float pEpsilon) {
+			// Well inside int64_t, with room for the neighbouring cells. NaN
+			// fails both comparisons and ends up at the lower limit.
+			constexpr double limit = 1ll << 52;
+
+			auto cell = std::floor(static_cast<double>(pValue) / static_cast<double>(pEpsilon));
+			if(!(cell > -limit)) { cell = -limit; }
+			if(cell > limit) { cell = limit; }
+			return static_cast<int64_t>(cell);
+		}
 
-				if(!done) {
-					vertices.emplace_back(vtx);
-					indexData.emplace_back((uint32_t) vertices.size() - 1);
+		/*
+		 * Welds vertices that are bit-for-bit identical. This is the default
+		 * behaviour and matches what the exporter wrote out.
+		 */
+		void weldExact(const Mesh &pMesh, std::vector<Vertex> &pVertices, std::vector<uint32_t> &pIndices) {
+			std::unordered_map<Vertex, uint32_t, VertexHash> lookup;
+			lookup.reserve(pMesh.tris.size() * 3);
+
+			for(const auto &item: pMesh.tris) {
+				for(int i = 0; i < 3; ++i) {
+					Vertex vtx(pMesh.positions[item.vertices[i]],
+					           pMesh.texCoords[item.texVertices[i]],
+					           pMesh.normals[item.normalVertices[i]]);
+
+					auto [iter, inserted] = lookup.try_emplace(vtx, static_cast<uint32_t>(pVertices.size()));
+					if(inserted) { pVertices.emplace_back(vtx); }
+					pIndices.emplace_back(iter->second);
 				}
 			}
 		}
 
-		for(const auto &item: vertices) {
-			for(const auto &node: pShader.vertexNodes) {
-				if(node.type != "Float") {
-					throw std::runtime_error("Non-float input values are not supported by this class");
+		/*
+		 * Welds vertices whose attributes all lie within pEpsilon of each other.
+		 * Vertices are bucketed into a grid of pEpsilon-sized cells by position,
+		 * and only the 27 cells around a vertex are searched for a match, so the
+		 * expected cost stays linear in the vertex count.
+		 */
+		void weldNear(const Mesh &pMesh, float pEpsilon, std::vector<Vertex> &pVertices,
+		              std::vector<uint32_t> &pIndices) {
+			constexpr uint32_t end = UINT32_MAX;
+
+			std::unordered_map<Cell, uint32_t, CellHash> cells;
+			std::vector<uint32_t> next;
+			cells.reserve(pMesh.tris.size() * 3);
+			next.reserve(pMesh.tris.size() * 3);
+
+			auto cellOf = [pEpsilon](const glm::vec3 &pPosition) {
+				return Cell{cellCoordinate(pPosition.x, pEpsilon), cellCoordinate(pPosition.y, pEpsilon),
+				            cellCoordinate(pPosition.z, pEpsilon)};
+			};
+
+			for(const auto &item: pMesh.tris) {
+				for(int i = 0; i < 3; ++i) {
+					Vertex vtx(pMesh.positions[item.vertices[i]],
+					           pMesh.texCoords[item.texVertices[i]],
+					           pMesh.normals[item.normalVertices[i]]);
+
+					auto cell = cellOf(vtx.position);
+					auto found = end;
+
+					for(int dx = -1; dx <= 1 && found == end; ++dx) {
+						for(int dy = -1; dy <= 1 && found == end; ++dy) {
+							for(int dz = -1; dz <= 1 && found == end; ++dz) {
+								auto head = cells.find(Cell{cell.x + dx, cell.y + dy, cell.z + dz});
+								if(head == cells.end()) { continue; }
+
+								for(auto j = head->second; j != end; j = next[j]) {
+									if(pVertices[j].isNear(vtx, pEpsilon)) {
+										found = j;
+										break;
+									}
+								}
+							}
+						}
+					}
+
+					if(found == end) {
+						found = static_cast<uint32_t>(pVertices.size());
+						pVertices.emplace_back(vtx);
+
+						auto [head, inserted] = cells.try_emplace(cell, found);
+						next.emplace_back(inserted ? end : head->second);
+						head->second = found;
+					}
+
+					pIndices.emplace_back(found);
 				}
+			}
+		}
+
+		enum class VertexSource {
+			Position2,
+			Position3,
+			Color3,
+			Color4,
+			Tex1,
+			Tex2,
+			Tex3,
+		};
+
+		VertexSource parseVertexSource(const Shader::VertexNode &pNode) {
+			if(pNode.type != "Float") {
+				throw std::runtime_error("Non-float input values are not supported by this class");
+			}
+
+			if(pNode.from == "position2") { return VertexSource::Position2; }
+			else if(pNode.from == "position3") { return VertexSource::Position3; }
+			else if(pNode.from == "color3_rgb") { return VertexSource::Color3; }
+			else if(pNode.from == "color4_rgba") { return VertexSource::Color4; }
+			else if(pNode.from == "tex1") { return VertexSource::Tex1; }
+			else if(pNode.from == "tex2") { return VertexSource::Tex2; }
+			else if(pNode.from == "tex3") { return VertexSource::Tex3; }
+			else { throw std::runtime_error("Unsupported mesh input value " + pNode.from); }
+		}
+	}
+
+	OptimisedMesh::OptimisedMesh(const Mesh &pMesh, const Shader &pShader, const glm::vec4 &pColor,
+	                             float pWeldEpsilon) {
+		AURORA_PROFILE_ZONE("OptimisedMesh");
 
-				if(node.from == "position2") {
-					vertexData.emplace_back(item.position.x);
-					vertexData.emplace_back(item.position.y);
-				} else if(node.from == "position3") {
-					vertexData.emplace_back(item.position.x);
-					vertexData.emplace_back(item.position.y);
-					vertexData.emplace_back(item.position.z);
-				} else if(node.from == "color3_rgb") {
-					vertexData.emplace_back(pColor.r);
-					vertexData.emplace_back(pColor.g);
-					vertexData.emplace_back(pColor.b);
-				} else if(node.from == "color4_rgba") {
-					vertexData.emplace_back(pColor.r);
-					vertexData.emplace_back(pColor.g);
-					vertexData.emplace_back(pColor.b);
-					vertexData.emplace_back(pColor.a);
-				} else if(node.from == "tex1") {
-					vertexData.emplace_back(item.texCoord.s);
-				} else if(node.from == "tex2") {
-					vertexData.emplace_back(item.texCoord.s);
-					vertexData.emplace_back(item.texCoord.t);
-				} else if(node.from == "tex3") {
-					vertexData.emplace_back(item.texCoord.s);
-					vertexData.emplace_back(item.texCoord.t);
-					vertexData.emplace_back(item.texCoord.r);
-				} else { throw std::runtime_error("Unsupported mesh input value " + node.from); }
+		std::vector<Vertex> vertices;
+		vertices.reserve(pMesh.tris.size() * 3);
+		indexData.reserve(pMesh.tris.size() * 3);
+
+		if(pWeldEpsilon > 0) { weldNear(pMesh, pWeldEpsilon, vertices, indexData); }
+		else { weldExact(pMesh, vertices, indexData); }
+
+		// Resolve the layout once rather than comparing strings for every vertex.
+		std::vector<VertexSource> sources;
+		for(const auto &node: pShader.vertexNodes) {
+			sources.emplace_back(parseVertexSource(node));
+		}
+
+		for(const auto &item: vertices) {
+			for(auto source: sources) {
+				switch(source) {
+					case VertexSource::Position2: vertexData.emplace_back(item.position.x);
+						vertexData.emplace_back(item.position.y);
+						break;
+					case VertexSource::Position3: vertexData.emplace_back(item.position.x);
+						vertexData.emplace_back(item.position.y);
+						vertexData.emplace_back(item.position.z);
+						break;
+					case VertexSource::Color3: vertexData.emplace_back(pColor.r);
+						vertexData.emplace_back(pColor.g);
+						vertexData.emplace_back(pColor.b);
+						break;
+					case VertexSource::Color4: vertexData.emplace_back(pColor.r);
+						vertexData.emplace_back(pColor.g);
+						vertexData.emplace_back(pColor.b);
+						vertexData.emplace_back(pColor.a);
+						break;
+					case VertexSource::Tex1: vertexData.emplace_back(item.texCoord.s);
+						break;
+					case VertexSource::Tex2: vertexData.emplace_back(item.texCoord.s);
+						vertexData.emplace_back(item.texCoord.t);
+						break;
+					case VertexSource::Tex3: vertexData.emplace_back(item.texCoord.s);
+						vertexData.emplace_back(item.texCoord.t);
+						vertexData.emplace_back(item.texCoord.r);
+						break;
+				}
 			}
 		}
 	}
@@ -0,0 +1,156 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "aether.h"
+#include "profiler.h"
+#include <bit>
+#include <cstring>
+#include <unordered_set>
+
+namespace aurora::aether {
+	namespace {
+		uint64_t alignUp(uint64_t pValue, uint64_t pAlignment) {
+			return (pValue + pAlignment - 1) / pAlignment * pAlignment;
+		}
+
+		void writePadding(std::ostream &pOut, uint64_t pFrom, uint64_t pTo) {
+			static const char zeroes[Pack::payloadAlignment]{};
+			while(pFrom < pTo) {
+				auto count = std::min<uint64_t>(pTo - pFrom, sizeof(zeroes));
+				pOut.write(zeroes, static_cast<std::streamsize>(count));
+				pFrom += count;
+			}
+		}
+	}
+
+	uint64_t Pack::hashKey(std::string_view pKey) {
+		// 64-bit FNV-1a, with zero reserved to mark empty slots.
+		uint64_t hash = 14695981039346656037ull;
+		for(auto c: pKey) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash == 0 ? 1 : hash;
+	}
+
+	namespace {
+		// Whether [pOffset, pOffset + pSize) lies within pLimit, without overflowing.
+		bool inBounds(uint64_t pOffset, uint64_t pSize, uint64_t pLimit) {
+			return pOffset <= pLimit && pSize <= pLimit - pOffset;
+		}
+	}
+
+	void Pack::write(std::ostream &pOut, const std::vector<Entry> &pEntries) {
+		AURORA_PROFILE_ZONE("Pack::write");
+
+		Header header;
+		header.entryCount = static_cast<uint32_t>(pEntries.size());
+		header.slotCount = std::bit_ceil(std::max<uint32_t>(header.entryCount * 2, 1));
+		header.slotsOffset = alignUp(sizeof(Header), alignof(Slot));
+		header.stringsOffset = header.slotsOffset + header.slotCount * sizeof(Slot);
+
+		uint64_t stringsSize = 0;
+		for(const auto &item: pEntries) {
+			if(item.key.size() > UINT16_MAX || item.path.size() > UINT16_MAX) {
+				throw std::runtime_error("pack key or path is too long: " + item.key);
+			}
+			stringsSize += item.key.size() + item.path.size();
+		}
+
+		std::vector<Slot> slots(header.slotCount, Slot{});
+		std::unordered_set<std::string_view> keys;
+		auto mask = header.slotCount - 1;
+		uint64_t stringOffset = 0;
+		uint64_t payloadOffset = alignUp(header.stringsOffset + stringsSize, payloadAlignment);
+
+		for(const auto &item: pEntries) {
+			if(!keys.emplace(item.key).second) { throw std::runtime_error("duplicate pack key " + item.key); }
+
+			auto hash = hashKey(item.key);
+			auto i = hash & mask;
+			while(slots[i].hash != 0) { i = (i + 1) & mask; }
+
+			slots[i] = Slot{
+				.hash = hash,
+				.stringOffset = static_cast<uint32_t>(stringOffset),
+				.keyLength = static_cast<uint16_t>(item.key.size()),
+				.pathLength = static_cast<uint16_t>(item.path.size()),
+				.payloadOffset = payloadOffset,
+				.payloadSize = item.payload.size()
+			};
+
+			stringOffset += item.key.size() + item.path.size();
+			payloadOffset = alignUp(payloadOffset + item.payload.size(), payloadAlignment);
+		}
+
+		pOut.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+		writePadding(pOut, sizeof(Header), header.slotsOffset);
+		pOut.write(reinterpret_cast<const char *>(slots.data()),
+		           static_cast<std::streamsize>(slots.size() * sizeof(Slot)));
+
+		for(const auto &item: pEntries) {
+			pOut.write(item.key.data(), static_cast<std::streamsize>(item.key.size()));
+			pOut.write(item.path.data(), static_cast<std::streamsize>(item.path.size()));
+		}
+
+		uint64_t position = header.stringsOffset + stringsSize;
+		for(const auto &item: pEntries) {
+			auto start = alignUp(position, payloadAlignment);
+			writePadding(pOut, position, start);
+			pOut.write(reinterpret_cast<const char *>(item.payload.data()),
+			           static_cast<std::streamsize>(item.payload.size()));
+			position = start + item.payload.size();
+		}
+	}
+
+	void Pack::validate(std::span<const uint8_t> pImage) {
+		Header header;
+		if(pImage.size() < sizeof(Header)) { throw std::runtime_error("asset pack is truncated"); }
+		std::memcpy(&header, pImage.data(), sizeof(Header));
+
+		if(header.magic != fileMagic) { throw std::runtime_error("not an asset pack"); }
+		if(header.version != fileVersion) {
+			throw std::runtime_error("unsupported asset pack version " + std::to_string(header.version));
+		}
+		if(!std::has_single_bit(header.slotCount) ||
+		   header.slotsOffset % alignof(Slot) != 0 ||
+		   !inBounds(header.slotsOffset, uint64_t{header.slotCount} * sizeof(Slot), pImage.size()) ||
+		   header.stringsOffset != header.slotsOffset + header.slotCount * sizeof(Slot)) {
+			throw std::runtime_error("asset pack header is corrupt");
+		}
+	}
+
+	std::optional<Pack::View> Pack::find(std::span<const uint8_t> pImage, std::string_view pKey) {
+		auto header = reinterpret_cast<const Header *>(pImage.data());
+		auto slots = reinterpret_cast<const Slot *>(pImage.data() + header->slotsOffset);
+		auto strings = reinterpret_cast<const char *>(pImage.data() + header->stringsOffset);
+		auto stringsSize = pImage.size() - header->stringsOffset;
+		auto mask = header->slotCount - 1;
+		auto hash = hashKey(pKey);
+
+		// A pack written by write() is at most half full; the probe count is
+		// bounded anyway so that a corrupt table full of slots cannot hang.
+		auto i = hash & mask;
+		for(uint32_t probes = 0; probes < header->slotCount && slots[i].hash != 0; ++probes, i = (i + 1) & mask) {
+			const auto &slot = slots[i];
+			if(slot.hash != hash) { continue; }
+
+			// Slots are read straight from the file, so every offset in them
+			// is checked before it is followed.
+			if(!inBounds(slot.stringOffset, uint64_t{slot.keyLength} + slot.pathLength, stringsSize) ||
+			   !inBounds(slot.payloadOffset, slot.payloadSize, pImage.size())) {
+				throw std::runtime_error("asset pack entry is out of bounds: " + std::string(pKey));
+			}
+			if(std::string_view(strings + slot.stringOffset, slot.keyLength) != pKey) { continue; }
+
+			return View{
+				.path = std::string_view(strings + slot.stringOffset + slot.keyLength, slot.pathLength),
+				.payload = pImage.subspan(slot.payloadOffset, slot.payloadSize)
+			};
+		}
+
+		return std::nullopt;
+	}
+}
@@ -30,6 +30,16 @@ namespace aurora::aether {
 		for(const auto &item: pJson["vertexNodes"]) {
 			vertexNodes.emplace_back(item["name"], item["type"], item["from"], item["size"]);
 		}
+		if(pJson.contains("instanceInputs")) {
+			for(const auto &item: pJson["instanceInputs"]) {
+				instanceInputs.emplace_back(item["name"], item["purpose"]);
+			}
+		}
+		if(pJson.contains("blocks")) {
+			for(const auto &item: pJson["blocks"]) {
+				blocks.emplace_back(item["name"], item["purpose"]);
+			}
+		}
 	}
 
 	nlohmann::json Shader::serialize() {
@@ -40,6 +50,8 @@ namespace aurora::aether {
 		auto o = nlohmann::json::array();
 		auto u = nlohmann::json::array();
 		auto v = nlohmann::json::array();
+		auto n = nlohmann::json::array();
+		auto b = nlohmann::json::array();
 
 		for(const auto &item: parts) {
 			std::string stage;
@@ -83,12 +95,26 @@ namespace aurora::aether {
 				                                      {"size", item.size}
 			                                      }));
 		}
+		for(const auto &item: instanceInputs) {
+			n.emplace_back(nlohmann::json::object({
+				                                      {"name",    item.name},
+				                                      {"purpose", item.purpose}
+			                                      }));
+		}
+		for(const auto &item: blocks) {
+			b.emplace_back(nlohmann::json::object({
+				                                      {"name",    item.name},
+				                                      {"purpose", item.purpose}
+			                                      }));
+		}
 
 		j["parts"] = p;
 		j["inputs"] = i;
 		j["outputs"] = o;
 		j["uniforms"] = u;
 		j["vertexNodes"] = v;
+		j["instanceInputs"] = n;
+		j["blocks"] = b;
 
 		return j;
 	}
@@ -21,4 +21,10 @@ namespace aurora::aether {
 		std::ifstream input(pPath);
 		return nlohmann::json::from_cbor(input);
 	}
+
+	AssetSource AssetSource::readFile(const std::filesystem::path &pRoot, const std::filesystem::path &pPath) {
+		std::ifstream input(pRoot / pPath, std::ios::binary);
+		if(!input) { throw std::runtime_error("cannot open asset file " + (pRoot / pPath).string()); }
+		return {pPath, std::vector<uint8_t>(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>())};
+	}
 }
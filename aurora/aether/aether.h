@@ -8,7 +8,11 @@
 
 #include <filesystem>
 #include <nlohmann/json.hpp>
+#include <optional>
+#include <ostream>
+#include <span>
 #include <string>
+#include <string_view>
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include "../graphics/enums.h"
@@ -18,6 +22,122 @@ namespace aurora {
 }
 
 namespace aurora::aether {
+	/**
+	 * The bytes of a single asset, as handed to its loading constructor.
+	 * Bytes that come out of a mapped asset pack are borrowed, and stay valid
+	 * for as long as the pack does; bytes read from a loose file are owned.
+	 */
+	class AssetSource {
+	private:
+		std::filesystem::path m_Path;
+		std::vector<uint8_t> m_Storage;
+		std::span<const uint8_t> m_Data;
+
+	public:
+		/**
+		 * @param pPath Path of the asset, relative to the asset root. Used to
+		 * resolve files that the asset refers to.
+		 * @param pData Borrowed bytes of the asset.
+		 */
+		AssetSource(std::filesystem::path pPath, std::span<const uint8_t> pData)
+			: m_Path(std::move(pPath)), m_Data(pData) {}
+
+		AssetSource(std::filesystem::path pPath, std::vector<uint8_t> pStorage)
+			: m_Path(std::move(pPath)), m_Storage(std::move(pStorage)), m_Data(m_Storage) {}
+
+		AssetSource(const AssetSource &) = delete;
+		AssetSource(AssetSource &&) noexcept = default;
+		AssetSource &operator=(const AssetSource &) = delete;
+		AssetSource &operator=(AssetSource &&) noexcept = default;
+
+		static AssetSource readFile(const std::filesystem::path &pRoot, const std::filesystem::path &pPath);
+
+		[[nodiscard]] const std::filesystem::path &getPath() const { return m_Path; }
+
+		[[nodiscard]] std::span<const uint8_t> getData() const { return m_Data; }
+
+		[[nodiscard]] bool isBorrowed() const { return m_Storage.empty() && !m_Data.empty(); }
+
+		[[nodiscard]] nlohmann::json readCbor() const {
+			return nlohmann::json::from_cbor(m_Data.begin(), m_Data.end());
+		}
+
+		/**
+		 * Resolves a path stored inside this asset, which is relative to the
+		 * directory of the asset, to a path relative to the asset root.
+		 */
+		[[nodiscard]] std::filesystem::path resolve(const std::filesystem::path &pRelative) const {
+			return (m_Path.parent_path() / pRelative).lexically_normal();
+		}
+	};
+
+	/**
+	 * A single-file asset pack, as written by amkpack and mapped by the
+	 * AssetLoader.
+	 *
+	 * The file starts with a Header, followed by an open-addressed hash table
+	 * of Slots (a power of two in size, at most half full), the strings, and
+	 * finally the payloads, each aligned to payloadAlignment bytes. Keys are
+	 * asset ids, or filePrefix followed by a root-relative path for raw files
+	 * that assets refer to, such as texture images. Each key is stored next to
+	 * the root-relative path its payload was packed from.
+	 */
+	struct Pack {
+		static constexpr uint32_t fileMagic = 0x4b504541; // "AEPK"
+		static constexpr uint32_t fileVersion = 1;
+		static constexpr size_t payloadAlignment = 64;
+		static constexpr const char *fileName = "assets.apack";
+		static constexpr const char *filePrefix = "file:";
+
+		struct Header {
+			uint32_t magic = fileMagic;
+			uint32_t version = fileVersion;
+			uint32_t slotCount = 0;
+			uint32_t entryCount = 0;
+			uint64_t slotsOffset = 0;
+			uint64_t stringsOffset = 0;
+		};
+
+		/*
+		 * A slot with a hash of zero is empty; hashKey() never returns zero.
+		 */
+		struct Slot {
+			uint64_t hash;
+			uint32_t stringOffset;
+			uint16_t keyLength;
+			uint16_t pathLength;
+			uint64_t payloadOffset;
+			uint64_t payloadSize;
+		};
+
+		struct Entry {
+			std::string key;
+			std::string path;
+			std::vector<uint8_t> payload;
+		};
+
+		struct View {
+			std::string_view path;
+			std::span<const uint8_t> payload;
+		};
+
+		static uint64_t hashKey(std::string_view pKey);
+
+		static void write(std::ostream &pOut, const std::vector<Entry> &pEntries);
+
+		/**
+		 * @throws std::runtime_error The image is not a pack this version can read.
+		 */
+		static void validate(std::span<const uint8_t> pImage);
+
+		/**
+		 * Looks up a key in a validated pack image in expected constant time.
+		 *
+		 * @return Views of the path and payload inside pImage.
+		 */
+		static std::optional<View> find(std::span<const uint8_t> pImage, std::string_view pKey);
+	};
+
 	struct Resource {
 		static constexpr const char *schemaUri = "https://www.liamcoalstudio.com/aurora/aether.xsd";
 
@@ -82,6 +202,19 @@ namespace aurora::aether {
 		std::vector<Uniform> uniforms;
 		std::vector<VertexNode> vertexNodes;
 
+		/**
+		 * Vertex inputs that advance once per instance instead of once per
+		 * vertex. They are not part of the mesh layout.
+		 */
+		std::vector<Input> instanceInputs;
+
+		/**
+		 * Uniform blocks that the engine fills, by block name and purpose
+		 * ("Camera" or "Objects"). Declared by either stage; a block shared
+		 * by both stages is listed once.
+		 */
+		std::vector<Uniform> blocks;
+
 		Shader() = default;
 		~Shader() override = default;
 
@@ -89,8 +222,8 @@ namespace aurora::aether {
 
 		static inline Shader load(const std::filesystem::path &pPath) { return Shader(readFromFile(pPath)); }
 
-		explicit Shader(class AssetLoader *, const std::filesystem::path &pPath, const std::string &)
-			: Shader(readFromFile(pPath)) {}
+		explicit Shader(class AssetLoader *, const AssetSource &pSource, const std::string &)
+			: Shader(pSource.readCbor()) {}
 
 		nlohmann::json serialize() override;
 	};
@@ -124,17 +257,41 @@ namespace aurora::aether {
 		int vertices[3], texVertices[3], normalVertices[3];
 	};
 
+	/**
+	 * An axis-aligned box around a mesh, in the mesh's own space.
+	 */
+	struct Bounds {
+		glm::vec3 min{};
+		glm::vec3 max{};
+
+		/**
+		 * @return The smallest box around the passed points, or an empty box at
+		 * the origin if there are none.
+		 */
+		static Bounds of(const std::vector<glm::vec3> &pPoints);
+
+		[[nodiscard]] glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+
+		[[nodiscard]] float getRadius() const { return glm::length(max - min) * 0.5f; }
+	};
+
 	struct Mesh : public Resource {
 		std::vector<glm::vec3> positions;
 		std::vector<glm::vec2> texCoords;
 		std::vector<glm::vec3> normals;
 		std::vector<MeshTri> tris;
 
+		/**
+		 * Written by ameshc. Meshes serialized before bounds existed have them
+		 * computed from the positions when loaded.
+		 */
+		Bounds bounds;
+
 		Mesh() = default;
 
 		explicit Mesh(const nlohmann::json &pJson);
 
-		Mesh(AssetLoader *, const std::filesystem::path &pPath, const std::string &);
+		Mesh(AssetLoader *, const AssetSource &pSource, const std::string &);
 
 		~Mesh() override = default;
 
@@ -148,12 +305,108 @@ namespace aurora::aether {
 		OptimisedMesh(const std::vector<float> &pVertexData, const std::vector<uint32_t> &pIndexData) : vertexData(
 			pVertexData), indexData(pIndexData) {}
 
+		/**
+		 * Interleaves a mesh into the vertex layout of a shader, welding
+		 * duplicate vertices into a single index.
+		 *
+		 * @param pWeldEpsilon When zero, only identical vertices are welded.
+		 * Otherwise vertices whose attributes all lie within this distance of
+		 * each other are welded together.
+		 */
 		OptimisedMesh(const Mesh &pMesh, const Shader &pShader, const glm::vec4 &pColor = {
 			1,
 			1,
 			1,
 			1
-		});
+		}, float pWeldEpsilon = 0.0f);
+	};
+
+	/**
+	 * A mesh that has already been welded and interleaved for one shader
+	 * vertex layout, stored as a small header followed by the raw vertex and
+	 * index streams. Produced by ameshc and uploaded without any per-vertex
+	 * work at runtime.
+	 *
+	 * The file is laid out as the Header, the id string padded to 16 bytes,
+	 * the vertex stream, and then the index stream. Indices are 16-bit when
+	 * every vertex can be addressed by one.
+	 */
+	struct CompiledMesh {
+		static constexpr uint32_t fileMagic = 0x48534d41; // "AMSH"
+		static constexpr uint32_t fileVersion = 2;
+		static constexpr const char *fileExtension = ".amesh";
+
+		struct Header {
+			uint32_t magic = fileMagic;
+			uint32_t version = fileVersion;
+			uint32_t idLength = 0;
+			uint32_t layoutHash = 0;
+			uint32_t vertexStride = 0;
+			uint32_t vertexCount = 0;
+			uint32_t indexCount = 0;
+			uint32_t indexSize = 0;
+			float boundsMin[3]{};
+			float boundsMax[3]{};
+		};
+
+		std::string id;
+		Header header;
+
+	private:
+		std::vector<uint8_t> m_Bytes;
+		std::span<const uint8_t> m_Data;
+		size_t m_VertexOffset = 0;
+
+		void parse();
+
+	public:
+		CompiledMesh() = default;
+
+		CompiledMesh(std::string pId, const OptimisedMesh &pMesh, const Shader &pShader, const Bounds &pBounds);
+
+		explicit CompiledMesh(std::vector<uint8_t> pBytes);
+
+		/**
+		 * When the source is borrowed from a mapped pack, the mesh refers to
+		 * the mapped bytes directly instead of copying them.
+		 */
+		CompiledMesh(AssetLoader *, const AssetSource &pSource, const std::string &);
+
+		CompiledMesh(const CompiledMesh &) = delete;
+		CompiledMesh(CompiledMesh &&) noexcept = default;
+		CompiledMesh &operator=(const CompiledMesh &) = delete;
+		CompiledMesh &operator=(CompiledMesh &&) noexcept = default;
+
+		[[nodiscard]] const uint8_t *getVertexData() const { return m_Data.data() + m_VertexOffset; }
+
+		[[nodiscard]] size_t getVertexDataSize() const {
+			return static_cast<size_t>(header.vertexStride) * header.vertexCount;
+		}
+
+		[[nodiscard]] const uint8_t *getIndexData() const { return getVertexData() + getVertexDataSize(); }
+
+		[[nodiscard]] size_t getIndexDataSize() const {
+			return static_cast<size_t>(header.indexSize) * header.indexCount;
+		}
+
+		/**
+		 * Checks that this mesh was compiled for the vertex layout of the
+		 * passed shader.
+		 */
+		[[nodiscard]] bool matches(const Shader &pShader) const { return header.layoutHash == hashLayout(pShader); }
+
+		[[nodiscard]] Bounds getBounds() const {
+			return {
+				{header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]},
+				{header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]}
+			};
+		}
+
+		[[nodiscard]] std::span<const uint8_t> serialize() const { return m_Data; }
+
+		static uint32_t hashLayout(const Shader &pShader);
+
+		static std::string readId(const std::filesystem::path &pPath);
 	};
 
 	struct Level : public Resource {
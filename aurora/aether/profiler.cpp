@@ -0,0 +1,200 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "profiler.h"
+
+#ifdef AURORA_PROFILER
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace aurora {
+	namespace {
+		const auto epoch = std::chrono::steady_clock::now();
+
+		const char *counterNames[Profiler::counterCount]{
+			"Draws",
+			"State changes",
+			"Buffer bytes uploaded",
+			"Assets loaded"
+		};
+
+		void writeString(std::ostream &pOut, const std::string &pString) {
+			pOut << '"';
+			for(auto c: pString) {
+				switch(c) {
+					case '"':
+						pOut << "\\\"";
+						break;
+					case '\\':
+						pOut << "\\\\";
+						break;
+					case '\n':
+						pOut << "\\n";
+						break;
+					default:
+						if(static_cast<unsigned char>(c) < 0x20) { pOut << ' '; }
+						else { pOut << c; }
+				}
+			}
+			pOut << '"';
+		}
+
+		// Chrome traces count in microseconds.
+		double micros(uint64_t pNanos) {
+			return static_cast<double>(pNanos) / 1000.0;
+		}
+	}
+
+	Profiler &Profiler::get() {
+		static Profiler profiler;
+		return profiler;
+	}
+
+	uint64_t Profiler::now() {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - epoch).count());
+	}
+
+	Profiler::ThreadRing &Profiler::ring() {
+		thread_local ThreadRing *current = nullptr;
+		if(current != nullptr) { return *current; }
+
+		std::lock_guard lock(m_Mutex);
+		auto ring = std::make_unique<ThreadRing>();
+		ring->id = static_cast<uint32_t>(m_Threads.size() + 1);
+		ring->name = "Thread " + std::to_string(ring->id);
+		current = ring.get();
+		m_Threads.push_back(std::move(ring));
+		return *current;
+	}
+
+	void Profiler::record(const char *pName, uint64_t pStart, uint64_t pEnd) {
+		if(!isEnabled()) { return; }
+
+		// Only this thread writes to its ring, so a plain store followed by a
+		// release of the count is enough for readers.
+		auto &r = ring();
+		auto index = r.written.load(std::memory_order_relaxed);
+		auto &zone = r.zones[index % ringCapacity];
+		zone.name.store(pName, std::memory_order_relaxed);
+		zone.start.store(pStart, std::memory_order_relaxed);
+		zone.end.store(pEnd, std::memory_order_relaxed);
+		r.written.store(index + 1, std::memory_order_release);
+	}
+
+	void Profiler::markFrame() {
+		auto time = now();
+
+		FrameSample sample{time, {}};
+		for(size_t i = 0; i < counterCount; ++i) {
+			auto value = m_Counters[i].load(std::memory_order_relaxed);
+			sample.counters[i] = value - m_LastCounters[i];
+			m_LastCounters[i] = value;
+		}
+
+		if(m_LastFrame != 0) { record("Frame", m_LastFrame, time); }
+		m_LastFrame = time;
+
+		if(!isEnabled()) { return; }
+
+		std::lock_guard lock(m_Mutex);
+		if(m_Frames.size() < maxFrameSamples) {
+			m_Frames.push_back(sample);
+		} else {
+			m_Frames[m_FramesWritten % maxFrameSamples] = sample;
+		}
+		++m_FramesWritten;
+	}
+
+	void Profiler::setThreadName(std::string pName) {
+		auto &r = ring();
+		std::lock_guard lock(m_Mutex);
+		r.name = std::move(pName);
+	}
+
+	void Profiler::writeChromeTrace(std::ostream &pOut) const {
+		std::lock_guard lock(m_Mutex);
+
+		auto flags = pOut.flags();
+		auto precision = pOut.precision();
+		pOut << std::fixed << std::setprecision(3);
+
+		pOut << R"({"displayTimeUnit":"ms","traceEvents":[)";
+		bool first = true;
+		auto separate = [&]() {
+			if(!first) { pOut << ",\n"; }
+			first = false;
+		};
+
+		for(const auto &item: m_Threads) {
+			separate();
+			pOut << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << item->id << R"(,"args":{"name":)";
+			writeString(pOut, item->name);
+			pOut << "}}";
+
+			auto written = item->written.load(std::memory_order_acquire);
+			auto begin = written > ringCapacity ? written - ringCapacity : 0;
+			for(auto i = begin; i < written; ++i) {
+				const auto &zone = item->zones[i % ringCapacity];
+				const char *name = zone.name.load(std::memory_order_relaxed);
+				auto start = zone.start.load(std::memory_order_relaxed);
+				auto end = zone.end.load(std::memory_order_relaxed);
+
+				// Skip the slot if the thread has come around and started
+				// overwriting it since.
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if(item->written.load(std::memory_order_relaxed) > i + ringCapacity - 1) { continue; }
+
+				separate();
+				pOut << R"({"name":)";
+				writeString(pOut, name);
+				pOut << R"(,"ph":"X","pid":1,"tid":)" << item->id
+				     << R"(,"ts":)" << micros(start)
+				     << R"(,"dur":)" << micros(end - start) << "}";
+			}
+		}
+
+		// Oldest first, whether or not the samples have wrapped around.
+		auto frameCount = m_Frames.size();
+		auto frameBegin = m_FramesWritten > frameCount ? m_FramesWritten % frameCount : 0;
+		for(size_t n = 0; n < frameCount; ++n) {
+			const auto &sample = m_Frames[(frameBegin + n) % frameCount];
+			for(size_t i = 0; i < counterCount; ++i) {
+				separate();
+				pOut << R"({"name":)";
+				writeString(pOut, counterNames[i]);
+				pOut << R"(,"ph":"C","pid":1,"ts":)" << micros(sample.time)
+				     << R"(,"args":{"value":)" << sample.counters[i] << "}}";
+			}
+		}
+
+		pOut << "]}\n";
+		pOut.flags(flags);
+		pOut.precision(precision);
+	}
+
+	void Profiler::saveChromeTrace(const std::filesystem::path &pPath) const {
+		std::ofstream out(pPath);
+		if(!out) { throw std::runtime_error("cannot write trace to " + pPath.string()); }
+
+		writeChromeTrace(out);
+	}
+
+	ProfileTraceOnExit::~ProfileTraceOnExit() {
+		if(m_Path.empty()) { return; }
+
+		try {
+			Profiler::get().saveChromeTrace(m_Path);
+		} catch(const std::exception &e) {
+			std::cerr << e.what() << std::endl;
+		}
+	}
+}// namespace aurora
+
+#endif// AURORA_PROFILER
@@ -0,0 +1,204 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_PROFILER_H
+#define AURORA_PROFILER_H
+
+/*
+ * The profiler lives in aether so that the asset tools, which do not link
+ * the engine, can use it too. Building without AURORA_PROFILER leaves only
+ * the macros, which then expand to nothing.
+ */
+
+#ifdef AURORA_PROFILER
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace aurora {
+
+	enum class ProfileCounter : uint8_t {
+		/** Draw calls issued to the graphics API; an instanced draw counts once. */
+		Draws,
+		/** Bindings that reached the graphics API, after redundant ones were filtered. */
+		StateChanges,
+		/** Bytes uploaded into buffers. */
+		BufferBytesUploaded,
+		/** Assets constructed by the asset loader. */
+		AssetsLoaded,
+		Count
+	};
+
+	/**
+	 * Records timed zones and counters, and writes them out as a Chrome trace
+	 * (chrome://tracing, or ui.perfetto.dev).
+	 *
+	 * Every thread records into a ring buffer of its own, so recording takes
+	 * no locks; once a ring is full, its oldest zones are overwritten. A ring
+	 * is kept after its thread ends, so its zones can still be written out.
+	 *
+	 * Counters run for the whole process. markFrame() samples how much each
+	 * grew during the frame, which shows up as counter tracks in the trace.
+	 */
+	class Profiler {
+	public:
+		static constexpr size_t ringCapacity = 1 << 16;
+		static constexpr size_t maxFrameSamples = 1 << 14;
+		static constexpr size_t counterCount = static_cast<size_t>(ProfileCounter::Count);
+
+	private:
+		// Relaxed atomics cost the same as plain stores, and let the trace be
+		// written while a thread overwrites the slots it is reading.
+		struct Zone {
+			std::atomic<const char *> name;
+			std::atomic<uint64_t> start;
+			std::atomic<uint64_t> end;
+		};
+
+		struct ThreadRing {
+			uint32_t id;
+			std::string name;
+			std::unique_ptr<Zone[]> zones{new Zone[ringCapacity]};
+			std::atomic<uint64_t> written{0};
+		};
+
+		struct FrameSample {
+			uint64_t time;
+			uint64_t counters[counterCount];
+		};
+
+		mutable std::mutex m_Mutex;
+		std::vector<std::unique_ptr<ThreadRing>> m_Threads;
+		std::vector<FrameSample> m_Frames;
+		size_t m_FramesWritten = 0;
+		uint64_t m_LastFrame = 0;
+		uint64_t m_LastCounters[counterCount]{};
+
+		std::atomic<bool> m_Enabled{true};
+		std::atomic<uint64_t> m_Counters[counterCount]{};
+
+		ThreadRing &ring();
+
+	public:
+		static Profiler &get();
+
+		/**
+		 * @return Nanoseconds since the profiler was first used.
+		 */
+		static uint64_t now();
+
+		/**
+		 * Adds to a counter. Counted even while recording is disabled.
+		 */
+		static void count(ProfileCounter pCounter, uint64_t pAmount) {
+			get().m_Counters[static_cast<size_t>(pCounter)].fetch_add(pAmount, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Records a zone on the calling thread. pName must outlive the
+		 * profiler; string literals do.
+		 */
+		void record(const char *pName, uint64_t pStart, uint64_t pEnd);
+
+		/**
+		 * Ends a frame: records it as a zone on the calling thread, from the
+		 * previous call to now, and samples the counters. Only one thread
+		 * should mark frames.
+		 */
+		void markFrame();
+
+		/**
+		 * Names the calling thread in the trace.
+		 */
+		void setThreadName(std::string pName);
+
+		void setEnabled(bool pEnabled) { m_Enabled.store(pEnabled, std::memory_order_relaxed); }
+
+		[[nodiscard]] bool isEnabled() const { return m_Enabled.load(std::memory_order_relaxed); }
+
+		[[nodiscard]] uint64_t getCounter(ProfileCounter pCounter) const {
+			return m_Counters[static_cast<size_t>(pCounter)].load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * Writes everything recorded so far as Chrome trace JSON. Zones that
+		 * threads record meanwhile may or may not be included.
+		 */
+		void writeChromeTrace(std::ostream &pOut) const;
+
+		/**
+		 * @throws std::runtime_error The file cannot be written.
+		 */
+		void saveChromeTrace(const std::filesystem::path &pPath) const;
+	};
+
+	/**
+	 * Records a zone from its construction to its destruction.
+	 */
+	class ProfileZone {
+		const char *m_Name;
+		uint64_t m_Start;
+
+	public:
+		explicit ProfileZone(const char *pName) : m_Name(pName), m_Start(Profiler::now()) {}
+
+		~ProfileZone() {
+			Profiler::get().record(m_Name, m_Start, Profiler::now());
+		}
+
+		ProfileZone(const ProfileZone &) = delete;
+		ProfileZone &operator=(const ProfileZone &) = delete;
+	};
+
+	/**
+	 * Saves a trace when it goes out of scope, after every zone declared
+	 * below it has closed. Nothing is saved if the path is empty, and a
+	 * failure to save is reported on stderr.
+	 */
+	class ProfileTraceOnExit {
+		std::filesystem::path m_Path;
+
+	public:
+		explicit ProfileTraceOnExit(std::filesystem::path pPath) : m_Path(std::move(pPath)) {}
+
+		~ProfileTraceOnExit();
+
+		ProfileTraceOnExit(const ProfileTraceOnExit &) = delete;
+		ProfileTraceOnExit &operator=(const ProfileTraceOnExit &) = delete;
+	};
+
+}// namespace aurora
+
+#define AURORA_PROFILE_CONCAT_INNER(pA, pB) pA##pB
+#define AURORA_PROFILE_CONCAT(pA, pB) AURORA_PROFILE_CONCAT_INNER(pA, pB)
+
+/** Times the rest of the enclosing scope under pName, a string literal. */
+#define AURORA_PROFILE_ZONE(pName) ::aurora::ProfileZone AURORA_PROFILE_CONCAT(auroraProfileZone, __LINE__)(pName)
+/** Adds pAmount to the ProfileCounter named pCounter. */
+#define AURORA_PROFILE_COUNT(pCounter, pAmount) \
+	::aurora::Profiler::count(::aurora::ProfileCounter::pCounter, static_cast<uint64_t>(pAmount))
+#define AURORA_PROFILE_FRAME() ::aurora::Profiler::get().markFrame()
+#define AURORA_PROFILE_THREAD(pName) ::aurora::Profiler::get().setThreadName(pName)
+#define AURORA_PROFILE_SAVE(pPath) ::aurora::Profiler::get().saveChromeTrace(pPath)
+#define AURORA_PROFILE_SAVE_ON_EXIT(pPath) ::aurora::ProfileTraceOnExit AURORA_PROFILE_CONCAT(auroraProfileTrace, __LINE__)(pPath)
+
+#else
+
+#define AURORA_PROFILE_ZONE(pName) static_cast<void>(0)
+#define AURORA_PROFILE_COUNT(pCounter, pAmount) static_cast<void>(0)
+#define AURORA_PROFILE_FRAME() static_cast<void>(0)
+#define AURORA_PROFILE_THREAD(pName) static_cast<void>(0)
+#define AURORA_PROFILE_SAVE(pPath) static_cast<void>(0)
+#define AURORA_PROFILE_SAVE_ON_EXIT(pPath) static_cast<void>(0)
+
+#endif// AURORA_PROFILER
+
+#endif// AURORA_PROFILER_H
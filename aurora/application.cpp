@@ -5,14 +5,50 @@
 
 #include "application.h"
 #include "glimpl/opengl_impl_node.h"
+#include "nullimpl/null_impl.h"
 #include "global.h"
+#include "aether/profiler.h"
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 #include <thread>
 
 namespace aurora {
+	namespace {
+		// Sleeps wake up late by up to a scheduler quantum, so the last stretch
+		// before a deadline is spent yielding instead.
+		constexpr std::chrono::microseconds spinThreshold(1500);
+
+		void waitUntil(std::chrono::steady_clock::time_point pDeadline) {
+			auto remaining = pDeadline - std::chrono::steady_clock::now();
+			if(remaining > spinThreshold) { std::this_thread::sleep_for(remaining - spinThreshold); }
+
+			while(std::chrono::steady_clock::now() < pDeadline) { std::this_thread::yield(); }
+		}
+
+		// Runs a function when it goes out of scope, including by exception.
+		template<typename F>
+		class ScopeExit {
+		private:
+			F m_Function;
+
+		public:
+			explicit ScopeExit(F pFunction) : m_Function(std::move(pFunction)) {}
+
+			~ScopeExit() {
+				m_Function();
+			}
+
+			ScopeExit(const ScopeExit &) = delete;
+			ScopeExit &operator=(const ScopeExit &) = delete;
+		};
+	}
+
 	Application::Application(int pWindowWidth, int pWindowHeight, const std::string &pWindowTitle) {
 		init();
 		auto implFinder = new aurora::ImplementationFinder();
 		implFinder->registerImpl(new aurora::OpenGlImplementationNode<3, 2>);
+		implFinder->registerImpl(new aurora::OpenGlImplementationNode<4, 5>);
 
 		m_Instance = new aurora::Instance(implFinder, ".");
 		aurora::global = m_Instance;
@@ -23,16 +59,59 @@ namespace aurora {
 		aurora::injectBuiltinAssets(m_Instance->getAssetLoader());
 	}
 
+	Application::Application(glm::ivec2 pViewportSize) {
+		// Without a window, GLFW is never needed, so it is not initialised.
+		auto implFinder = new aurora::ImplementationFinder();
+		implFinder->registerImpl(new aurora::NullImplementationNode);
+
+		m_Instance = new aurora::Instance(implFinder, ".");
+		aurora::global = m_Instance;
+
+		m_Window = nullptr;
+		m_Instance->setHeadlessViewportSize(pViewportSize);
+
+		aurora::injectBuiltinAssets(m_Instance->getAssetLoader());
+	}
+
 	Application::~Application() {
+		auto headless = m_Window == nullptr;
+
 		delete m_Window;
 		delete m_Instance;
-		aurora::terminate();
+		if(!headless) { aurora::terminate(); }
+	}
+
+	bool Application::shouldRun() const {
+		return !m_StopRequested && (m_Window == nullptr || m_Window->shouldWindowBeOpen());
+	}
+
+	void Application::finishFrame() {
+		if(m_Window != nullptr) {
+			m_Window->finishFrame();
+		} else {
+			m_Instance->getImpl()->performFinishFrame(nullptr);
+		}
+	}
+
+	void Application::render(float pAlpha) {
+		m_Snapshot.clear();
+		record(m_Snapshot, pAlpha);
+		present(m_Snapshot);
+		m_Snapshot.destroyRetired();
+	}
+
+	void Application::record(level::FrameSnapshot &pSnapshot, float pAlpha) {
+		pSnapshot.alpha = pAlpha;
+		pSnapshot.time = static_cast<float>((static_cast<double>(m_TickCount) + pAlpha) / m_TickRate);
+		if(m_Level != nullptr) {
+			m_Level->record(pSnapshot);
+		}
 	}
 
-	void Application::render() {
+	void Application::present(const level::FrameSnapshot &pSnapshot) {
 		m_Instance->getGraphics()->clear();
 		if(m_Level != nullptr) {
-			m_Level->render();
+			m_Level->present(pSnapshot);
 		}
 	}
 
@@ -47,21 +126,188 @@ namespace aurora {
 	}
 
 	void Application::run() {
-		while(m_Window->shouldWindowBeOpen()) {
-			auto start = std::chrono::steady_clock::now();
+		m_StopRequested = false;
+		if(m_Pipelined) {
+			runPipelined();
+		} else {
+			runSerial();
+		}
+	}
+
+	void Application::runSerial() {
+		using clock = std::chrono::steady_clock;
+
+		auto previous = clock::now();
+		auto nextFrame = previous;
+		std::chrono::nanoseconds accumulator(0);
+		m_TickCount = 0;
+		m_DroppedTicks = 0;
+		AURORA_PROFILE_THREAD("Main");
+
+		while(shouldRun()) {
+			auto now = clock::now();
+			accumulator += now - previous;
+			previous = now;
+
+			m_Instance->getAssetLoader()->pumpUploads(m_UploadBudget);
+			if(m_Window != nullptr) { Window::pollEvents(); }
+
+			auto tick = getTickDuration();
+			for(int i = 0; i < m_MaxTicksPerFrame && accumulator >= tick; ++i) {
+				update();
+				accumulator -= tick;
+				++m_TickCount;
+			}
+
+			if(accumulator >= tick) {
+				m_DroppedTicks += static_cast<uint64_t>(accumulator / tick);
+				accumulator %= tick;
+			}
 
-			if(m_Window->isReallyVisible()) {
-				render();
-				m_Window->finishFrame();
+			if(m_Instance->isViewportVisible()) {
+				render(static_cast<float>(static_cast<double>(accumulator.count()) / static_cast<double>(tick.count())));
+				finishFrame();
+			} else if(m_Level != nullptr) {
+				m_Level->destroyRetired();
 			}
+			AURORA_PROFILE_FRAME();
 
-			Window::pollEvents();
-			update();
-			auto end = std::chrono::steady_clock::now();
-			auto
-				frameDuration = std::chrono::nanoseconds(static_cast<long>(1000000000.0 / (double) m_DesiredFramerate));
-			auto waitTime = frameDuration - (end - start);
-			if(waitTime.count() > 0) { std::this_thread::sleep_for(waitTime); }
+			if(m_DesiredFramerate > 0) {
+				// Pacing against a schedule and not the frame's own length keeps
+				// small errors from adding up; after a long frame the schedule
+				// restarts from now instead of rushing to catch up.
+				nextFrame += std::chrono::nanoseconds(static_cast<int64_t>(1000000000.0 / m_DesiredFramerate));
+				if(nextFrame < clock::now()) {
+					nextFrame = clock::now();
+				} else {
+					waitUntil(nextFrame);
+				}
+			}
 		}
 	}
-}// namespace aurora
\ No newline at end of file
+
+	void Application::runPipelined() {
+		using clock = std::chrono::steady_clock;
+
+		/*
+		 * Two snapshots: the simulation records into one while the main
+		 * thread presents the other. The simulation waits for the main thread
+		 * to take the last one it recorded before it starts on the next, so
+		 * it never overwrites a snapshot being drawn and runs at most one
+		 * frame ahead.
+		 */
+		level::FrameSnapshot snapshots[2];
+		std::mutex mutex;
+		std::condition_variable condition;
+		int ready = -1;
+		bool stopping = false;
+		std::exception_ptr error;
+
+		m_TickCount = 0;
+		m_DroppedTicks = 0;
+
+		AURORA_PROFILE_THREAD("Main");
+		std::thread simulation([&]() {
+			AURORA_PROFILE_THREAD("Simulation");
+			try {
+				auto previous = clock::now();
+				std::chrono::nanoseconds accumulator(0);
+
+				for(int slot = 0;; slot ^= 1) {
+					auto now = clock::now();
+					accumulator += now - previous;
+					previous = now;
+
+					auto tick = getTickDuration();
+					for(int i = 0; i < m_MaxTicksPerFrame && accumulator >= tick; ++i) {
+						update();
+						accumulator -= tick;
+						++m_TickCount;
+					}
+
+					if(accumulator >= tick) {
+						m_DroppedTicks += static_cast<uint64_t>(accumulator / tick);
+						accumulator %= tick;
+					}
+
+					{
+						std::unique_lock lock(mutex);
+						condition.wait(lock, [&]() { return ready < 0 || stopping; });
+						if(stopping) { return; }
+					}
+
+					snapshots[slot].clear();
+					record(snapshots[slot],
+					       static_cast<float>(static_cast<double>(accumulator.count()) /
+					                          static_cast<double>(tick.count())));
+
+					{
+						std::lock_guard lock(mutex);
+						ready = slot;
+					}
+					condition.notify_all();
+				}
+			} catch(...) {
+				std::lock_guard lock(mutex);
+				error = std::current_exception();
+				stopping = true;
+			}
+			condition.notify_all();
+		});
+
+		{
+			// The simulation is stopped and joined however the loop is left;
+			// destroying a thread that is still joinable terminates.
+			ScopeExit stopSimulation([&]() {
+				{
+					std::lock_guard lock(mutex);
+					stopping = true;
+				}
+				condition.notify_all();
+				simulation.join();
+
+				// Neither snapshot is presented any more.
+				for(auto &item: snapshots) { item.destroyRetired(); }
+			});
+
+			auto nextFrame = clock::now();
+			while(shouldRun()) {
+				m_Instance->getAssetLoader()->pumpUploads(m_UploadBudget);
+				if(m_Window != nullptr) { Window::pollEvents(); }
+
+				// Waiting is bounded so that events keep being handled while the
+				// simulation is slow.
+				int slot = -1;
+				{
+					std::unique_lock lock(mutex);
+					condition.wait_for(lock, std::chrono::milliseconds(10), [&]() { return ready >= 0 || stopping; });
+					if(error) { break; }
+					std::swap(slot, ready);
+				}
+				if(slot >= 0) { condition.notify_all(); }
+
+				// A snapshot is taken even when it is not drawn, so that the
+				// simulation keeps going while the window is hidden.
+				// Only now is what was retired before the snapshot was recorded
+				// out of every snapshot still to be drawn.
+				if(slot >= 0 && m_Instance->isViewportVisible()) {
+					present(snapshots[slot]);
+					finishFrame();
+				}
+				if(slot >= 0) { snapshots[slot].destroyRetired(); }
+				AURORA_PROFILE_FRAME();
+
+				if(m_DesiredFramerate > 0) {
+					nextFrame += std::chrono::nanoseconds(static_cast<int64_t>(1000000000.0 / m_DesiredFramerate));
+					if(nextFrame < clock::now()) {
+						nextFrame = clock::now();
+					} else {
+						waitUntil(nextFrame);
+					}
+				}
+			}
+		}
+
+		if(error) { std::rethrow_exception(error); }
+	}
+}// namespace aurora
@@ -8,35 +8,162 @@
 
 #include "instance.h"
 #include "level/level.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 
 namespace aurora {
 
+	/**
+	 * Owns the instance and window, and runs the main loop.
+	 *
+	 * A headless application has no window and draws through a
+	 * NullImplementation, so it runs without a display or GPU, for
+	 * benchmarks and tests. It runs until stop() is called.
+	 *
+	 * The simulation advances in fixed ticks: update() is called at the tick
+	 * rate regardless of how fast frames are rendered, catching up with
+	 * several ticks in one frame when rendering falls behind. render() is
+	 * then passed how far the current time is between the last tick and the
+	 * next, for interpolating what it draws.
+	 */
 	class Application {
 	private:
 		float m_DesiredFramerate = 60.0f;
+		bool m_Pipelined = false;
+		double m_TickRate = 60.0;
+		int m_MaxTicksPerFrame = 5;
+		// Written by the simulation thread in pipelined mode.
+		std::atomic<uint64_t> m_TickCount = 0;
+		std::atomic<uint64_t> m_DroppedTicks = 0;
+		std::atomic<bool> m_StopRequested = false;
+		std::chrono::nanoseconds m_UploadBudget = std::chrono::milliseconds(2);
 		Instance *m_Instance;
 		Window *m_Window;
-		level::Level *m_Level;
+		level::Level *m_Level = nullptr;
+		level::FrameSnapshot m_Snapshot;
+
+		void runSerial();
+		void runPipelined();
+		[[nodiscard]] bool shouldRun() const;
+		void finishFrame();
 
 	protected:
 		[[nodiscard]] float getDesiredFramerate() const { return m_DesiredFramerate; }
 
+		/**
+		 * Caps how often frames are rendered. Zero or less leaves frames
+		 * unpaced, to be limited only by vertical sync.
+		 */
 		void setDesiredFramerate(float pFrameRate) { m_DesiredFramerate = pFrameRate; }
 
+		[[nodiscard]] double getTickRate() const { return m_TickRate; }
+
+		/**
+		 * Sets how many times per second update() is called.
+		 */
+		void setTickRate(double pTickRate) { m_TickRate = pTickRate; }
+
+		/**
+		 * Limits how many ticks a frame runs to catch up. Time beyond that is
+		 * dropped, so the simulation slows down instead of spending ever
+		 * longer on catching up.
+		 */
+		void setMaxTicksPerFrame(int pMaxTicks) { m_MaxTicksPerFrame = pMaxTicks; }
+
+		[[nodiscard]] int getMaxTicksPerFrame() const { return m_MaxTicksPerFrame; }
+
+		[[nodiscard]] bool isPipelined() const { return m_Pipelined; }
+
+		/**
+		 * Selects how run() drives the frame; takes effect on the next run().
+		 *
+		 * A pipelined application runs update() and record() on a simulation
+		 * thread of its own, while the main thread keeps the context, polls
+		 * events, finishes asynchronous loads and presents the previous
+		 * frame's snapshot. Simulating one frame and submitting the last then
+		 * overlap. render() is not called in this mode.
+		 *
+		 * update() and record() must then leave the graphics implementation
+		 * alone: no creating of graphics resources, no destroying them other
+		 * than through Level::retire(), and no synchronous loading of assets
+		 * that need the context; use AssetLoader::loadAsync() for those. An
+		 * asset that a snapshot may draw is unloaded from a Level::retire()
+		 * callback too, as the loader may destroy it before the next present.
+		 */
+		void setPipelined(bool pPipelined) { m_Pipelined = pPipelined; }
+
+		/**
+		 * How long each frame may spend finishing assets requested through
+		 * AssetLoader::loadAsync() before it moves on.
+		 */
+		[[nodiscard]] std::chrono::nanoseconds getUploadBudget() const { return m_UploadBudget; }
+
+		void setUploadBudget(std::chrono::nanoseconds pBudget) { m_UploadBudget = pBudget; }
+
 		void setLevel(level::Level *pLevel) {
 			m_Level = pLevel;
 		}
 
 	public:
 		Application(int pWindowWidth, int pWindowHeight, const std::string &pWindowTitle);
+
+		/**
+		 * Creates a headless application.
+		 *
+		 * @param pViewportSize The size cameras render at, in place of a
+		 * window's.
+		 */
+		explicit Application(glm::ivec2 pViewportSize);
+
 		virtual ~Application();
 
-		virtual void render();
+		/**
+		 * @param pAlpha Time since the last tick, as a fraction of a tick
+		 * from 0 to 1.
+		 */
+		virtual void render(float pAlpha);
+
+		/**
+		 * Collects what to draw into a snapshot, without touching the
+		 * graphics implementation.
+		 */
+		virtual void record(level::FrameSnapshot &pSnapshot, float pAlpha);
+
+		/**
+		 * Draws a snapshot from record(). Runs on the main thread.
+		 */
+		virtual void present(const level::FrameSnapshot &pSnapshot);
+
+		/**
+		 * Advances the simulation by one tick of getTickDuration().
+		 */
 		virtual void update();
 
 		void run();
 
+		/**
+		 * Makes run() return once the current frame is done. Safe to call
+		 * from update() and record() in pipelined mode.
+		 */
+		void stop() { m_StopRequested = true; }
+
 		[[nodiscard]] Instance *getInstance() const;
+
+		[[nodiscard]] std::chrono::nanoseconds getTickDuration() const {
+			return std::chrono::nanoseconds(static_cast<int64_t>(1000000000.0 / m_TickRate));
+		}
+
+		/**
+		 * @return How many ticks have run since run() was called.
+		 */
+		[[nodiscard]] uint64_t getTickCount() const { return m_TickCount; }
+
+		/**
+		 * @return How many ticks were skipped because a frame reached the
+		 * catch-up limit.
+		 */
+		[[nodiscard]] uint64_t getDroppedTicks() const { return m_DroppedTicks; }
 	};
 
 }// namespace aurora
@@ -5,12 +5,33 @@
 
 #include "asset_loader.h"
 #include <fstream>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <nlohmann/json.hpp>
 #include <aurora/resources.h>
 #include <aurora/shaders/shaders.h>
+#include <aurora/aether/profiler.h>
 
 namespace aurora {
-	AssetLoader::AssetLoader(const std::filesystem::path &pPath) {
+	struct AssetLoader::PackMapping {
+		boost::interprocess::file_mapping file;
+		boost::interprocess::mapped_region region;
+
+		explicit PackMapping(const std::filesystem::path &pPath)
+			: file(pPath.string().c_str(), boost::interprocess::read_only),
+			  region(file, boost::interprocess::read_only) {}
+	};
+
+	AssetLoader::AssetLoader(const std::filesystem::path &pPath)
+		: m_Root(pPath), m_ContextThread(std::this_thread::get_id()) {
+		if(std::filesystem::exists(pPath / aether::Pack::fileName)) {
+			m_PackMapping = std::make_unique<PackMapping>(pPath / aether::Pack::fileName);
+			m_Pack = {static_cast<const uint8_t *>(m_PackMapping->region.get_address()),
+			          m_PackMapping->region.get_size()};
+			aether::Pack::validate(m_Pack);
+			return;
+		}
+
 		if(!std::filesystem::exists(pPath / "assets.idx.aet")) {
 			throw std::runtime_error("no assets index present in " + std::filesystem::absolute(pPath).string());
 		}
@@ -22,6 +43,396 @@ namespace aurora {
 		}
 	}
 
+	AssetLoader::~AssetLoader() {
+		{
+			std::lock_guard lock(m_JobMutex);
+			m_Stopping = true;
+		}
+		m_JobCondition.notify_all();
+
+		for(auto &item: m_Workers) { item.join(); }
+
+		// Whatever is left is destroyed while the implementation is still
+		// alive: unreferenced assets in the cache, and injected ones.
+		clearCache();
+
+		std::vector<std::shared_ptr<Ref>> pinned;
+		for(auto &shard: m_Refs) {
+			std::unique_lock lock(shard.mutex);
+			for(const auto &item: shard.refs) {
+				if(item.second->pinned) { pinned.push_back(item.second); }
+			}
+		}
+
+		for(const auto &ref: pinned) { destroy(ref, false); }
+		destroyRetired();
+	}
+
+	std::shared_ptr<AssetLoader::Ref> AssetLoader::acquire(const std::string &pAssetId, std::type_index pType,
+	                                                       bool &pOwner) {
+		auto &shard = shardOf(pAssetId);
+		std::shared_ptr<Ref> ref;
+		pOwner = false;
+
+		// The count is taken while the shard is locked, so that release()
+		// cannot cache or destroy the entry in between.
+		auto take = [this](const std::shared_ptr<Ref> &pRef) {
+			if(pRef->refs++ != 0) { return; }
+
+			std::lock_guard lock(m_CacheMutex);
+			if(pRef->cached) {
+				m_Cache.erase(pRef->lru);
+				pRef->cached = false;
+				m_CacheStats[pRef->type].cached--;
+				m_CacheTotals.cached--;
+			}
+		};
+
+		{
+			std::shared_lock lock(shard.mutex);
+			auto iter = shard.refs.find(pAssetId);
+			if(iter != shard.refs.end()) {
+				ref = iter->second;
+				take(ref);
+			}
+		}
+
+		if(ref == nullptr) {
+			std::unique_lock lock(shard.mutex);
+			auto [iter, inserted] = shard.refs.try_emplace(pAssetId);
+			if(inserted) {
+				iter->second = std::make_shared<Ref>(pAssetId, pType);
+				pOwner = true;
+			} else {
+				take(iter->second);
+			}
+			ref = iter->second;
+		}
+
+		std::lock_guard lock(m_CacheMutex);
+		auto &stats = m_CacheStats[pType];
+		if(pOwner) {
+			stats.misses++;
+			m_CacheTotals.misses++;
+		} else {
+			stats.hits++;
+			m_CacheTotals.hits++;
+		}
+
+		return ref;
+	}
+
+	void AssetLoader::publish(const std::shared_ptr<Ref> &pRef, void *pPointer, void (*pDestroy)(void *),
+	                          bool pContextFree, AssetFootprint pFootprint) {
+		pRef->ptr = pPointer;
+		pRef->destroy = pDestroy;
+		pRef->contextFree = pContextFree;
+		pRef->footprint = pFootprint;
+
+		{
+			std::lock_guard lock(m_CacheMutex);
+			auto &stats = m_CacheStats[pRef->type];
+			stats.cpuBytes += pFootprint.cpuBytes;
+			stats.gpuBytes += pFootprint.gpuBytes;
+			m_CacheTotals.cpuBytes += pFootprint.cpuBytes;
+			m_CacheTotals.gpuBytes += pFootprint.gpuBytes;
+		}
+
+		{
+			auto &shard = shardOf(pPointer);
+			std::unique_lock lock(shard.mutex);
+			shard.refs[pPointer] = pRef;
+		}
+
+		pRef->promise.set_value(pPointer);
+		AURORA_PROFILE_COUNT(AssetsLoaded, 1);
+
+		trimCache(getCacheBudget());
+	}
+
+	void AssetLoader::abandon(const std::shared_ptr<Ref> &pRef, std::exception_ptr pError) {
+		{
+			auto &shard = shardOf(pRef->id);
+			std::unique_lock lock(shard.mutex);
+			auto iter = shard.refs.find(pRef->id);
+			if(iter != shard.refs.end() && iter->second == pRef) { shard.refs.erase(iter); }
+		}
+
+		pRef->promise.set_exception(std::move(pError));
+	}
+
+	void *AssetLoader::await(const std::shared_ptr<Ref> &pRef) {
+		// The context thread has to keep pumping, or an asynchronous load of
+		// this same asset would sit in the upload queue forever.
+		if(std::this_thread::get_id() == m_ContextThread) {
+			while(pRef->value.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				pumpUploads(std::chrono::nanoseconds(0));
+				pRef->value.wait_for(std::chrono::microseconds(100));
+			}
+		}
+
+		return pRef->value.get();
+	}
+
+	bool AssetLoader::release(void *pPointer) {
+		std::shared_ptr<Ref> ref;
+
+		{
+			auto &shard = shardOf(pPointer);
+			std::shared_lock lock(shard.mutex);
+			auto iter = shard.refs.find(pPointer);
+			if(iter == shard.refs.end()) { return false; }
+			ref = iter->second;
+		}
+
+		if(ref->pinned) { return true; }
+
+		// A reference that is not the last is dropped without a lock.
+		auto count = ref->refs.load();
+		while(count > 1) {
+			if(ref->refs.compare_exchange_weak(count, count - 1)) { return true; }
+		}
+
+		bool cached = false;
+		{
+			// The last one is dropped with the shard locked, which keeps
+			// acquire() out, so that the count reaching zero and the asset
+			// being cached or erased happen as one. A concurrent load may have
+			// picked the asset up again before we got the lock; in that case
+			// it stays.
+			auto &shard = shardOf(ref->id);
+			std::unique_lock lock(shard.mutex);
+			if(--ref->refs > 0) { return true; }
+
+			auto iter = shard.refs.find(ref->id);
+			if(iter == shard.refs.end() || iter->second != ref) { return false; }
+
+			std::unique_lock cacheLock(m_CacheMutex);
+			if(ref->footprint.cpuBytes <= m_CacheBudget.cpuBytes && ref->footprint.gpuBytes <= m_CacheBudget.gpuBytes) {
+				ref->lru = m_Cache.emplace(m_Cache.begin(), ref);
+				ref->cached = cached = true;
+				m_CacheStats[ref->type].cached++;
+				m_CacheTotals.cached++;
+			} else {
+				cacheLock.unlock();
+				shard.refs.erase(iter);
+
+				auto &ptrShard = shardOf(pPointer);
+				std::unique_lock ptrLock(ptrShard.mutex);
+				ptrShard.refs.erase(pPointer);
+			}
+		}
+
+		if(cached) { trimCache(getCacheBudget()); }
+		else { destroy(ref, false); }
+		return false;
+	}
+
+	void AssetLoader::destroy(const std::shared_ptr<Ref> &pRef, bool pEvicted) {
+		{
+			// The bytes are given back now, so that a trim running before the
+			// asset is actually destroyed does not evict more than it has to.
+			std::lock_guard lock(m_CacheMutex);
+			auto &stats = m_CacheStats[pRef->type];
+			stats.cpuBytes -= pRef->footprint.cpuBytes;
+			stats.gpuBytes -= pRef->footprint.gpuBytes;
+			m_CacheTotals.cpuBytes -= pRef->footprint.cpuBytes;
+			m_CacheTotals.gpuBytes -= pRef->footprint.gpuBytes;
+
+			if(pEvicted) {
+				stats.evictions++;
+				m_CacheTotals.evictions++;
+			}
+		}
+
+		if(pRef->contextFree || std::this_thread::get_id() == m_ContextThread) {
+			pRef->destroy(pRef->ptr);
+		} else {
+			std::lock_guard lock(m_UploadMutex);
+			m_Retired.emplace_back(pRef);
+		}
+	}
+
+	void AssetLoader::destroyRetired() {
+		std::vector<std::shared_ptr<Ref>> retired;
+
+		{
+			std::lock_guard lock(m_UploadMutex);
+			retired.swap(m_Retired);
+		}
+
+		for(const auto &ref: retired) { ref->destroy(ref->ptr); }
+	}
+
+	void AssetLoader::trimCache(const AssetCacheBudget &pBudget) {
+		std::vector<std::shared_ptr<Ref>> victims;
+
+		{
+			std::lock_guard lock(m_CacheMutex);
+			auto cpuBytes = m_CacheTotals.cpuBytes;
+			auto gpuBytes = m_CacheTotals.gpuBytes;
+
+			while(!m_Cache.empty() && (cpuBytes > pBudget.cpuBytes || gpuBytes > pBudget.gpuBytes)) {
+				auto ref = std::move(m_Cache.back());
+				m_Cache.pop_back();
+				ref->cached = false;
+				m_CacheStats[ref->type].cached--;
+				m_CacheTotals.cached--;
+
+				cpuBytes -= ref->footprint.cpuBytes;
+				gpuBytes -= ref->footprint.gpuBytes;
+				victims.emplace_back(std::move(ref));
+			}
+		}
+
+		for(const auto &ref: victims) {
+			{
+				auto &shard = shardOf(ref->id);
+				std::unique_lock lock(shard.mutex);
+				if(ref->refs > 0) { continue; }
+
+				// It may have been loaded and released again since it was
+				// taken off the list, which puts it back in the cache.
+				{
+					std::lock_guard cacheLock(m_CacheMutex);
+					if(ref->cached) { continue; }
+				}
+
+				auto iter = shard.refs.find(ref->id);
+				if(iter == shard.refs.end() || iter->second != ref) { continue; }
+				shard.refs.erase(iter);
+
+				auto &ptrShard = shardOf(ref->ptr);
+				std::unique_lock ptrLock(ptrShard.mutex);
+				ptrShard.refs.erase(ref->ptr);
+			}
+
+			destroy(ref, true);
+		}
+	}
+
+	void AssetLoader::pin(const std::string &pAssetId, void *pPointer, void (*pDestroy)(void *), bool pContextFree) {
+		auto ref = std::make_shared<Ref>(pAssetId, typeid(void));
+		ref->pinned = true;
+
+		{
+			auto &shard = shardOf(pAssetId);
+			std::unique_lock lock(shard.mutex);
+			shard.refs[pAssetId] = ref;
+		}
+
+		publish(ref, pPointer, pDestroy, pContextFree, {});
+	}
+
+	void AssetLoader::setCacheBudget(const AssetCacheBudget &pBudget) {
+		{
+			std::lock_guard lock(m_CacheMutex);
+			m_CacheBudget = pBudget;
+		}
+
+		trimCache(pBudget);
+	}
+
+	AssetCacheBudget AssetLoader::getCacheBudget() const {
+		std::lock_guard lock(m_CacheMutex);
+		return m_CacheBudget;
+	}
+
+	void AssetLoader::clearCache() {
+		trimCache({0, 0});
+	}
+
+	AssetCacheStats AssetLoader::getCacheStats() const {
+		std::lock_guard lock(m_CacheMutex);
+		return m_CacheTotals;
+	}
+
+	AssetCacheStats AssetLoader::getCacheStats(std::type_index pType) const {
+		std::lock_guard lock(m_CacheMutex);
+		auto iter = m_CacheStats.find(pType);
+		return iter == m_CacheStats.end() ? AssetCacheStats() : iter->second;
+	}
+
+	void AssetLoader::runWorker() {
+		AURORA_PROFILE_THREAD("Asset loader worker");
+
+		while(true) {
+			std::function<void()> job;
+
+			{
+				std::unique_lock lock(m_JobMutex);
+				m_JobCondition.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+				if(m_Stopping) { return; }
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+			}
+
+			job();
+		}
+	}
+
+	void AssetLoader::enqueueJob(std::function<void()> pJob) {
+		{
+			std::lock_guard lock(m_JobMutex);
+
+			if(m_Workers.empty()) {
+				auto count = std::max(1u, std::thread::hardware_concurrency() / 2);
+				for(unsigned i = 0; i < count; ++i) { m_Workers.emplace_back(&AssetLoader::runWorker, this); }
+			}
+
+			m_Jobs.emplace_back(std::move(pJob));
+		}
+		m_JobCondition.notify_one();
+	}
+
+	void AssetLoader::enqueueUpload(std::function<void()> pUpload) {
+		std::lock_guard lock(m_UploadMutex);
+		m_Uploads.emplace_back(std::move(pUpload));
+	}
+
+	void AssetLoader::pumpUploads(std::chrono::nanoseconds pBudget) {
+		AURORA_PROFILE_ZONE("AssetLoader::pumpUploads");
+		auto deadline = std::chrono::steady_clock::now() + pBudget;
+		destroyRetired();
+
+		do {
+			std::function<void()> upload;
+
+			{
+				std::lock_guard lock(m_UploadMutex);
+				if(m_Uploads.empty()) { return; }
+
+				upload = std::move(m_Uploads.front());
+				m_Uploads.pop_front();
+			}
+
+			upload();
+		} while(std::chrono::steady_clock::now() < deadline);
+	}
+
+	aether::AssetSource AssetLoader::open(const std::string &pAssetId) {
+		if(!m_Pack.empty()) {
+			auto entry = aether::Pack::find(m_Pack, pAssetId);
+			if(!entry) { throw std::runtime_error("no asset " + pAssetId + " in pack"); }
+			return {std::filesystem::path(entry->path), entry->payload};
+		}
+
+		auto path = m_Index.find(pAssetId);
+		if(path == m_Index.end()) { throw std::runtime_error("no asset " + pAssetId + " in index"); }
+		return aether::AssetSource::readFile(m_Root, path->second);
+	}
+
+	aether::AssetSource AssetLoader::openFile(const std::filesystem::path &pPath) {
+		if(!m_Pack.empty()) {
+			auto entry = aether::Pack::find(m_Pack, aether::Pack::filePrefix + pPath.generic_string());
+			if(!entry) { throw std::runtime_error("no file " + pPath.generic_string() + " in pack"); }
+			return {pPath, entry->payload};
+		}
+
+		return aether::AssetSource::readFile(m_Root, pPath);
+	}
+
 	void injectBuiltinAssets(AssetLoader *pLoader) {
 		pLoader->inject("aurora:test.shader", new Shader(shaders::test));
 
@@ -11,43 +11,396 @@
 #include <unordered_map>
 #include <utility>
 #include <optional>
+#include <memory>
+#include <span>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <future>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <typeindex>
+#include <vector>
 #include <boost/log/trivial.hpp>
+#include <aurora/aether/aether.h>
+#include <aurora/aether/profiler.h>
 
 namespace aurora {
+	class AssetLoader;
+
+	/**
+	 * An asset type that loads in two steps. T::stage() runs on a loader worker
+	 * thread and does the I/O and decoding; the constructor taking the staging
+	 * data runs on the context thread and only creates the GPU objects.
+	 */
+	template<typename T>
+	concept StagedAsset = requires(AssetLoader *pLoader, const aether::AssetSource &pSource, const std::string &pId) {
+		typename T::Staging;
+		{ T::stage(pLoader, pSource, pId) } -> std::same_as<typename T::Staging>;
+	};
+
+	/**
+	 * Whether an asset type never touches the graphics context, so that
+	 * AssetLoader::loadAsync() can construct it entirely on a worker thread.
+	 * Specialise this next to the asset type.
+	 */
+	template<typename T>
+	constexpr bool isContextFreeAsset = false;
+
+	template<> inline constexpr bool isContextFreeAsset<aether::Shader> = true;
+	template<> inline constexpr bool isContextFreeAsset<aether::TextureMeta> = true;
+	template<> inline constexpr bool isContextFreeAsset<aether::Mesh> = true;
+	template<> inline constexpr bool isContextFreeAsset<aether::CompiledMesh> = true;
+	template<> inline constexpr bool isContextFreeAsset<aether::Level> = true;
+
+	/**
+	 * The memory an asset keeps resident while it is loaded.
+	 */
+	struct AssetFootprint {
+		size_t cpuBytes = 0;
+		size_t gpuBytes = 0;
+	};
+
+	/**
+	 * Asset types report their footprint through a getFootprint() member;
+	 * types without one count as their own size.
+	 */
+	template<typename T>
+	AssetFootprint footprintOf(const T &pAsset) {
+		if constexpr(requires { { pAsset.getFootprint() } -> std::same_as<AssetFootprint>; }) {
+			return pAsset.getFootprint();
+		} else {
+			return {sizeof(T), 0};
+		}
+	}
+
+	inline AssetFootprint footprintOf(const aether::Mesh &pMesh) {
+		return {
+			sizeof(aether::Mesh) +
+			pMesh.positions.capacity() * sizeof(glm::vec3) +
+			pMesh.texCoords.capacity() * sizeof(glm::vec2) +
+			pMesh.normals.capacity() * sizeof(glm::vec3) +
+			pMesh.tris.capacity() * sizeof(aether::MeshTri),
+			0
+		};
+	}
+
+	inline AssetFootprint footprintOf(const aether::CompiledMesh &pMesh) {
+		return {sizeof(aether::CompiledMesh) + pMesh.serialize().size(), 0};
+	}
+
+	/**
+	 * How much memory the AssetLoader may keep resident before it starts
+	 * evicting assets that nobody references any more.
+	 */
+	struct AssetCacheBudget {
+		size_t cpuBytes = 128 * 1024 * 1024;
+		size_t gpuBytes = 256 * 1024 * 1024;
+	};
+
+	struct AssetCacheStats {
+		/**
+		 * Resident bytes, counting both referenced and cached assets.
+		 */
+		size_t cpuBytes = 0;
+		size_t gpuBytes = 0;
+
+		/**
+		 * Assets kept in the cache with no references.
+		 */
+		size_t cached = 0;
+
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+	};
+
+	/**
+	 * A handle to an asset requested through AssetLoader::loadAsync().
+	 */
+	template<typename T>
+	class AssetFuture {
+	private:
+		std::shared_future<void *> m_Future;
+
+	public:
+		AssetFuture() = default;
+
+		explicit AssetFuture(std::shared_future<void *> pFuture) : m_Future(std::move(pFuture)) {}
+
+		[[nodiscard]] bool isValid() const { return m_Future.valid(); }
+
+		[[nodiscard]] bool isReady() const {
+			return m_Future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}
+
+		/**
+		 * Blocks until the asset is loaded. Never call this from the context
+		 * thread before the asset is ready, as the upload it waits on would
+		 * never be pumped.
+		 *
+		 * @throws std::exception Whatever stopped the asset from loading.
+		 */
+		T *get() const { return reinterpret_cast<T *>(m_Future.get()); }
+	};
+
 	class AssetLoader {
+		/*
+		 * One entry per asset id. An entry is published to the id table as
+		 * soon as some thread starts loading it, so that every other thread
+		 * asking for the same id waits on value instead of loading it again.
+		 * Once its last reference is gone, an entry either stays in the id
+		 * table and joins the LRU list, or is destroyed.
+		 */
 		struct Ref {
-			void *ptr;
-			int refs;
+			std::string id;
+			std::type_index type;
+			std::atomic<int> refs = 1;
+			bool pinned = false;
+			std::promise<void *> promise;
+			std::shared_future<void *> value = promise.get_future().share();
+			void *ptr = nullptr;
+			void (*destroy)(void *) = nullptr;
+			bool contextFree = false;
+			AssetFootprint footprint;
+			bool cached = false;
+			std::list<std::shared_ptr<Ref>>::iterator lru;
+
+			Ref(std::string pId, std::type_index pType) : id(std::move(pId)), type(pType) {}
+		};
+
+		template<typename K>
+		struct Shard {
+			std::shared_mutex mutex;
+			std::unordered_map<K, std::shared_ptr<Ref>> refs;
 		};
 
+		static constexpr size_t shardCount = 16;
+
+		/*
+		 * Keeps assets.apack mapped for as long as the loader lives, so that
+		 * assets can borrow their bytes straight from the mapping.
+		 */
+		struct PackMapping;
+
+		std::filesystem::path m_Root;
+		std::unique_ptr<PackMapping> m_PackMapping;
+		std::span<const uint8_t> m_Pack;
 		std::unordered_map<std::string, std::filesystem::path> m_Index;
-		std::unordered_map<std::string, Ref *> m_Refs;
-		std::unordered_map<void *, Ref *> m_RefsByPtr;
+		std::array<Shard<std::string>, shardCount> m_Refs;
+		std::array<Shard<void *>, shardCount> m_RefsByPtr;
+		std::thread::id m_ContextThread;
+
+		mutable std::mutex m_CacheMutex;
+		AssetCacheBudget m_CacheBudget;
+		std::list<std::shared_ptr<Ref>> m_Cache;
+		AssetCacheStats m_CacheTotals;
+		std::unordered_map<std::type_index, AssetCacheStats> m_CacheStats;
+
+		std::vector<std::thread> m_Workers;
+		std::mutex m_JobMutex;
+		std::condition_variable m_JobCondition;
+		std::deque<std::function<void()>> m_Jobs;
+		bool m_Stopping = false;
+
+		std::mutex m_UploadMutex;
+		std::deque<std::function<void()>> m_Uploads;
+
+		// Assets released off the context thread that still hold GPU
+		// objects; pumpUploads() destroys them.
+		std::vector<std::shared_ptr<Ref>> m_Retired;
+
+		void runWorker();
+		void enqueueJob(std::function<void()> pJob);
+		void enqueueUpload(std::function<void()> pUpload);
+
+		Shard<std::string> &shardOf(const std::string &pAssetId) {
+			return m_Refs[std::hash<std::string>()(pAssetId) % shardCount];
+		}
+
+		Shard<void *> &shardOf(void *pPointer) {
+			return m_RefsByPtr[std::hash<void *>()(pPointer) % shardCount];
+		}
+
+		/*
+		 * Takes a reference to the entry for pAssetId, creating a pending one
+		 * if there is none. pOwner is set when the caller created it, and so
+		 * must finish it with publish() or abandon().
+		 */
+		std::shared_ptr<Ref> acquire(const std::string &pAssetId, std::type_index pType, bool &pOwner);
+		void publish(const std::shared_ptr<Ref> &pRef, void *pPointer, void (*pDestroy)(void *), bool pContextFree,
+		             AssetFootprint pFootprint);
+		void abandon(const std::shared_ptr<Ref> &pRef, std::exception_ptr pError);
+		void *await(const std::shared_ptr<Ref> &pRef);
+
+		template<typename T>
+		void publish(const std::shared_ptr<Ref> &pRef, T *pPointer) {
+			publish(pRef, pPointer, [](void *pAsset) { delete reinterpret_cast<T *>(pAsset); }, isContextFreeAsset<T>,
+			        footprintOf(*pPointer));
+		}
+
+		/*
+		 * Drops one reference to pPointer, and returns whether it is still
+		 * referenced. The last reference moves the asset into the cache, or
+		 * destroys it when it cannot fit.
+		 */
+		bool release(void *pPointer);
+
+		/*
+		 * Destroys an entry that has already been taken out of the tables,
+		 * right away if that is safe on this thread and otherwise by the next
+		 * pumpUploads().
+		 */
+		void destroy(const std::shared_ptr<Ref> &pRef, bool pEvicted);
+		void destroyRetired();
+		void trimCache(const AssetCacheBudget &pBudget);
+		void pin(const std::string &pAssetId, void *pPointer, void (*pDestroy)(void *), bool pContextFree);
+
+		template<typename F>
+		void finishOnContext(const std::shared_ptr<Ref> &pRef, F pCreate) {
+			enqueueUpload([this, pRef, pCreate]() {
+				try {
+					publish(pRef, pCreate());
+				} catch(...) {
+					abandon(pRef, std::current_exception());
+				}
+			});
+		}
 
 	public:
+		/**
+		 * Maps the asset pack in pPath if there is one, and otherwise falls
+		 * back to the loose files listed by the asset index. The calling
+		 * thread is taken to be the one that owns the graphics context.
+		 *
+		 * @throws std::runtime_error Neither a pack nor an index is present.
+		 */
 		explicit AssetLoader(const std::filesystem::path &pPath);
 
-		template<typename T>
-		T *load(const std::string &pAssetId) {
-			if(m_Refs.contains(pAssetId)) {
-				auto ref = m_Refs[pAssetId];
-				ref->refs++;
-				return reinterpret_cast<T *>(ref->ptr);
-			} else {
-				T *ptr = new T(this, m_Index[pAssetId], pAssetId);
+		~AssetLoader();
+
+		AssetLoader(const AssetLoader &) = delete;
+		AssetLoader &operator=(const AssetLoader &) = delete;
+
+		/**
+		 * Fetches the bytes of an asset without constructing it.
+		 *
+		 * @throws std::runtime_error The asset does not exist.
+		 */
+		aether::AssetSource open(const std::string &pAssetId);
 
-				auto r = new Ref{
-					.ptr = ptr,
-					.refs = 1
-				};
+		/**
+		 * Fetches the bytes of a file that an asset refers to, such as the
+		 * image of a texture.
+		 *
+		 * @param pPath Path relative to the asset root; see aether::AssetSource::resolve.
+		 * @throws std::runtime_error The file does not exist.
+		 */
+		aether::AssetSource openFile(const std::filesystem::path &pPath);
 
-				m_Refs[pAssetId] = r;
-				m_RefsByPtr[ptr] = r;
+		/**
+		 * Loads an asset, or takes another reference to it if it is already
+		 * loaded. Concurrent loads of the same id construct it only once.
+		 *
+		 * Only types marked with isContextFreeAsset may be loaded from any
+		 * thread. Any other type creates GPU objects in its constructor, and
+		 * must be loaded on the context thread or through loadAsync().
+		 */
+		template<typename T>
+		T *load(const std::string &pAssetId) {
+			bool owner;
+			auto ref = acquire(pAssetId, typeid(T), owner);
+			if(!owner) { return reinterpret_cast<T *>(await(ref)); }
 
+			AURORA_PROFILE_ZONE("AssetLoader::load");
+			try {
+				T *ptr = new T(this, open(pAssetId), pAssetId);
+				publish(ref, ptr);
 				return ptr;
+			} catch(...) {
+				abandon(ref, std::current_exception());
+				throw;
 			}
 		}
 
+		/**
+		 * Loads an asset without blocking the caller. Reading and decoding
+		 * happen on a worker thread; whatever needs the graphics context is
+		 * queued and finished by pumpUploads(), which must be called from the
+		 * context thread. The result counts as a reference, exactly like
+		 * load(), and is released with unload().
+		 *
+		 * @return A handle that becomes ready once the asset is usable, or
+		 * holds the exception that stopped it from loading.
+		 */
+		template<typename T>
+		AssetFuture<T> loadAsync(const std::string &pAssetId) {
+			bool owner;
+			auto ref = acquire(pAssetId, typeid(T), owner);
+			if(!owner) { return AssetFuture<T>(ref->value); }
+
+			enqueueJob([this, ref, pAssetId]() {
+				AURORA_PROFILE_ZONE("AssetLoader::loadAsync");
+				try {
+					auto source = open(pAssetId);
+
+					if constexpr(isContextFreeAsset<T>) {
+						publish(ref, new T(this, source, pAssetId));
+					} else if constexpr(StagedAsset<T>) {
+						auto staging = std::make_shared<typename T::Staging>(T::stage(this, source, pAssetId));
+						finishOnContext(ref, [this, staging, pAssetId]() {
+							return new T(this, std::move(*staging), pAssetId);
+						});
+					} else {
+						auto shared = std::make_shared<aether::AssetSource>(std::move(source));
+						finishOnContext(ref, [this, shared, pAssetId]() {
+							return new T(this, *shared, pAssetId);
+						});
+					}
+				} catch(...) {
+					abandon(ref, std::current_exception());
+				}
+			});
+
+			return AssetFuture<T>(ref->value);
+		}
+
+		/**
+		 * Finishes queued asynchronous loads on the calling thread, which must
+		 * own the graphics context. Runs at least one queued step, then keeps
+		 * going until the queue is empty or pBudget has passed.
+		 *
+		 * Assets that were released or evicted on other threads and need the
+		 * context to be destroyed are destroyed here first.
+		 */
+		void pumpUploads(std::chrono::nanoseconds pBudget);
+
+		/**
+		 * Sets how much the loader may keep resident. Unreferenced assets are
+		 * evicted, least recently used first, until both limits are met.
+		 */
+		void setCacheBudget(const AssetCacheBudget &pBudget);
+
+		[[nodiscard]] AssetCacheBudget getCacheBudget() const;
+
+		/**
+		 * Destroys every cached asset that nobody references.
+		 */
+		void clearCache();
+
+		[[nodiscard]] AssetCacheStats getCacheStats() const;
+
+		[[nodiscard]] AssetCacheStats getCacheStats(std::type_index pType) const;
+
+		template<typename T>
+		[[nodiscard]] AssetCacheStats getCacheStats() const { return getCacheStats(typeid(T)); }
+
 		template<typename T>
 		T *tryLoad(const std::string &pAssetId, const std::string &pDefaultAssetId = T::missingAssetName) {
 			try {
@@ -63,34 +416,30 @@ namespace aurora {
 
 		/**
 		 * Tells the asset loader that the caller is no longer using the asset pointed to
-		 * by pPointer. If the asset is unloaded by this call or does not exist, this function
-		 * returns false. If the asset lives past this call, it returns true.
+		 * by pPointer. If this drops the last reference or the asset does not exist, this
+		 * function returns false. If the asset is still referenced, it returns true.
 		 *
-		 * @tparam T Required due to delete restrictions.
+		 * An asset without references is kept in the cache, so that loading it again is
+		 * free, until the cache budget forces it out.
+		 *
+		 * May be called from any thread. An asset that needs the graphics context to be
+		 * destroyed is only destroyed by the next pumpUploads() on the context thread.
+		 *
+		 * @tparam T The type the asset was loaded as.
 		 */
 		template<typename T>
-		bool unload(void *pPointer) {
-			if(!m_RefsByPtr.contains(pPointer)) { return false; }
-			auto ref = m_RefsByPtr[pPointer];
-
-			if(ref->refs != -1 && --ref->refs <= 0) {
-				delete reinterpret_cast<T *>(ref->ptr);
-				delete ref;
-				return false;
-			} else {
-				return true;
-			}
+		bool unload(T *pPointer) {
+			return release(pPointer);
 		}
 
+		/**
+		 * Registers an asset that was created outside the loader. Injected
+		 * assets are never unloaded; the loader takes ownership and destroys
+		 * them along with itself.
+		 */
 		template<typename T>
 		void inject(const std::string &pAssetId, T *pPointer) {
-			auto r = new Ref{
-				.ptr = pPointer,
-				.refs = -1
-			};
-
-			m_Refs[pAssetId] = r;
-			m_RefsByPtr[pPointer] = r;
+			pin(pAssetId, pPointer, [](void *pAsset) { delete reinterpret_cast<T *>(pAsset); }, isContextFreeAsset<T>);
 		}
 	};
 
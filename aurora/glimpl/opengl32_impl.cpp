@@ -6,8 +6,11 @@
 #include <GL/glew.h>
 #include <sail-c++/sail-c++.h>
 #include "opengl_impl.h"
+#include "aurora/aether/profiler.h"
 #include <GLFW/glfw3.h>
 #include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -51,6 +54,20 @@ namespace aurora {
 		{"MatrixPerspective", ShaderUniformType::MatrixPerspective}
 	};
 
+	std::unordered_map<std::string, ShaderBlockType> blockTypes{
+		{"Camera",  ShaderBlockType::Camera},
+		{"Objects", ShaderBlockType::Objects}
+	};
+
+	std::string vertexArrayKey(uintptr_t pShader, uintptr_t pVertexBuffer, uintptr_t pIndexBuffer,
+	                           const VertexArrangement &pArrangement) {
+		auto key = std::to_string(pShader) + ' ' + std::to_string(pVertexBuffer) + ' ' + std::to_string(pIndexBuffer);
+		for(const auto &a: pArrangement) {
+			key += '\n' + a.name + ' ' + std::to_string(static_cast<int>(a.type)) + ' ' + std::to_string(a.count);
+		}
+		return key;
+	}
+
 	ObjRefBase *OpenGlImplementation<3, 2>::createShader(const aether::Shader &pShader) {
 		int program = glCreateProgram();
 
@@ -99,9 +116,55 @@ namespace aurora {
 		else if(length > 0) BOOST_LOG_TRIVIAL(warning) << std::string(log, length);
 
 		auto ref = new ShaderReference(program);
+		m_State.useProgram(program);
+
+		for(const auto &item: pShader.instanceInputs) {
+			if(item.purpose != "MatrixObject") {
+				throw std::runtime_error("invalid shader instance input: " + item.purpose);
+			}
+			ref->instanceLocation = glGetAttribLocation(program, item.name.c_str());
+		}
 
 		for(const auto &item: pShader.uniforms) {
-			ref->uniforms[item.name] = uniformTypes.at(item.purpose);
+			auto type = uniformTypes.at(item.purpose);
+			auto loc = glGetUniformLocation(program, item.name.c_str());
+			if(loc == -1) { continue; } // Unused, and optimised out by the linker.
+
+			switch(type) {
+				case ShaderUniformType::MatrixObject:
+				case ShaderUniformType::MatrixView:
+				case ShaderUniformType::MatrixPerspective: ref->uniforms.push_back({loc, type});
+					break;
+				default:
+					// Sampler types are declared in texture unit order, so the
+					// value of the enum is the unit the sampler reads from.
+					glUniform1i(loc, static_cast<int>(type));
+					break;
+			}
+		}
+
+		for(const auto &item: pShader.blocks) {
+			auto type = blockTypes.at(item.purpose);
+			auto index = glGetUniformBlockIndex(program, item.name.c_str());
+			if(index == GL_INVALID_INDEX) { continue; } // Unused, as above.
+
+			GLint size;
+			glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+
+			if(type == ShaderBlockType::Camera && static_cast<size_t>(size) > sizeof(CameraBlock)) {
+				throw EShaderCompile("Camera block " + item.name + " has members CameraBlock does not");
+			}
+			if(type == ShaderBlockType::Objects) {
+				if(ref->instanceLocation >= 0) {
+					throw EShaderCompile("shader reads object matrices from an instance input and a block");
+				}
+				ref->objectBlockSize = static_cast<size_t>(size);
+				ref->objectCapacity = static_cast<uint32_t>(size / sizeof(glm::mat4));
+				if(ref->objectCapacity == 0) { throw EShaderCompile("Objects block " + item.name + " is empty"); }
+			}
+
+			// Bindings stay with the program, so they are only set here.
+			glUniformBlockBinding(program, index, static_cast<GLuint>(type));
 		}
 
 		return ref;
@@ -111,6 +174,7 @@ namespace aurora {
 		auto ref = dynamic_cast<ShaderReference *>(pObject);
 		if(ref == nullptr) { return; }
 
+		m_State.forgetProgram(ref->resource);
 		glDeleteProgram(ref->resource);
 		delete ref;
 	}
@@ -137,9 +201,32 @@ namespace aurora {
 		m_Max1DDim = m_Max2DDim;
 
 		glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &m_Max3DDim);
+
+		// Attribute divisors are only core from 3.3, but the extension is
+		// available on nearly everything that runs 3.2.
+		m_HasInstancedArrays = GLEW_ARB_instanced_arrays;
+		glGenBuffers(1, &m_InstanceBuffer);
+
+		GLint alignment;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		m_UniformAlignment = static_cast<size_t>(std::max(alignment, 1));
+
+		// The type is only ever looked at by draw objects, which never see it.
+		m_UniformBuffer = static_cast<StreamBufferReference *>(createStreamBuffer(VertexBuffer, uniformRingSize));
 	}
 
 	void OpenGlImplementation<3, 2>::performFinishFrame(Window *pWindow) {
+		for(auto item: m_StreamBuffers) {
+			if(item->head == 0) { continue; }
+
+			// The driver gives the buffer new memory, and frees the old once
+			// the GPU is done with it.
+			unmapStreamBuffer(item);
+			m_State.bindArrayBuffer(item->resource);
+			glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(item->size), nullptr, GL_STREAM_DRAW);
+			item->head = 0;
+		}
+
 		glfwSwapBuffers(pWindow->getGlfw());
 	}
 
@@ -165,48 +252,136 @@ namespace aurora {
 		auto ref = dynamic_cast<BufferReference *>(pObject);
 		if(ref == nullptr) { return; }
 
+		m_State.forgetBuffer(ref->resource);
 		glDeleteBuffers(1, &ref->resource);
 		delete ref;
 	}
 
-	void OpenGlImplementation<3, 2>::updateBufferData(ObjRefBase *pObject, void *pData, size_t pSize) {
+	void OpenGlImplementation<3, 2>::updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize) {
 		auto ref = dynamic_cast<BufferReference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid buffer reference"); }
-		glBindBuffer(GL_ARRAY_BUFFER, ref->resource);
+		m_State.bindArrayBuffer(ref->resource);
 		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(pSize), pData, GL_STATIC_DRAW);
+		ref->size = pSize;
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, pSize);
 	}
 
-	void OpenGlImplementation<3, 2>::updateBufferData(ObjRefBase *pObject, void *pData, size_t pSize, size_t pOffset) {
+	void
+	OpenGlImplementation<3, 2>::updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize, size_t pOffset) {
 		auto ref = dynamic_cast<BufferReference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid buffer reference"); }
-		glBindBuffer(GL_ARRAY_BUFFER, ref->resource);
-
-		GLint size;
-		glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
-
-		if(pOffset + pSize > size) {
+		if(pOffset + pSize > ref->size) {
 			throw EBufferOverflow("buffer too small");
 		}
 
+		m_State.bindArrayBuffer(ref->resource);
 		glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(pOffset), static_cast<GLsizeiptr>(pSize), pData);
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, pSize);
 	}
 
 	void
 	OpenGlImplementation<3, 2>::retrieveBufferData(ObjRefBase *pObject, void *pData, size_t pSize, size_t pOffset) {
 		auto ref = dynamic_cast<BufferReference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid buffer reference"); }
-		glBindBuffer(GL_ARRAY_BUFFER, ref->resource);
-
-		GLint size;
-		glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
-
-		if(pOffset + pSize > size) {
+		if(pOffset + pSize > ref->size) {
 			throw EBufferUnderflow("buffer too small");
 		}
 
+		m_State.bindArrayBuffer(ref->resource);
 		glGetBufferSubData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(pOffset), static_cast<GLsizeiptr>(pSize), pData);
 	}
 
+	ObjRefBase *OpenGlImplementation<3, 2>::createStreamBuffer(BufferType pType, size_t pSize) {
+		GLuint buf;
+		glGenBuffers(1, &buf);
+		auto ref = new StreamBufferReference(buf, pType);
+
+		m_State.bindArrayBuffer(buf);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(pSize), nullptr, GL_STREAM_DRAW);
+		ref->size = pSize;
+		m_StreamBuffers.push_back(ref);
+		return ref;
+	}
+
+	void OpenGlImplementation<3, 2>::destroyStreamBuffer(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<StreamBufferReference *>(pObject);
+		if(ref == nullptr) { return; }
+
+		m_StreamBuffers.erase(std::find(m_StreamBuffers.begin(), m_StreamBuffers.end(), ref));
+
+		// Deleting a mapped buffer unmaps it.
+		m_State.forgetBuffer(ref->resource);
+		glDeleteBuffers(1, &ref->resource);
+		delete ref;
+	}
+
+	StreamBufferRange
+	OpenGlImplementation<3, 2>::mapStreamBuffer(ObjRefBase *pObject, size_t pSize, size_t pAlignment) {
+		auto ref = dynamic_cast<StreamBufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid stream buffer reference"); }
+		if(pSize > ref->size) { throw EBufferOverflow("stream buffer too small"); }
+
+		unmapStreamBuffer(ref);
+		m_State.bindArrayBuffer(ref->resource);
+
+		pAlignment = std::max<size_t>(pAlignment, 1);
+		auto start = (ref->head + pAlignment - 1) / pAlignment * pAlignment;
+		if(start + pSize > ref->size) {
+			// Orphaning now would take the ranges of this frame that are yet
+			// to be drawn with it. Of the uniform ring's, only the Camera
+			// block is still to be read, and it is written again.
+			if(ref != m_UniformBuffer) { throw EBufferOverflow("stream buffer cannot hold one frame of writes"); }
+
+			glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(ref->size), nullptr, GL_STREAM_DRAW);
+			start = 0;
+			m_CameraBlockLost = true;
+		}
+		if(pSize == 0) { return {nullptr, start}; }
+
+		// No range is written twice between orphans, so there is never
+		// anything for the mapping to wait for.
+		auto data = glMapBufferRange(GL_ARRAY_BUFFER, static_cast<GLintptr>(start), static_cast<GLsizeiptr>(pSize),
+		                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if(data == nullptr) { throw std::runtime_error("OpenGL 3.2: could not map stream buffer"); }
+
+		ref->mapped = true;
+		ref->head = start + pSize;
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, pSize);
+		return {data, start};
+	}
+
+	void OpenGlImplementation<3, 2>::unmapStreamBuffer(ObjRefBase *pObject) {
+		auto ref = dynamic_cast<StreamBufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid stream buffer reference"); }
+		if(!ref->mapped) { return; }
+
+		m_State.bindArrayBuffer(ref->resource);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		ref->mapped = false;
+	}
+
+	size_t OpenGlImplementation<3, 2>::writeUniformBlock(const void *pData, size_t pSize, size_t pBlockSize) {
+		// A binding has to cover the whole block, but a shader only reads as
+		// many objects as were drawn, so the ring moves on past just those.
+		auto range = mapStreamBuffer(m_UniformBuffer, pBlockSize, m_UniformAlignment);
+		std::memcpy(range.data, pData, pSize);
+		unmapStreamBuffer(m_UniformBuffer);
+
+		m_UniformBuffer->head = range.offset + pSize;
+
+		if(m_CameraBlockLost) {
+			m_CameraBlockLost = false;
+			if(m_HasCameraBlock) { bindCameraBlock(); }
+		}
+		return range.offset;
+	}
+
+	void OpenGlImplementation<3, 2>::bindCameraBlock() {
+		auto offset = writeUniformBlock(&m_CameraBlock, sizeof(m_CameraBlock), sizeof(m_CameraBlock));
+		glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(ShaderBlockType::Camera), m_UniformBuffer->resource,
+		                  static_cast<GLintptr>(offset), sizeof(m_CameraBlock));
+	}
+
 	ObjRefBase *OpenGlImplementation<3, 2>::createTexture2D() {
 		uint32_t tex;
 		glGenTextures(1, &tex);
@@ -217,6 +392,7 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { return; }
 
+		m_State.forgetTexture(ref->resource);
 		glDeleteTextures(1, &ref->resource);
 		delete ref;
 	}
@@ -234,7 +410,7 @@ namespace aurora {
 			case TextureWrapType::BorderColor: throw std::runtime_error("cannot use this method to set border color");
 		}
 
-		glBindTexture(GL_TEXTURE_2D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture2D, ref->resource);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, e);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, e);
 	}
@@ -243,7 +419,7 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid texture reference"); }
 
-		glBindTexture(GL_TEXTURE_2D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture2D, ref->resource);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 		float color[4] = {
@@ -280,7 +456,7 @@ namespace aurora {
 				break;
 		}
 
-		glBindTexture(GL_TEXTURE_2D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture2D, ref->resource);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag);
 	}
@@ -294,7 +470,7 @@ namespace aurora {
 		}
 
 		auto img = pImage.convert_to(SAIL_PIXEL_FORMAT_BPP32_RGBA);
-		glBindTexture(GL_TEXTURE_2D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture2D, ref->resource);
 		glTexImage2D(GL_TEXTURE_2D,
 		             0,
 		             GL_RGBA8,
@@ -310,28 +486,32 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid texture reference"); }
 
-		glBindTexture(GL_TEXTURE_2D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture2D, ref->resource);
 		glGenerateMipmap(GL_TEXTURE_2D);
 	}
 
-	ObjRefBase *OpenGlImplementation<3, 2>::createDrawObject(const DrawObjectOptions &pOptions) {
-		uint32_t vao;
-		glCreateVertexArrays(1, &vao);
-		glBindVertexArray(vao);
-		auto vRef = dynamic_cast<Reference *>(pOptions.vertexBuffer);
-		auto iRef = dynamic_cast<Reference *>(pOptions.indexBuffer);
-		if(vRef == nullptr) { throw EInvalidRef("invalid vertex buffer reference"); }
-		if(iRef == nullptr) { throw EInvalidRef("invalid index buffer reference"); }
-		glBindBuffer(GL_ARRAY_BUFFER, vRef->resource);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iRef->resource);
+	OpenGlImplementation<3, 2>::VertexArray *
+	OpenGlImplementation<3, 2>::acquireVertexArray(ShaderReference *pShader, Reference *pVertexBuffer,
+	                                               Reference *pIndexBuffer, const VertexArrangement &pArrangement) {
+		auto prog = pShader->resource;
+		auto key = vertexArrayKey(prog, pVertexBuffer->resource, pIndexBuffer->resource, pArrangement);
 
-		auto sRef = dynamic_cast<Reference *>(pOptions.shader);
-		if(sRef == nullptr) { throw EInvalidRef("invalid shader reference"); }
-		auto prog = sRef->resource;
+		auto it = m_VertexArrays.find(key);
+		if(it != m_VertexArrays.end()) {
+			++it->second.refs;
+			return &it->second;
+		}
+
+		uint32_t vao;
+		glGenVertexArrays(1, &vao);
+		m_State.bindVertexArray(vao);
+		m_State.bindArrayBuffer(pVertexBuffer->resource);
+		// The element buffer binding is part of the VAO, so it needs no shadow.
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pIndexBuffer->resource);
 
 		int stride = 0, offset = 0;
 
-		for(auto &a: pOptions.arrangement) {
+		for(auto &a: pArrangement) {
 			int size;
 
 			switch(a.type) {
@@ -346,7 +526,7 @@ namespace aurora {
 			stride += size * a.count;
 		}
 
-		for(auto &a: pOptions.arrangement) {
+		for(auto &a: pArrangement) {
 			int size;
 			GLenum e;
 
@@ -369,150 +549,242 @@ namespace aurora {
 			offset += size * a.count;
 		}
 
-		for(int i = 0; i < 16; ++i) {
-			auto item = pOptions.textures[i];
-			if(item == nullptr) { continue; }
+		auto &vertexArray = m_VertexArrays[key];
+		vertexArray.key = key;
+		vertexArray.resource = vao;
+		vertexArray.refs = 1;
+
+		auto instanceLocation = pShader->instanceLocation;
+		if(instanceLocation >= 0 && m_HasInstancedArrays) {
+			// A mat4 attribute takes four consecutive locations, one per column.
+			m_State.bindArrayBuffer(m_InstanceBuffer);
+			for(int i = 0; i < 4; ++i) {
+				glVertexAttribPointer(instanceLocation + i, 4, GL_FLOAT, false, sizeof(glm::mat4),
+				                      reinterpret_cast<void *>(i * sizeof(glm::vec4)));
+				glEnableVertexAttribArray(instanceLocation + i);
+				glVertexAttribDivisorARB(instanceLocation + i, 1);
+			}
+			vertexArray.instanced = true;
+		}
 
-			auto dyn = dynamic_cast<Reference *>(item);
-			if(dyn == nullptr) { throw EInvalidRef("invalid texture reference"); }
+		return &vertexArray;
+	}
 
-			glActiveTexture(GL_TEXTURE0 + i);
-			glBindTexture(GL_TEXTURE_2D, dyn->resource);
-		}
+	void OpenGlImplementation<3, 2>::releaseVertexArray(VertexArray *pVertexArray) noexcept {
+		if(--pVertexArray->refs > 0) { return; }
 
-		for(int i = 0; i < 8; ++i) {
-			auto item = pOptions.textures1D[i];
-			if(item == nullptr) { continue; }
+		m_State.forgetVertexArray(pVertexArray->resource);
+		glDeleteVertexArrays(1, &pVertexArray->resource);
+		m_VertexArrays.erase(m_VertexArrays.find(pVertexArray->key));
+	}
 
-			auto dyn = dynamic_cast<Reference *>(item);
-			if(dyn == nullptr) { throw EInvalidRef("invalid texture reference"); }
+	ObjRefBase *OpenGlImplementation<3, 2>::createDrawObject(const DrawObjectOptions &pOptions) {
+		auto vRef = dynamic_cast<Reference *>(pOptions.vertexBuffer);
+		auto iRef = dynamic_cast<Reference *>(pOptions.indexBuffer);
+		if(vRef == nullptr) { throw EInvalidRef("invalid vertex buffer reference"); }
+		if(iRef == nullptr) { throw EInvalidRef("invalid index buffer reference"); }
 
-			glActiveTexture(GL_TEXTURE16 + i);
-			glBindTexture(GL_TEXTURE_1D, dyn->resource);
-		}
+		auto sRef = dynamic_cast<ShaderReference *>(pOptions.shader);
+		if(sRef == nullptr) { throw EInvalidRef("invalid shader reference"); }
+		auto prog = sRef->resource;
+
+		auto vertexArray = acquireVertexArray(sRef, vRef, iRef, pOptions.arrangement);
+		auto ref = new DrawObjectReference(vertexArray->resource, pOptions);
+		ref->vertexArray = vertexArray;
+		ref->instanced = vertexArray->instanced;
 
-		for(int i = 0; i < 8; ++i) {
-			auto item = pOptions.textures3D[i];
-			if(item == nullptr) { continue; }
+		auto addTextures = [ref](ObjRefBase *const *pTextures, int pCount, int pFirstUnit,
+		                         OpenGlStateCache::TextureTarget pTarget) {
+			for(int i = 0; i < pCount; ++i) {
+				auto item = pTextures[i];
+				if(item == nullptr) { continue; }
 
-			auto dyn = dynamic_cast<Reference *>(item);
-			if(dyn == nullptr) { throw EInvalidRef("invalid texture reference"); }
+				auto dyn = dynamic_cast<Reference *>(item);
+				if(dyn == nullptr) { throw EInvalidRef("invalid texture reference"); }
+
+				ref->textures.push_back({pFirstUnit + i, pTarget, dyn->resource});
+			}
+		};
 
-			glActiveTexture(GL_TEXTURE24 + i);
-			glBindTexture(GL_TEXTURE_3D, dyn->resource);
+		try {
+			addTextures(pOptions.textures, 16, 0, OpenGlStateCache::TextureTarget::Texture2D);
+			addTextures(pOptions.textures1D, 8, 16, OpenGlStateCache::TextureTarget::Texture1D);
+			addTextures(pOptions.textures3D, 8, 24, OpenGlStateCache::TextureTarget::Texture3D);
+		} catch(...) {
+			destroyDrawObject(ref);
+			throw;
 		}
 
-		glBindVertexArray(0);
-		return new DrawObjectReference(vao, pOptions);
+		// Hashing the VAO in keeps draw objects sharing one next to each other.
+		uint32_t textureHash = (2166136261u ^ ref->resource) * 16777619u;
+		for(const auto &item: ref->textures) {
+			for(auto value: {static_cast<uint32_t>(item.unit), item.texture}) {
+				textureHash ^= value;
+				textureHash *= 16777619u;
+			}
+		}
+		ref->stateKey = (prog & 0xfffu) << 20 | ((textureHash ^ textureHash >> 20) & 0xfffffu);
+
+		return ref;
 	}
 
 	void OpenGlImplementation<3, 2>::destroyDrawObject(ObjRefBase *pObject) noexcept {
 		auto ref = dynamic_cast<DrawObjectReference *>(pObject);
 		if(ref == nullptr) { return; }
 
-		glDeleteVertexArrays(1, &ref->resource);
+		releaseVertexArray(ref->vertexArray);
 		delete ref;
 	}
 
-	void OpenGlImplementation<3, 2>::performDraw(ObjRefBase *pDrawObject, const MatrixSet &pMatrices) {
-		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
-		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+	namespace {
+		GLenum indexFormat(IndexBufferItemType pType) {
+			switch(pType) {
+				case IndexBufferItemType::UnsignedByte: return GL_UNSIGNED_BYTE;
+				case IndexBufferItemType::UnsignedShort: return GL_UNSIGNED_SHORT;
+				default: return GL_UNSIGNED_INT;
+			}
+		}
+	}
 
-		glBindVertexArray(ref->resource);
-		auto sh = ref->shader;
-		glUseProgram(sh->resource);
+	void OpenGlImplementation<3, 2>::bindDrawState(DrawObjectReference *pRef, const MatrixSet &pMatrices) {
+		auto sh = pRef->shader;
+		m_State.bindVertexArray(pRef->resource);
+		m_State.useProgram(sh->resource);
 
-		for(const auto &item: sh->uniforms) {
-			auto loc = glGetUniformLocation(sh->resource, item.first.c_str());
+		for(const auto &item: pRef->textures) {
+			m_State.bindTexture(item.unit, item.target, item.texture);
+		}
 
-			switch(item.second) {
-				case ShaderUniformType::Texture0: glUniform1i(loc, 0);
-					break;
-				case ShaderUniformType::Texture1: glUniform1i(loc, 1);
-					break;
-				case ShaderUniformType::Texture2: glUniform1i(loc, 2);
-					break;
-				case ShaderUniformType::Texture3: glUniform1i(loc, 3);
-					break;
-				case ShaderUniformType::Texture4: glUniform1i(loc, 4);
-					break;
-				case ShaderUniformType::Texture5: glUniform1i(loc, 5);
-					break;
-				case ShaderUniformType::Texture6: glUniform1i(loc, 6);
-					break;
-				case ShaderUniformType::Texture7: glUniform1i(loc, 7);
-					break;
-				case ShaderUniformType::Texture8: glUniform1i(loc, 8);
-					break;
-				case ShaderUniformType::Texture9: glUniform1i(loc, 9);
-					break;
-				case ShaderUniformType::Texture10: glUniform1i(loc, 10);
-					break;
-				case ShaderUniformType::Texture11: glUniform1i(loc, 11);
-					break;
-				case ShaderUniformType::Texture12: glUniform1i(loc, 12);
-					break;
-				case ShaderUniformType::Texture13: glUniform1i(loc, 13);
-					break;
-				case ShaderUniformType::Texture14: glUniform1i(loc, 14);
-					break;
-				case ShaderUniformType::Texture15: glUniform1i(loc, 15);
-					break;
-				case ShaderUniformType::Texture1D0: glUniform1i(loc, 16);
-					break;
-				case ShaderUniformType::Texture1D1: glUniform1i(loc, 17);
-					break;
-				case ShaderUniformType::Texture1D2: glUniform1i(loc, 18);
-					break;
-				case ShaderUniformType::Texture1D3: glUniform1i(loc, 19);
-					break;
-				case ShaderUniformType::Texture1D4: glUniform1i(loc, 20);
-					break;
-				case ShaderUniformType::Texture1D5: glUniform1i(loc, 21);
-					break;
-				case ShaderUniformType::Texture1D6: glUniform1i(loc, 22);
-					break;
-				case ShaderUniformType::Texture1D7: glUniform1i(loc, 23);
-					break;
-				case ShaderUniformType::Texture3D0: glUniform1i(loc, 24);
-					break;
-				case ShaderUniformType::Texture3D1: glUniform1i(loc, 25);
-					break;
-				case ShaderUniformType::Texture3D2: glUniform1i(loc, 26);
-					break;
-				case ShaderUniformType::Texture3D3: glUniform1i(loc, 27);
-					break;
-				case ShaderUniformType::Texture3D4: glUniform1i(loc, 28);
-					break;
-				case ShaderUniformType::Texture3D5: glUniform1i(loc, 29);
-					break;
-				case ShaderUniformType::Texture3D6: glUniform1i(loc, 30);
-					break;
-				case ShaderUniformType::Texture3D7: glUniform1i(loc, 31);
-					break;
-				case ShaderUniformType::MatrixObject:
-					glUniformMatrix4fv(loc, 1, false, glm::value_ptr(pMatrices.object));
-					break;
-				case ShaderUniformType::MatrixView: glUniformMatrix4fv(loc, 1, false, glm::value_ptr(pMatrices.view));
+		for(const auto &item: sh->uniforms) {
+			switch(item.type) {
+				case ShaderUniformType::MatrixView:
+					glUniformMatrix4fv(item.location, 1, false, glm::value_ptr(pMatrices.view));
 					break;
 				case ShaderUniformType::MatrixPerspective:
-					glUniformMatrix4fv(loc, 1, false, glm::value_ptr(pMatrices.perspective));
+					glUniformMatrix4fv(item.location, 1, false, glm::value_ptr(pMatrices.perspective));
 					break;
+				default: break;
 			}
 		}
+	}
 
-		GLenum eFmt;
-		switch(ref->indexBufferItemType) {
-			case IndexBufferItemType::UnsignedInt: eFmt = GL_UNSIGNED_INT;
-				break;
-			case IndexBufferItemType::UnsignedByte: eFmt = GL_UNSIGNED_BYTE;
-				break;
-			case IndexBufferItemType::UnsignedShort: eFmt = GL_UNSIGNED_SHORT;
-				break;
+	void OpenGlImplementation<3, 2>::setObjectMatrix(DrawObjectReference *pRef, const glm::mat4 &pObject) {
+		auto sh = pRef->shader;
+		for(const auto &item: sh->uniforms) {
+			if(item.type == ShaderUniformType::MatrixObject) {
+				glUniformMatrix4fv(item.location, 1, false, glm::value_ptr(pObject));
+			}
+		}
+
+		// Without instanced arrays the attribute is disabled, so the shader
+		// reads the current generic value of each column instead.
+		if(sh->instanceLocation < 0) { return; }
+		for(int i = 0; i < 4; ++i) {
+			glVertexAttrib4fv(sh->instanceLocation + i, glm::value_ptr(pObject[i]));
+		}
+	}
+
+	void OpenGlImplementation<3, 2>::drawObjectBlocks(DrawObjectReference *pRef, const glm::mat4 *pObjects,
+	                                                  uint32_t pCount) {
+		auto sh = pRef->shader;
+		auto count = static_cast<GLsizei>(pRef->vertexCount);
+		auto format = indexFormat(pRef->indexBufferItemType);
+		auto indices = reinterpret_cast<void *>(pRef->indexOffset);
+
+		uint32_t draws = 0;
+		for(uint32_t first = 0; first < pCount; first += sh->objectCapacity, ++draws) {
+			auto instances = std::min(pCount - first, sh->objectCapacity);
+			auto offset = writeUniformBlock(pObjects + first, instances * sizeof(glm::mat4), sh->objectBlockSize);
+			glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(ShaderBlockType::Objects),
+			                  m_UniformBuffer->resource, static_cast<GLintptr>(offset),
+			                  static_cast<GLsizeiptr>(sh->objectBlockSize));
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, format, indices, static_cast<GLsizei>(instances),
+			                                  pRef->baseVertex);
+		}
+		AURORA_PROFILE_COUNT(Draws, draws);
+	}
+
+	void OpenGlImplementation<3, 2>::performDraw(ObjRefBase *pDrawObject, const MatrixSet &pMatrices) {
+		AURORA_PROFILE_ZONE("performDraw");
+
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+
+		if(ref->instanced || ref->shader->objectCapacity > 0) {
+			performDrawInstanced(ref, pMatrices, &pMatrices.object, 1);
+			return;
+		}
+
+		bindDrawState(ref, pMatrices);
+		setObjectMatrix(ref, pMatrices.object);
+		glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(ref->vertexCount),
+		                         indexFormat(ref->indexBufferItemType),
+		                         reinterpret_cast<void *>(ref->indexOffset), ref->baseVertex);
+		AURORA_PROFILE_COUNT(Draws, 1);
+	}
+
+	void OpenGlImplementation<3, 2>::performDrawInstanced(ObjRefBase *pDrawObject, const MatrixSet &pMatrices,
+	                                                      const glm::mat4 *pObjects, uint32_t pCount) {
+		AURORA_PROFILE_ZONE("performDrawInstanced");
+
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+		if(pCount == 0) { return; }
+
+		auto count = static_cast<GLsizei>(ref->vertexCount);
+		auto format = indexFormat(ref->indexBufferItemType);
+		auto indices = reinterpret_cast<void *>(ref->indexOffset);
+		bindDrawState(ref, pMatrices);
+
+		if(ref->shader->objectCapacity > 0) {
+			drawObjectBlocks(ref, pObjects, pCount);
+			return;
+		}
+
+		if(!ref->instanced) {
+			for(uint32_t i = 0; i < pCount; ++i) {
+				setObjectMatrix(ref, pObjects[i]);
+				glDrawElementsBaseVertex(GL_TRIANGLES, count, format, indices, ref->baseVertex);
+			}
+			AURORA_PROFILE_COUNT(Draws, pCount);
+			return;
 		}
 
-		glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(ref->vertexCount), eFmt, nullptr);
-		glBindVertexArray(0);
+		// Respecifying the whole store lets the driver hand out fresh memory
+		// instead of waiting for the previous batch to finish reading it.
+		auto size = static_cast<GLsizeiptr>(pCount * sizeof(glm::mat4));
+		m_State.bindArrayBuffer(m_InstanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, pObjects);
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, size);
+
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, format, indices, static_cast<GLsizei>(pCount),
+		                                  ref->baseVertex);
+		AURORA_PROFILE_COUNT(Draws, 1);
+	}
+
+	void OpenGlImplementation<3, 2>::setCameraUniforms(const glm::mat4 &pView, const glm::mat4 &pPerspective,
+	                                                   float pTime) {
+		m_CameraBlock = {pView, pPerspective, pTime};
+		m_HasCameraBlock = true;
+		bindCameraBlock();
+	}
+
+	uint32_t OpenGlImplementation<3, 2>::getDrawObjectStateKey(ObjRefBase *pDrawObject) {
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+
+		return ref->stateKey;
+	}
+
+	void OpenGlImplementation<3, 2>::setDrawObjectRange(ObjRefBase *pDrawObject, size_t pIndexOffset,
+	                                                    uint32_t pIndexCount, int32_t pBaseVertex) {
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+
+		ref->indexOffset = pIndexOffset;
+		ref->vertexCount = pIndexCount;
+		ref->baseVertex = pBaseVertex;
 	}
 
 	ObjRefBase *OpenGlImplementation<3, 2>::createTexture1D() {
@@ -525,6 +797,7 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { return; }
 
+		m_State.forgetTexture(ref->resource);
 		glDeleteTextures(1, &ref->resource);
 		delete ref;
 	}
@@ -542,7 +815,7 @@ namespace aurora {
 			case TextureWrapType::BorderColor: throw std::runtime_error("cannot use this method to set border color");
 		}
 
-		glBindTexture(GL_TEXTURE_1D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture1D, ref->resource);
 		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, e);
 	}
 
@@ -550,7 +823,7 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid texture reference"); }
 
-		glBindTexture(GL_TEXTURE_1D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture1D, ref->resource);
 		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
 		float color[4] = {
 			pColor.r,
@@ -586,7 +859,7 @@ namespace aurora {
 				break;
 		}
 
-		glBindTexture(GL_TEXTURE_1D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture1D, ref->resource);
 		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, min);
 		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, mag);
 	}
@@ -595,7 +868,7 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid texture reference"); }
 
-		glBindTexture(GL_TEXTURE_1D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture1D, ref->resource);
 		glTexImage1D(GL_TEXTURE_1D,
 		             0,
 		             GL_RGBA8,
@@ -610,7 +883,7 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid texture reference"); }
 
-		glBindTexture(GL_TEXTURE_1D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture1D, ref->resource);
 		glGenerateMipmap(GL_TEXTURE_1D);
 	}
 
@@ -624,6 +897,7 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { return; }
 
+		m_State.forgetTexture(ref->resource);
 		glDeleteTextures(1, &ref->resource);
 		delete ref;
 	}
@@ -641,7 +915,7 @@ namespace aurora {
 			case TextureWrapType::BorderColor: throw std::runtime_error("cannot use this method to set border color");
 		}
 
-		glBindTexture(GL_TEXTURE_3D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture3D, ref->resource);
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, e);
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, e);
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, e);
@@ -651,7 +925,7 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid texture reference"); }
 
-		glBindTexture(GL_TEXTURE_3D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture3D, ref->resource);
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_BORDER);
@@ -689,7 +963,7 @@ namespace aurora {
 				break;
 		}
 
-		glBindTexture(GL_TEXTURE_3D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture3D, ref->resource);
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, min);
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, mag);
 	}
@@ -699,7 +973,7 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid texture reference"); }
 
-		glBindTexture(GL_TEXTURE_3D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture3D, ref->resource);
 		glTexImage3D(GL_TEXTURE_3D,
 		             0,
 		             GL_RGBA8,
@@ -716,7 +990,7 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid texture reference"); }
 
-		glBindTexture(GL_TEXTURE_3D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture3D, ref->resource);
 		glGenerateMipmap(GL_TEXTURE_3D);
 	}
 
@@ -725,7 +999,7 @@ namespace aurora {
 		auto ref = dynamic_cast<Reference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid texture reference"); }
 
-		glBindTexture(GL_TEXTURE_2D, ref->resource);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture2D, ref->resource);
 		glTexImage2D(GL_TEXTURE_2D,
 		             0,
 		             GL_RGBA8,
@@ -749,10 +1023,16 @@ namespace aurora {
 		auto ref = dynamic_cast<FramebufferReference *>(pObject);
 		if(ref == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
 
-		glBindFramebuffer(GL_FRAMEBUFFER, ref->resource);
+		m_State.bindFramebuffer(ref->resource);
 
-		if(ref->colorTexture != nullptr) { glDeleteTextures(1, &ref->colorTexture->resource); }
-		if(ref->depthTexture != nullptr) glDeleteRenderbuffers(1, &ref->depthTexture->resource);
+		if(ref->colorTexture != nullptr) {
+			m_State.forgetTexture(ref->colorTexture->resource);
+			glDeleteTextures(1, &ref->colorTexture->resource);
+		}
+		if(ref->depthTexture != nullptr) {
+			m_State.forgetTexture(ref->depthTexture->resource);
+			glDeleteTextures(1, &ref->depthTexture->resource);
+		}
 
 		delete ref->colorTexture;
 		delete ref->depthTexture;
@@ -760,7 +1040,7 @@ namespace aurora {
 		uint32_t colTex;
 		glGenTextures(1, &colTex);
 
-		glBindTexture(GL_TEXTURE_2D, colTex);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture2D, colTex);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -770,7 +1050,7 @@ namespace aurora {
 
 		uint32_t depthTexture;
 		glGenTextures(1, &depthTexture);
-		glBindTexture(GL_TEXTURE_2D, depthTexture);
+		m_State.bindTexture(OpenGlStateCache::TextureTarget::Texture2D, depthTexture);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -814,12 +1094,19 @@ namespace aurora {
 		auto ref = dynamic_cast<FramebufferReference *>(pObject);
 		if(ref == nullptr) { return; }
 
-		if(ref->colorTexture != nullptr) { glDeleteTextures(1, &ref->colorTexture->resource); }
-		if(ref->depthTexture != nullptr) { glDeleteTextures(1, &ref->depthTexture->resource); }
+		if(ref->colorTexture != nullptr) {
+			m_State.forgetTexture(ref->colorTexture->resource);
+			glDeleteTextures(1, &ref->colorTexture->resource);
+		}
+		if(ref->depthTexture != nullptr) {
+			m_State.forgetTexture(ref->depthTexture->resource);
+			glDeleteTextures(1, &ref->depthTexture->resource);
+		}
 
 		delete ref->colorTexture;
 		delete ref->depthTexture;
 
+		m_State.forgetFramebuffer(ref->resource);
 		glDeleteFramebuffers(1, &ref->resource);
 		delete ref;
 	}
@@ -842,16 +1129,16 @@ namespace aurora {
 		auto refs = dynamic_cast<FramebufferReference *>(pSource);
 		if(refs == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
 
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, refs->resource);
+		m_State.bindReadFramebuffer(refs->resource);
 
 		if(dynamic_cast<DefaultFramebufferReference *>(pTarget)) {
-			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			m_State.bindDrawFramebuffer(0);
 			glBlitFramebuffer(0, 0, refs->width, refs->height, 0, 0, refs->width, refs->height,
 			                  GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
 		} else {
 			auto reft = dynamic_cast<FramebufferReference *>(pTarget);
 			if(reft == nullptr) { throw std::runtime_error("invalid framebuffer reference"); }
-			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, reft->resource);
+			m_State.bindDrawFramebuffer(reft->resource);
 			glBlitFramebuffer(0, 0, refs->width, refs->height, 0, 0, reft->width, reft->height,
 			                  GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
 		}
@@ -864,16 +1151,16 @@ namespace aurora {
 		auto refs = dynamic_cast<FramebufferReference *>(pSource);
 		if(refs == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
 
-		glBindFramebuffer(GL_READ_FRAMEBUFFER, refs->resource);
+		m_State.bindReadFramebuffer(refs->resource);
 
 		if(dynamic_cast<DefaultFramebufferReference *>(pTarget)) {
-			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			m_State.bindDrawFramebuffer(0);
 			glBlitFramebuffer(pSourceStartX, pSourceStartY, pWidth, pHeight, pTargetStartX, pTargetStartY, pWidth, pHeight,
 			                  GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
 		} else {
 			auto reft = dynamic_cast<FramebufferReference *>(pTarget);
 			if(reft == nullptr) { throw std::runtime_error("invalid framebuffer reference"); }
-			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, reft->resource);
+			m_State.bindDrawFramebuffer(reft->resource);
 			glBlitFramebuffer(pSourceStartX, pSourceStartY, pWidth, pHeight, pTargetStartX, pTargetStartY, pWidth, pHeight,
 			                  GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
 		}
@@ -885,11 +1172,11 @@ namespace aurora {
 
 	void OpenGlImplementation<3, 2>::activateFramebuffer(ObjRefBase *pObject) {
 		if(dynamic_cast<DefaultFramebufferReference *>(pObject)) {
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			m_State.bindFramebuffer(0);
 		} else {
 			auto ref = dynamic_cast<FramebufferReference *>(pObject);
 			if(ref == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
-			glBindFramebuffer(GL_FRAMEBUFFER, ref->resource);
+			m_State.bindFramebuffer(ref->resource);
 		}
 	}
 }
@@ -1 +1,1094 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include <GL/glew.h>
+#include <sail-c++/sail-c++.h>
 #include "opengl_impl.h"
+#include "aurora/aether/profiler.h"
+#include <GLFW/glfw3.h>
+#include <boost/log/trivial.hpp>
+#include <algorithm>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace aurora {
+	namespace {
+		using TextureTarget = OpenGlStateCache::TextureTarget;
+
+		GLenum textureTarget(TextureTarget pTarget) {
+			switch(pTarget) {
+				case TextureTarget::Texture1D: return GL_TEXTURE_1D;
+				case TextureTarget::Texture3D: return GL_TEXTURE_3D;
+				default: return GL_TEXTURE_2D;
+			}
+		}
+
+		GLenum indexFormat(IndexBufferItemType pType) {
+			switch(pType) {
+				case IndexBufferItemType::UnsignedByte: return GL_UNSIGNED_BYTE;
+				case IndexBufferItemType::UnsignedShort: return GL_UNSIGNED_SHORT;
+				default: return GL_UNSIGNED_INT;
+			}
+		}
+
+		GLint wrapMode(TextureWrapType pWrap) {
+			switch(pWrap) {
+				case TextureWrapType::Repeat: return GL_REPEAT;
+				case TextureWrapType::ClampToEdge: return GL_CLAMP_TO_EDGE;
+				default: throw std::runtime_error("cannot use this method to set border color");
+			}
+		}
+
+		GLint minFilter(TextureMinFilter pMin) {
+			switch(pMin) {
+				case TextureMinFilter::Nearest: return GL_NEAREST;
+				case TextureMinFilter::Linear: return GL_LINEAR;
+				case TextureMinFilter::NearestMipmap: return GL_NEAREST_MIPMAP_NEAREST;
+				default: return GL_LINEAR_MIPMAP_LINEAR;
+			}
+		}
+
+		GLint magFilter(TextureMagFilter pMag) {
+			return pMag == TextureMagFilter::Nearest ? GL_NEAREST : GL_LINEAR;
+		}
+
+		// Enough levels for a full mipmap chain down to 1x1x1.
+		int levelCount(int pWidth, int pHeight, int pDepth) {
+			int levels = 1;
+			for(auto size = std::max({pWidth, pHeight, pDepth}); size > 1; size >>= 1) { ++levels; }
+			return levels;
+		}
+
+		std::string shaderLog(GLuint pShader) {
+			GLint length = 0;
+			glGetShaderiv(pShader, GL_INFO_LOG_LENGTH, &length);
+			std::string log(std::max(length, 1), '\0');
+			glGetShaderInfoLog(pShader, static_cast<GLsizei>(log.size()), &length, log.data());
+			log.resize(length);
+			return log;
+		}
+
+		std::string programLog(GLuint pProgram) {
+			GLint length = 0;
+			glGetProgramiv(pProgram, GL_INFO_LOG_LENGTH, &length);
+			std::string log(std::max(length, 1), '\0');
+			glGetProgramInfoLog(pProgram, static_cast<GLsizei>(log.size()), &length, log.data());
+			log.resize(length);
+			return log;
+		}
+
+		void checkFramebufferStatus(GLenum pStatus) {
+			switch(pStatus) {
+				case GL_FRAMEBUFFER_COMPLETE: return;
+				case GL_FRAMEBUFFER_UNDEFINED: throw std::runtime_error("OpenGL 4.5: framebuffer undefined");
+				case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT:
+					throw std::runtime_error("OpenGL 4.5: framebuffer incomplete attachment");
+				case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT:
+					throw std::runtime_error("OpenGL 4.5: framebuffer has no images");
+				case GL_FRAMEBUFFER_INCOMPLETE_DRAW_BUFFER:
+					throw std::runtime_error("OpenGL 4.5: framebuffer incomplete draw buffer");
+				case GL_FRAMEBUFFER_INCOMPLETE_READ_BUFFER:
+					throw std::runtime_error("OpenGL 4.5: framebuffer incomplete read buffer");
+				case GL_FRAMEBUFFER_UNSUPPORTED:
+					throw std::runtime_error("OpenGL 4.5: framebuffer configuration unsupported");
+				case GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE:
+					throw std::runtime_error("OpenGL 4.5: framebuffer incomplete multisample");
+				case GL_FRAMEBUFFER_INCOMPLETE_LAYER_TARGETS:
+					throw std::runtime_error("OpenGL 4.5: framebuffer incomplete layer targets");
+				default: throw std::runtime_error("OpenGL 4.5: framebuffer (unknown error)");
+			}
+		}
+	}
+
+	ObjRefBase *OpenGlImplementation<4, 5>::createShader(const aether::Shader &pShader) {
+		auto program = glCreateProgram();
+		std::vector<GLuint> stages;
+
+		auto discard = [&]() {
+			for(auto item: stages) { glDeleteShader(item); }
+			glDeleteProgram(program);
+		};
+
+		for(const auto &item: pShader.parts) {
+			GLenum stage;
+			switch(item.stage) {
+				case aether::Shader::Vertex: stage = GL_VERTEX_SHADER;
+					break;
+				case aether::Shader::Pixel: stage = GL_FRAGMENT_SHADER;
+					break;
+			}
+
+			auto shader = glCreateShader(stage);
+			stages.push_back(shader);
+
+			const char *strs[2] = {
+				"#version 450 core\n\n",
+				item.source.c_str()
+			};
+
+			glShaderSource(shader, 2, strs, nullptr);
+			glCompileShader(shader);
+
+			int compileStatus;
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+			auto log = shaderLog(shader);
+
+			if(!compileStatus) {
+				discard();
+				throw EShaderCompile(log);
+			} else if(!log.empty()) BOOST_LOG_TRIVIAL(warning) << log;
+
+			glAttachShader(program, shader);
+		}
+
+		glLinkProgram(program);
+
+		int linkStatus;
+		glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+		auto log = programLog(program);
+
+		if(!linkStatus) {
+			discard();
+			throw EShaderCompile(log);
+		} else if(!log.empty()) BOOST_LOG_TRIVIAL(warning) << log;
+
+		// Attached stages are only flagged, and go when the program does.
+		for(auto item: stages) { glDeleteShader(item); }
+		stages.clear();
+
+		auto ref = new ShaderReference(program);
+
+		for(const auto &item: pShader.instanceInputs) {
+			if(item.purpose != "MatrixObject") {
+				discard();
+				delete ref;
+				throw std::runtime_error("invalid shader instance input: " + item.purpose);
+			}
+			ref->instanceLocation = glGetAttribLocation(program, item.name.c_str());
+		}
+
+		for(const auto &item: pShader.uniforms) {
+			auto type = uniformTypes.at(item.purpose);
+			auto loc = glGetUniformLocation(program, item.name.c_str());
+			if(loc == -1) { continue; } // Unused, and optimised out by the linker.
+
+			switch(type) {
+				case ShaderUniformType::MatrixObject:
+				case ShaderUniformType::MatrixView:
+				case ShaderUniformType::MatrixPerspective: ref->uniforms.push_back({loc, type});
+					break;
+				default:
+					// Sampler types are declared in texture unit order, so the
+					// value of the enum is the unit the sampler reads from.
+					glProgramUniform1i(program, loc, static_cast<int>(type));
+					break;
+			}
+		}
+
+		for(const auto &item: pShader.blocks) {
+			auto type = blockTypes.at(item.purpose);
+			auto index = glGetUniformBlockIndex(program, item.name.c_str());
+			if(index == GL_INVALID_INDEX) { continue; } // Unused, as above.
+
+			GLint size;
+			glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+
+			std::string error;
+			if(type == ShaderBlockType::Camera && static_cast<size_t>(size) > sizeof(CameraBlock)) {
+				error = "Camera block " + item.name + " has members CameraBlock does not";
+			}
+			if(type == ShaderBlockType::Objects) {
+				ref->objectBlockSize = static_cast<size_t>(size);
+				ref->objectCapacity = static_cast<uint32_t>(size / sizeof(glm::mat4));
+				if(ref->instanceLocation >= 0) {
+					error = "shader reads object matrices from an instance input and a block";
+				} else if(ref->objectCapacity == 0) { error = "Objects block " + item.name + " is empty"; }
+			}
+			if(!error.empty()) {
+				discard();
+				delete ref;
+				throw EShaderCompile(error);
+			}
+
+			glUniformBlockBinding(program, index, static_cast<GLuint>(type));
+		}
+
+		return ref;
+	}
+
+	void OpenGlImplementation<4, 5>::destroyShader(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<ShaderReference *>(pObject);
+		if(ref == nullptr) { return; }
+
+		m_State.forgetProgram(ref->resource);
+		glDeleteProgram(ref->resource);
+		delete ref;
+	}
+
+	void OpenGlImplementation<4, 5>::updateViewportSize(int pWidth, int pHeight) {
+		glViewport(0, 0, pWidth, pHeight);
+	}
+
+	void OpenGlImplementation<4, 5>::setupWindowHints() {
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, true);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+	}
+
+	void OpenGlImplementation<4, 5>::setupWindowPostCreate() {
+		glewExperimental = true;
+		glewInit();
+
+		glEnable(GL_CULL_FACE);
+		glEnable(GL_DEPTH_TEST);
+
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &m_Max2DDim);
+		m_Max1DDim = m_Max2DDim;
+
+		glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &m_Max3DDim);
+
+		glCreateBuffers(1, &m_InstanceBuffer);
+
+		GLint alignment;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		m_UniformAlignment = static_cast<size_t>(std::max(alignment, 1));
+		m_UniformBuffer = static_cast<StreamBufferReference *>(createStreamBuffer(VertexBuffer, uniformRingSize));
+	}
+
+	void OpenGlImplementation<4, 5>::performFinishFrame(Window *pWindow) {
+		for(auto item: m_StreamBuffers) { fenceStreamBuffer(item); }
+		glfwSwapBuffers(pWindow->getGlfw());
+	}
+
+	void OpenGlImplementation<4, 5>::setClearColor(float pRed, float pGreen, float pBlue, float pAlpha) {
+		glClearColor(pRed, pGreen, pBlue, pAlpha);
+	}
+
+	void OpenGlImplementation<4, 5>::performClear(ClearOptions pOptions) {
+		GLenum bufs = 0;
+		if(pOptions.color) { bufs |= GL_COLOR_BUFFER_BIT; }
+		if(pOptions.depth) { bufs |= GL_DEPTH_BUFFER_BIT; }
+		if(pOptions.stencil) { bufs |= GL_STENCIL_BUFFER_BIT; }
+		glClear(bufs);
+	}
+
+	ObjRefBase *OpenGlImplementation<4, 5>::createBuffer(BufferType pType) {
+		GLuint buf;
+		glCreateBuffers(1, &buf);
+		return new BufferReference(buf, pType);
+	}
+
+	void OpenGlImplementation<4, 5>::destroyBuffer(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<BufferReference *>(pObject);
+		if(ref == nullptr) { return; }
+		if(dynamic_cast<StreamBufferReference *>(ref)) {
+			destroyStreamBuffer(ref);
+			return;
+		}
+
+		glDeleteBuffers(1, &ref->resource);
+		delete ref;
+	}
+
+	void OpenGlImplementation<4, 5>::updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize) {
+		auto ref = dynamic_cast<BufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid buffer reference"); }
+
+		if(pSize > ref->capacity) {
+			if(dynamic_cast<StreamBufferReference *>(ref)) { throw EBufferOverflow("stream buffer too small"); }
+
+			// Storage that has been given a size keeps it; growing needs a
+			// new buffer, which draw objects pick up before their next draw.
+			if(ref->capacity > 0) {
+				glDeleteBuffers(1, &ref->resource);
+				glCreateBuffers(1, &ref->resource);
+			}
+			glNamedBufferStorage(ref->resource, static_cast<GLsizeiptr>(pSize), pData, GL_DYNAMIC_STORAGE_BIT);
+			ref->capacity = pSize;
+		} else if(pSize > 0 && pData != nullptr) {
+			glNamedBufferSubData(ref->resource, 0, static_cast<GLsizeiptr>(pSize), pData);
+		}
+
+		ref->size = pSize;
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, pSize);
+	}
+
+	void
+	OpenGlImplementation<4, 5>::updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize, size_t pOffset) {
+		auto ref = dynamic_cast<BufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid buffer reference"); }
+
+		if(pOffset + pSize > ref->size) {
+			throw EBufferOverflow("buffer too small");
+		}
+
+		glNamedBufferSubData(ref->resource, static_cast<GLintptr>(pOffset), static_cast<GLsizeiptr>(pSize), pData);
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, pSize);
+	}
+
+	void
+	OpenGlImplementation<4, 5>::retrieveBufferData(ObjRefBase *pObject, void *pData, size_t pSize, size_t pOffset) {
+		auto ref = dynamic_cast<BufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid buffer reference"); }
+
+		if(pOffset + pSize > ref->size) {
+			throw EBufferUnderflow("buffer too small");
+		}
+
+		glGetNamedBufferSubData(ref->resource, static_cast<GLintptr>(pOffset), static_cast<GLsizeiptr>(pSize), pData);
+	}
+
+	ObjRefBase *OpenGlImplementation<4, 5>::createStreamBuffer(BufferType pType, size_t pSize) {
+		GLuint buf;
+		glCreateBuffers(1, &buf);
+		auto ref = new StreamBufferReference(buf, pType);
+		ref->size = ref->capacity = pSize;
+
+		// Coherent, so that a copy into the mapping is seen by every command
+		// issued after it, with no flush.
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glNamedBufferStorage(buf, static_cast<GLsizeiptr>(pSize), nullptr, flags | GL_DYNAMIC_STORAGE_BIT);
+		ref->mapping = static_cast<uint8_t *>(glMapNamedBufferRange(buf, 0, static_cast<GLsizeiptr>(pSize), flags));
+		if(ref->mapping == nullptr) {
+			glDeleteBuffers(1, &buf);
+			delete ref;
+			throw std::runtime_error("OpenGL 4.5: could not map stream buffer");
+		}
+
+		m_StreamBuffers.push_back(ref);
+		return ref;
+	}
+
+	void OpenGlImplementation<4, 5>::destroyStreamBuffer(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<StreamBufferReference *>(pObject);
+		if(ref == nullptr) { return; }
+
+		m_StreamBuffers.erase(std::find(m_StreamBuffers.begin(), m_StreamBuffers.end(), ref));
+		for(const auto &item: ref->frames) { glDeleteSync(static_cast<GLsync>(item.fence)); }
+
+		// Deleting a mapped buffer unmaps it.
+		glDeleteBuffers(1, &ref->resource);
+		delete ref;
+	}
+
+	void OpenGlImplementation<4, 5>::fenceStreamBuffer(StreamBufferReference *pRef) {
+		if(pRef->pending == 0) { return; }
+
+		pRef->frames.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), pRef->pending});
+		pRef->pending = 0;
+	}
+
+	void OpenGlImplementation<4, 5>::waitStreamBuffer(StreamBufferReference *pRef) {
+		// Only the frame being written is left, and its ranges may not have
+		// been drawn yet.
+		if(pRef->frames.empty()) { throw EBufferOverflow("stream buffer cannot hold one frame of writes"); }
+
+		auto frame = pRef->frames.front();
+		pRef->frames.pop_front();
+
+		auto fence = static_cast<GLsync>(frame.fence);
+		GLenum result;
+		do {
+			AURORA_PROFILE_ZONE("waitStreamBuffer");
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while(result == GL_TIMEOUT_EXPIRED);
+
+		glDeleteSync(fence);
+		pRef->used -= frame.bytes;
+	}
+
+	StreamBufferRange
+	OpenGlImplementation<4, 5>::mapStreamBuffer(ObjRefBase *pObject, size_t pSize, size_t pAlignment) {
+		auto ref = dynamic_cast<StreamBufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid stream buffer reference"); }
+		if(pSize > ref->capacity) { throw EBufferOverflow("stream buffer too small"); }
+
+		pAlignment = std::max<size_t>(pAlignment, 1);
+
+		size_t start, consumed;
+		for(;;) {
+			start = (ref->head + pAlignment - 1) / pAlignment * pAlignment;
+			if(start + pSize > ref->capacity) { start = 0; }
+
+			// Any bytes skipped to align or to wrap stay in use until the
+			// frame's fence, so that used stays contiguous.
+			consumed = (start >= ref->head ? start - ref->head : ref->capacity - ref->head + start) + pSize;
+			if(ref->used + consumed <= ref->capacity) { break; }
+
+			if(ref->used == 0) {
+				// Idle, but the skipped bytes alone would not fit.
+				ref->head = 0;
+				continue;
+			}
+
+			if(ref->frames.empty() && ref == m_UniformBuffer) {
+				// Of the uniform ring's ranges in this frame, only the Camera
+				// block is still to be read, and it is written again once the
+				// GPU has caught up.
+				fenceStreamBuffer(ref);
+				m_CameraBlockLost = true;
+			}
+			waitStreamBuffer(ref);
+		}
+
+		ref->head = start + pSize;
+		ref->used += consumed;
+		ref->pending += consumed;
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, pSize);
+		return {ref->mapping + start, start};
+	}
+
+	void OpenGlImplementation<4, 5>::unmapStreamBuffer(ObjRefBase *pObject) {
+		// The mapping is persistent and coherent; there is nothing to finish.
+		if(dynamic_cast<StreamBufferReference *>(pObject) == nullptr) {
+			throw EInvalidRef("invalid stream buffer reference");
+		}
+	}
+
+	size_t OpenGlImplementation<4, 5>::writeUniformBlock(const void *pData, size_t pSize, size_t pBlockSize) {
+		auto range = mapStreamBuffer(m_UniformBuffer, pBlockSize, m_UniformAlignment);
+		std::memcpy(range.data, pData, pSize);
+
+		// As in the 3.2 implementation, only what was written stays in use.
+		// Nothing was reserved after the block, so its tail can be handed
+		// back.
+		auto unused = pBlockSize - pSize;
+		m_UniformBuffer->head -= unused;
+		m_UniformBuffer->used -= unused;
+		m_UniformBuffer->pending -= unused;
+
+		if(m_CameraBlockLost) {
+			m_CameraBlockLost = false;
+			if(m_HasCameraBlock) { bindCameraBlock(); }
+		}
+		return range.offset;
+	}
+
+	void OpenGlImplementation<4, 5>::bindCameraBlock() {
+		auto offset = writeUniformBlock(&m_CameraBlock, sizeof(m_CameraBlock), sizeof(m_CameraBlock));
+		glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(ShaderBlockType::Camera), m_UniformBuffer->resource,
+		                  static_cast<GLintptr>(offset), sizeof(m_CameraBlock));
+	}
+
+	OpenGlImplementation<4, 5>::TextureReference *
+	OpenGlImplementation<4, 5>::createTexture(TextureTarget pTarget, uint32_t pInternalFormat) {
+		GLuint tex;
+		glCreateTextures(textureTarget(pTarget), 1, &tex);
+		return new TextureReference(tex, pTarget, pInternalFormat);
+	}
+
+	void OpenGlImplementation<4, 5>::destroyTexture(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<TextureReference *>(pObject);
+		if(ref == nullptr) { return; }
+
+		m_State.forgetTexture(ref->resource);
+		glDeleteTextures(1, &ref->resource);
+		delete ref;
+	}
+
+	OpenGlImplementation<4, 5>::TextureReference *
+	OpenGlImplementation<4, 5>::getTexture(ObjRefBase *pObject, TextureTarget pTarget) {
+		auto ref = dynamic_cast<TextureReference *>(pObject);
+		if(ref == nullptr || ref->target != pTarget) { throw EInvalidRef("invalid texture reference"); }
+		return ref;
+	}
+
+	void OpenGlImplementation<4, 5>::applyTextureParameters(TextureReference *pRef) {
+		auto tex = pRef->resource;
+
+		if(pRef->wrap != 0) {
+			glTextureParameteri(tex, GL_TEXTURE_WRAP_S, pRef->wrap);
+			if(pRef->target != TextureTarget::Texture1D) { glTextureParameteri(tex, GL_TEXTURE_WRAP_T, pRef->wrap); }
+			if(pRef->target == TextureTarget::Texture3D) { glTextureParameteri(tex, GL_TEXTURE_WRAP_R, pRef->wrap); }
+		}
+		if(pRef->hasBorder) { glTextureParameterfv(tex, GL_TEXTURE_BORDER_COLOR, pRef->borderColor); }
+		if(pRef->minFilter != 0) { glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, pRef->minFilter); }
+		if(pRef->magFilter != 0) { glTextureParameteri(tex, GL_TEXTURE_MAG_FILTER, pRef->magFilter); }
+	}
+
+	void OpenGlImplementation<4, 5>::allocateTexture(TextureReference *pRef, int pWidth, int pHeight, int pDepth,
+	                                                 int pLevels) {
+		if(pRef->width == pWidth && pRef->height == pHeight && pRef->depth == pDepth) { return; }
+
+		if(pRef->width != 0) {
+			m_State.forgetTexture(pRef->resource);
+			glDeleteTextures(1, &pRef->resource);
+			glCreateTextures(textureTarget(pRef->target), 1, &pRef->resource);
+			applyTextureParameters(pRef);
+		}
+
+		switch(pRef->target) {
+			case TextureTarget::Texture1D: glTextureStorage1D(pRef->resource, pLevels, pRef->internalFormat, pWidth);
+				break;
+			case TextureTarget::Texture2D:
+				glTextureStorage2D(pRef->resource, pLevels, pRef->internalFormat, pWidth, pHeight);
+				break;
+			case TextureTarget::Texture3D:
+				glTextureStorage3D(pRef->resource, pLevels, pRef->internalFormat, pWidth, pHeight, pDepth);
+				break;
+		}
+
+		pRef->width = pWidth;
+		pRef->height = pHeight;
+		pRef->depth = pDepth;
+	}
+
+	void OpenGlImplementation<4, 5>::setTextureWrap(ObjRefBase *pObject, TextureTarget pTarget, TextureWrapType pWrap) {
+		auto ref = getTexture(pObject, pTarget);
+		ref->wrap = wrapMode(pWrap);
+		applyTextureParameters(ref);
+	}
+
+	void OpenGlImplementation<4, 5>::setTextureBorder(ObjRefBase *pObject, TextureTarget pTarget, glm::vec3 pColor) {
+		auto ref = getTexture(pObject, pTarget);
+		ref->wrap = GL_CLAMP_TO_BORDER;
+		ref->hasBorder = true;
+		ref->borderColor[0] = pColor.r;
+		ref->borderColor[1] = pColor.g;
+		ref->borderColor[2] = pColor.b;
+		ref->borderColor[3] = 1;
+		applyTextureParameters(ref);
+	}
+
+	void OpenGlImplementation<4, 5>::setTextureFilter(ObjRefBase *pObject, TextureTarget pTarget, TextureMinFilter pMin,
+	                                                  TextureMagFilter pMag) {
+		auto ref = getTexture(pObject, pTarget);
+		ref->minFilter = minFilter(pMin);
+		ref->magFilter = magFilter(pMag);
+		applyTextureParameters(ref);
+	}
+
+	void OpenGlImplementation<4, 5>::updateTextureData(ObjRefBase *pObject, TextureTarget pTarget, int pWidth,
+	                                                   int pHeight, int pDepth, const void *pDataRgba) {
+		auto ref = getTexture(pObject, pTarget);
+
+		auto max = pTarget == TextureTarget::Texture3D ? m_Max3DDim
+		                                               : pTarget == TextureTarget::Texture1D ? m_Max1DDim : m_Max2DDim;
+		if(pWidth > max || pHeight > max || pDepth > max) {
+			throw ETextureSize("texture too large; no dimension can be larger than " + std::to_string(max));
+		}
+		if(pWidth <= 0 || pHeight <= 0 || pDepth <= 0) {
+			throw ETextureSize("texture dimensions must be positive");
+		}
+
+		// Every texture gets room for a full mipmap chain, as storage cannot
+		// be extended once updateTexture*Mipmap() is called.
+		allocateTexture(ref, pWidth, pHeight, pDepth, levelCount(pWidth, pHeight, pDepth));
+
+		switch(pTarget) {
+			case TextureTarget::Texture1D:
+				glTextureSubImage1D(ref->resource, 0, 0, pWidth, GL_RGBA, GL_UNSIGNED_BYTE, pDataRgba);
+				break;
+			case TextureTarget::Texture2D:
+				glTextureSubImage2D(ref->resource, 0, 0, 0, pWidth, pHeight, GL_RGBA, GL_UNSIGNED_BYTE, pDataRgba);
+				break;
+			case TextureTarget::Texture3D:
+				glTextureSubImage3D(ref->resource, 0, 0, 0, 0, pWidth, pHeight, pDepth, GL_RGBA, GL_UNSIGNED_BYTE,
+				                    pDataRgba);
+				break;
+		}
+	}
+
+	void OpenGlImplementation<4, 5>::updateTextureMipmap(ObjRefBase *pObject, TextureTarget pTarget) {
+		auto ref = getTexture(pObject, pTarget);
+		glGenerateTextureMipmap(ref->resource);
+	}
+
+	ObjRefBase *OpenGlImplementation<4, 5>::createTexture1D() {
+		return createTexture(TextureTarget::Texture1D, GL_RGBA8);
+	}
+
+	void OpenGlImplementation<4, 5>::destroyTexture1D(ObjRefBase *pObject) noexcept {
+		destroyTexture(pObject);
+	}
+
+	void OpenGlImplementation<4, 5>::setTexture1DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) {
+		setTextureWrap(pObject, TextureTarget::Texture1D, pWrap);
+	}
+
+	void OpenGlImplementation<4, 5>::setTexture1DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3 pColor) {
+		setTextureBorder(pObject, TextureTarget::Texture1D, pColor);
+	}
+
+	void
+	OpenGlImplementation<4, 5>::setTexture1DFilter(ObjRefBase *pObject, TextureMinFilter pMin, TextureMagFilter pMag) {
+		setTextureFilter(pObject, TextureTarget::Texture1D, pMin, pMag);
+	}
+
+	void OpenGlImplementation<4, 5>::updateTexture1DData(ObjRefBase *pObject, int pWidth, const uint8_t *pDataRgba) {
+		updateTextureData(pObject, TextureTarget::Texture1D, pWidth, 1, 1, pDataRgba);
+	}
+
+	void OpenGlImplementation<4, 5>::updateTexture1DMipmap(ObjRefBase *pObject) {
+		updateTextureMipmap(pObject, TextureTarget::Texture1D);
+	}
+
+	ObjRefBase *OpenGlImplementation<4, 5>::createTexture2D() {
+		return createTexture(TextureTarget::Texture2D, GL_RGBA8);
+	}
+
+	void OpenGlImplementation<4, 5>::destroyTexture2D(ObjRefBase *pObject) noexcept {
+		destroyTexture(pObject);
+	}
+
+	void OpenGlImplementation<4, 5>::setTexture2DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) {
+		setTextureWrap(pObject, TextureTarget::Texture2D, pWrap);
+	}
+
+	void OpenGlImplementation<4, 5>::setTexture2DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3 pColor) {
+		setTextureBorder(pObject, TextureTarget::Texture2D, pColor);
+	}
+
+	void
+	OpenGlImplementation<4, 5>::setTexture2DFilter(ObjRefBase *pObject, TextureMinFilter pMin, TextureMagFilter pMag) {
+		setTextureFilter(pObject, TextureTarget::Texture2D, pMin, pMag);
+	}
+
+	void OpenGlImplementation<4, 5>::updateTexture2DData(ObjRefBase *pObject, const sail::image &pImage) {
+		auto img = pImage.convert_to(SAIL_PIXEL_FORMAT_BPP32_RGBA);
+		updateTextureData(pObject, TextureTarget::Texture2D, static_cast<int>(img.width()),
+		                  static_cast<int>(img.height()), 1, img.pixels());
+	}
+
+	void OpenGlImplementation<4, 5>::updateTexture2DData(ObjRefBase *pObject, int pWidth, int pHeight,
+	                                                     const uint8_t *pDataRgba) {
+		updateTextureData(pObject, TextureTarget::Texture2D, pWidth, pHeight, 1, pDataRgba);
+	}
+
+	void OpenGlImplementation<4, 5>::updateTexture2DMipmap(ObjRefBase *pObject) {
+		updateTextureMipmap(pObject, TextureTarget::Texture2D);
+	}
+
+	ObjRefBase *OpenGlImplementation<4, 5>::createTexture3D() {
+		return createTexture(TextureTarget::Texture3D, GL_RGBA8);
+	}
+
+	void OpenGlImplementation<4, 5>::destroyTexture3D(ObjRefBase *pObject) noexcept {
+		destroyTexture(pObject);
+	}
+
+	void OpenGlImplementation<4, 5>::setTexture3DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) {
+		setTextureWrap(pObject, TextureTarget::Texture3D, pWrap);
+	}
+
+	void OpenGlImplementation<4, 5>::setTexture3DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3 pColor) {
+		setTextureBorder(pObject, TextureTarget::Texture3D, pColor);
+	}
+
+	void
+	OpenGlImplementation<4, 5>::setTexture3DFilter(ObjRefBase *pObject, TextureMinFilter pMin, TextureMagFilter pMag) {
+		setTextureFilter(pObject, TextureTarget::Texture3D, pMin, pMag);
+	}
+
+	void OpenGlImplementation<4, 5>::updateTexture3DData(ObjRefBase *pObject, int pWidth, int pHeight, int pDepth,
+	                                                     const uint8_t *pDataRgba) {
+		updateTextureData(pObject, TextureTarget::Texture3D, pWidth, pHeight, pDepth, pDataRgba);
+	}
+
+	void OpenGlImplementation<4, 5>::updateTexture3DMipmap(ObjRefBase *pObject) {
+		updateTextureMipmap(pObject, TextureTarget::Texture3D);
+	}
+
+	OpenGlImplementation<4, 5>::VertexArray *
+	OpenGlImplementation<4, 5>::acquireVertexArray(ShaderReference *pShader, BufferReference *pVertexBuffer,
+	                                               BufferReference *pIndexBuffer,
+	                                               const VertexArrangement &pArrangement) {
+		// Buffers can change name when given new storage, so the references
+		// identify them instead.
+		auto key = vertexArrayKey(reinterpret_cast<uintptr_t>(pShader), reinterpret_cast<uintptr_t>(pVertexBuffer),
+		                          reinterpret_cast<uintptr_t>(pIndexBuffer), pArrangement);
+
+		auto it = m_VertexArrays.find(key);
+		if(it != m_VertexArrays.end()) {
+			++it->second.refs;
+			return &it->second;
+		}
+
+		auto prog = pShader->resource;
+
+		GLuint vao;
+		glCreateVertexArrays(1, &vao);
+
+		int offset = 0;
+
+		for(auto &a: pArrangement) {
+			int size;
+			GLenum e;
+
+			switch(a.type) {
+				case VertexInputType::Float: size = sizeof(float);
+					e = GL_FLOAT;
+					break;
+				case VertexInputType::Int: size = sizeof(int);
+					e = GL_INT;
+					break;
+				case VertexInputType::Boolean: size = sizeof(bool);
+					// GL_BOOL is not a vertex attribute type.
+					e = GL_UNSIGNED_BYTE;
+					break;
+			}
+
+			auto attr = glGetAttribLocation(prog, a.name.c_str());
+			if(attr >= 0) {
+				glEnableVertexArrayAttrib(vao, attr);
+				glVertexArrayAttribFormat(vao, attr, a.count, e, false, offset);
+				glVertexArrayAttribBinding(vao, attr, 0);
+			}
+			offset += size * a.count;
+		}
+
+		auto &vertexArray = m_VertexArrays[key];
+		vertexArray.key = key;
+		vertexArray.resource = vao;
+		vertexArray.refs = 1;
+		vertexArray.vertexBuffer = pVertexBuffer;
+		vertexArray.indexBuffer = pIndexBuffer;
+		vertexArray.stride = offset;
+
+		glVertexArrayVertexBuffer(vao, 0, pVertexBuffer->resource, 0, vertexArray.stride);
+		glVertexArrayElementBuffer(vao, pIndexBuffer->resource);
+		vertexArray.boundVertexBuffer = pVertexBuffer->resource;
+		vertexArray.boundIndexBuffer = pIndexBuffer->resource;
+
+		// Attribute divisors are core here, so a shader with an instance input
+		// is always drawn instanced.
+		auto instanceLocation = pShader->instanceLocation;
+		if(instanceLocation >= 0) {
+			for(int i = 0; i < 4; ++i) {
+				glEnableVertexArrayAttrib(vao, instanceLocation + i);
+				glVertexArrayAttribFormat(vao, instanceLocation + i, 4, GL_FLOAT, false, i * sizeof(glm::vec4));
+				glVertexArrayAttribBinding(vao, instanceLocation + i, 1);
+			}
+			glVertexArrayVertexBuffer(vao, 1, m_InstanceBuffer, 0, sizeof(glm::mat4));
+			glVertexArrayBindingDivisor(vao, 1, 1);
+			vertexArray.instanced = true;
+		}
+
+		return &vertexArray;
+	}
+
+	void OpenGlImplementation<4, 5>::releaseVertexArray(VertexArray *pVertexArray) noexcept {
+		if(--pVertexArray->refs > 0) { return; }
+
+		m_State.forgetVertexArray(pVertexArray->resource);
+		glDeleteVertexArrays(1, &pVertexArray->resource);
+		m_VertexArrays.erase(m_VertexArrays.find(pVertexArray->key));
+	}
+
+	ObjRefBase *OpenGlImplementation<4, 5>::createDrawObject(const DrawObjectOptions &pOptions) {
+		auto vRef = dynamic_cast<BufferReference *>(pOptions.vertexBuffer);
+		auto iRef = dynamic_cast<BufferReference *>(pOptions.indexBuffer);
+		if(vRef == nullptr) { throw EInvalidRef("invalid vertex buffer reference"); }
+		if(iRef == nullptr) { throw EInvalidRef("invalid index buffer reference"); }
+
+		auto sRef = dynamic_cast<ShaderReference *>(pOptions.shader);
+		if(sRef == nullptr) { throw EInvalidRef("invalid shader reference"); }
+		auto prog = sRef->resource;
+
+		auto vertexArray = acquireVertexArray(sRef, vRef, iRef, pOptions.arrangement);
+		auto ref = new DrawObjectReference(vertexArray->resource, pOptions);
+		ref->vertexArray = vertexArray;
+		ref->instanced = vertexArray->instanced;
+
+		auto addTextures = [this, ref](ObjRefBase *const *pTextures, int pCount, int pFirstUnit, TextureTarget pTarget) {
+			for(int i = 0; i < pCount; ++i) {
+				auto item = pTextures[i];
+				if(item == nullptr) { continue; }
+
+				ref->textures.push_back({pFirstUnit + i, getTexture(item, pTarget)});
+			}
+		};
+
+		try {
+			addTextures(pOptions.textures, 16, 0, TextureTarget::Texture2D);
+			addTextures(pOptions.textures1D, 8, 16, TextureTarget::Texture1D);
+			addTextures(pOptions.textures3D, 8, 24, TextureTarget::Texture3D);
+		} catch(...) {
+			destroyDrawObject(ref);
+			throw;
+		}
+
+		uint32_t textureHash = (2166136261u ^ ref->resource) * 16777619u;
+		for(const auto &item: ref->textures) {
+			for(auto value: {static_cast<uint32_t>(item.unit), item.texture->resource}) {
+				textureHash ^= value;
+				textureHash *= 16777619u;
+			}
+		}
+		ref->stateKey = (prog & 0xfffu) << 20 | ((textureHash ^ textureHash >> 20) & 0xfffffu);
+
+		return ref;
+	}
+
+	void OpenGlImplementation<4, 5>::destroyDrawObject(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<DrawObjectReference *>(pObject);
+		if(ref == nullptr) { return; }
+
+		releaseVertexArray(ref->vertexArray);
+		delete ref;
+	}
+
+	void OpenGlImplementation<4, 5>::bindDrawState(DrawObjectReference *pRef, const MatrixSet &pMatrices) {
+		auto va = pRef->vertexArray;
+		if(va->boundVertexBuffer != va->vertexBuffer->resource) {
+			va->boundVertexBuffer = va->vertexBuffer->resource;
+			glVertexArrayVertexBuffer(va->resource, 0, va->boundVertexBuffer, 0, va->stride);
+		}
+		if(va->boundIndexBuffer != va->indexBuffer->resource) {
+			va->boundIndexBuffer = va->indexBuffer->resource;
+			glVertexArrayElementBuffer(va->resource, va->boundIndexBuffer);
+		}
+
+		auto sh = pRef->shader;
+		m_State.bindVertexArray(pRef->resource);
+		m_State.useProgram(sh->resource);
+
+		for(const auto &item: pRef->textures) {
+			m_State.bindTextureUnit(item.unit, item.texture->target, item.texture->resource);
+		}
+
+		for(const auto &item: sh->uniforms) {
+			switch(item.type) {
+				case ShaderUniformType::MatrixView:
+					glProgramUniformMatrix4fv(sh->resource, item.location, 1, false, glm::value_ptr(pMatrices.view));
+					break;
+				case ShaderUniformType::MatrixPerspective:
+					glProgramUniformMatrix4fv(sh->resource, item.location, 1, false,
+					                          glm::value_ptr(pMatrices.perspective));
+					break;
+				default: break;
+			}
+		}
+	}
+
+	void OpenGlImplementation<4, 5>::setObjectMatrix(DrawObjectReference *pRef, const glm::mat4 &pObject) {
+		auto sh = pRef->shader;
+		for(const auto &item: sh->uniforms) {
+			if(item.type == ShaderUniformType::MatrixObject) {
+				glProgramUniformMatrix4fv(sh->resource, item.location, 1, false, glm::value_ptr(pObject));
+			}
+		}
+	}
+
+	void OpenGlImplementation<4, 5>::drawObjectBlocks(DrawObjectReference *pRef, const glm::mat4 *pObjects,
+	                                                  uint32_t pCount) {
+		auto sh = pRef->shader;
+		auto count = static_cast<GLsizei>(pRef->vertexCount);
+		auto format = indexFormat(pRef->indexBufferItemType);
+		auto indices = reinterpret_cast<void *>(pRef->indexOffset);
+
+		uint32_t draws = 0;
+		for(uint32_t first = 0; first < pCount; first += sh->objectCapacity, ++draws) {
+			auto instances = std::min(pCount - first, sh->objectCapacity);
+			auto offset = writeUniformBlock(pObjects + first, instances * sizeof(glm::mat4), sh->objectBlockSize);
+			glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(ShaderBlockType::Objects),
+			                  m_UniformBuffer->resource, static_cast<GLintptr>(offset),
+			                  static_cast<GLsizeiptr>(sh->objectBlockSize));
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, format, indices, static_cast<GLsizei>(instances),
+			                                  pRef->baseVertex);
+		}
+		AURORA_PROFILE_COUNT(Draws, draws);
+	}
+
+	void OpenGlImplementation<4, 5>::performDraw(ObjRefBase *pDrawObject, const MatrixSet &pMatrices) {
+		AURORA_PROFILE_ZONE("performDraw");
+
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+
+		if(ref->instanced || ref->shader->objectCapacity > 0) {
+			performDrawInstanced(ref, pMatrices, &pMatrices.object, 1);
+			return;
+		}
+
+		bindDrawState(ref, pMatrices);
+		setObjectMatrix(ref, pMatrices.object);
+		glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(ref->vertexCount),
+		                         indexFormat(ref->indexBufferItemType),
+		                         reinterpret_cast<void *>(ref->indexOffset), ref->baseVertex);
+		AURORA_PROFILE_COUNT(Draws, 1);
+	}
+
+	void OpenGlImplementation<4, 5>::performDrawInstanced(ObjRefBase *pDrawObject, const MatrixSet &pMatrices,
+	                                                      const glm::mat4 *pObjects, uint32_t pCount) {
+		AURORA_PROFILE_ZONE("performDrawInstanced");
+
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+		if(pCount == 0) { return; }
+
+		auto count = static_cast<GLsizei>(ref->vertexCount);
+		auto format = indexFormat(ref->indexBufferItemType);
+		auto indices = reinterpret_cast<void *>(ref->indexOffset);
+		bindDrawState(ref, pMatrices);
+
+		if(ref->shader->objectCapacity > 0) {
+			drawObjectBlocks(ref, pObjects, pCount);
+			return;
+		}
+
+		if(!ref->instanced) {
+			for(uint32_t i = 0; i < pCount; ++i) {
+				setObjectMatrix(ref, pObjects[i]);
+				glDrawElementsBaseVertex(GL_TRIANGLES, count, format, indices, ref->baseVertex);
+			}
+			AURORA_PROFILE_COUNT(Draws, pCount);
+			return;
+		}
+
+		// The instance buffer is the one buffer left with mutable storage,
+		// so that respecifying it lets the driver hand out fresh memory
+		// instead of waiting for the previous batch to finish reading it.
+		auto size = static_cast<GLsizeiptr>(pCount * sizeof(glm::mat4));
+		glNamedBufferData(m_InstanceBuffer, size, pObjects, GL_STREAM_DRAW);
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, size);
+
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, format, indices, static_cast<GLsizei>(pCount),
+		                                  ref->baseVertex);
+		AURORA_PROFILE_COUNT(Draws, 1);
+	}
+
+	void OpenGlImplementation<4, 5>::setCameraUniforms(const glm::mat4 &pView, const glm::mat4 &pPerspective,
+	                                                   float pTime) {
+		m_CameraBlock = {pView, pPerspective, pTime};
+		m_HasCameraBlock = true;
+		bindCameraBlock();
+	}
+
+	uint32_t OpenGlImplementation<4, 5>::getDrawObjectStateKey(ObjRefBase *pDrawObject) {
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+
+		return ref->stateKey;
+	}
+
+	void OpenGlImplementation<4, 5>::setDrawObjectRange(ObjRefBase *pDrawObject, size_t pIndexOffset,
+	                                                    uint32_t pIndexCount, int32_t pBaseVertex) {
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+
+		ref->indexOffset = pIndexOffset;
+		ref->vertexCount = pIndexCount;
+		ref->baseVertex = pBaseVertex;
+	}
+
+	ObjRefBase *OpenGlImplementation<4, 5>::createFramebuffer(int pWidth, int pHeight) {
+		GLuint resource;
+		glCreateFramebuffers(1, &resource);
+
+		auto colorTexture = createTexture(TextureTarget::Texture2D, GL_RGB8);
+		auto depthTexture = createTexture(TextureTarget::Texture2D, GL_DEPTH_COMPONENT24);
+		for(auto item: {colorTexture, depthTexture}) {
+			item->wrap = GL_CLAMP_TO_EDGE;
+			item->minFilter = GL_NEAREST;
+			item->magFilter = GL_NEAREST;
+			applyTextureParameters(item);
+		}
+
+		auto ref = new FramebufferReference(resource, colorTexture, depthTexture);
+		try {
+			reinitializeFramebuffer(ref, pWidth, pHeight);
+		} catch(...) {
+			destroyFramebuffer(ref);
+			throw;
+		}
+		return ref;
+	}
+
+	void OpenGlImplementation<4, 5>::reinitializeFramebuffer(ObjRefBase *pObject, int pWidth, int pHeight) {
+		auto ref = dynamic_cast<FramebufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
+
+		// A minimised window reports a size of zero, which storage cannot have.
+		pWidth = std::max(pWidth, 1);
+		pHeight = std::max(pHeight, 1);
+
+		allocateTexture(ref->colorTexture, pWidth, pHeight, 1, 1);
+		allocateTexture(ref->depthTexture, pWidth, pHeight, 1, 1);
+
+		auto depth = ref->depthTexture->resource;
+		glTextureParameteri(depth, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTextureParameteri(depth, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+		glNamedFramebufferTexture(ref->resource, GL_COLOR_ATTACHMENT0, ref->colorTexture->resource, 0);
+		glNamedFramebufferTexture(ref->resource, GL_DEPTH_ATTACHMENT, depth, 0);
+		checkFramebufferStatus(glCheckNamedFramebufferStatus(ref->resource, GL_FRAMEBUFFER));
+
+		ref->width = pWidth;
+		ref->height = pHeight;
+	}
+
+	void OpenGlImplementation<4, 5>::destroyFramebuffer(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<FramebufferReference *>(pObject);
+		if(ref == nullptr) { return; }
+
+		destroyTexture(ref->colorTexture);
+		destroyTexture(ref->depthTexture);
+
+		m_State.forgetFramebuffer(ref->resource);
+		glDeleteFramebuffers(1, &ref->resource);
+		delete ref;
+	}
+
+	ObjRefBase *OpenGlImplementation<4, 5>::getFramebufferColorTexture2D(ObjRefBase *pObject) {
+		auto ref = dynamic_cast<FramebufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
+
+		return ref->colorTexture;
+	}
+
+	ObjRefBase *OpenGlImplementation<4, 5>::getFramebufferDepthTexture2D(ObjRefBase *pObject) {
+		auto ref = dynamic_cast<FramebufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
+
+		return ref->depthTexture;
+	}
+
+	uint32_t OpenGlImplementation<4, 5>::getFramebufferName(ObjRefBase *pObject) {
+		if(dynamic_cast<DefaultFramebufferReference *>(pObject)) { return 0; }
+
+		auto ref = dynamic_cast<FramebufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
+		return ref->resource;
+	}
+
+	void OpenGlImplementation<4, 5>::performBlitFramebuffer(ObjRefBase *pSource, ObjRefBase *pTarget) {
+		auto refs = dynamic_cast<FramebufferReference *>(pSource);
+		if(refs == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
+
+		int width = refs->width, height = refs->height;
+		if(auto reft = dynamic_cast<FramebufferReference *>(pTarget)) {
+			width = reft->width;
+			height = reft->height;
+		}
+
+		glBlitNamedFramebuffer(refs->resource, getFramebufferName(pTarget), 0, 0, refs->width, refs->height, 0, 0,
+		                       width, height, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT,
+		                       GL_NEAREST);
+	}
+
+	void OpenGlImplementation<4, 5>::performBlitFramebuffer(ObjRefBase *pSource, ObjRefBase *pTarget, int pSourceStartX,
+	                                                        int pSourceStartY,
+	                                                        int pTargetStartX, int pTargetStartY, int pWidth,
+	                                                        int pHeight) {
+		auto refs = dynamic_cast<FramebufferReference *>(pSource);
+		if(refs == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
+
+		glBlitNamedFramebuffer(refs->resource, getFramebufferName(pTarget), pSourceStartX, pSourceStartY,
+		                       pSourceStartX + pWidth, pSourceStartY + pHeight, pTargetStartX, pTargetStartY,
+		                       pTargetStartX + pWidth, pTargetStartY + pHeight,
+		                       GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+	}
+
+	ObjRefBase *OpenGlImplementation<4, 5>::getDefaultFramebuffer() {
+		return &m_DefaultFramebufferRef;
+	}
+
+	void OpenGlImplementation<4, 5>::activateFramebuffer(ObjRefBase *pObject) {
+		m_State.bindFramebuffer(getFramebufferName(pObject));
+	}
+}
@@ -7,9 +7,31 @@
 #define AURORA_OPENGL_IMPL_H
 
 #include "../graphics/implementation.h"
+#include "opengl_state_cache.h"
+#include <deque>
+#include <string>
+#include <unordered_map>
 
 namespace aurora {
 
+	/*
+	 * Maps the purpose a shader gives a uniform to its type. Shared by the
+	 * OpenGL implementations.
+	 */
+	extern std::unordered_map<std::string, ShaderUniformType> uniformTypes;
+
+	// Likewise for the purposes of uniform blocks.
+	extern std::unordered_map<std::string, ShaderBlockType> blockTypes;
+
+	/*
+	 * Identifies the VAO a draw object needs: draw objects reading the same
+	 * buffers with the same shader and layout share one, and differ only in
+	 * the range they draw. The ids are whatever names the implementation
+	 * gives the shader and buffers.
+	 */
+	std::string vertexArrayKey(uintptr_t pShader, uintptr_t pVertexBuffer, uintptr_t pIndexBuffer,
+	                           const VertexArrangement &pArrangement);
+
 	// Base class is abstract and cannot be used.
 	template<int major, int minor>
 	class OpenGlImplementation : public Implementation {
@@ -34,10 +56,30 @@ namespace aurora {
 		/*
 		 * Extends the Reference class to add information about the
 		 * uniforms that the shader uses.
+		 *
+		 * Locations are resolved once the program is linked. Samplers are
+		 * bound to their texture units there and then, so only the uniforms
+		 * that change per draw are kept here.
+		 *
+		 * instanceLocation is the first of the four attribute locations of
+		 * the per-instance object matrix, or -1 if the shader reads it from
+		 * a uniform.
+		 *
+		 * objectBlockSize is the size of the Objects block in bytes, and
+		 * objectCapacity the number of matrices it holds; both are 0 if the
+		 * shader has no such block.
 		 */
 		class ShaderReference : public Reference {
 		public:
-			std::unordered_map<std::string, ShaderUniformType> uniforms;
+			struct Uniform {
+				int32_t location;
+				ShaderUniformType type;
+			};
+
+			std::vector<Uniform> uniforms;
+			int32_t instanceLocation = -1;
+			size_t objectBlockSize = 0;
+			uint32_t objectCapacity = 0;
 
 			explicit ShaderReference(uint32_t pResource) : Reference(pResource) {}
 
@@ -47,29 +89,82 @@ namespace aurora {
 		/*
 		 * Extends the Reference class to add information about the
 		 * type of buffer that is being referenced, used in binding.
+		 *
+		 * size is the size of the store, kept here so that ranged updates
+		 * can be checked without asking the driver.
 		 */
 		class BufferReference : public Reference {
 		public:
 			BufferType type;
+			size_t size = 0;
 
 			BufferReference(uint32_t pResource, BufferType pType) : Reference(pResource), type(pType) {}
 
 			~BufferReference() override = default;
 		};
 
+		/*
+		 * A ring written through unsynchronised mappings. head is where the
+		 * next range starts. The store is orphaned at the end of every frame
+		 * that wrote to it, which hands it fresh memory while the GPU
+		 * finishes with the old; within a frame nothing is written twice.
+		 */
+		class StreamBufferReference : public BufferReference {
+		public:
+			size_t head = 0;
+			bool mapped = false;
+
+			StreamBufferReference(uint32_t pResource, BufferType pType) : BufferReference(pResource, pType) {}
+
+			~StreamBufferReference() override = default;
+		};
+
+		/*
+		 * A VAO and the number of draw objects using it. Meshes packed into
+		 * one MeshHeap block all read the same buffers, so their draw objects
+		 * share a VAO and drawing one after another does not switch it.
+		 *
+		 * When instanced is set, the instance matrix attributes of the VAO
+		 * read from the implementation's instance buffer.
+		 */
+		struct VertexArray {
+			std::string key;
+			uint32_t resource;
+			int refs = 0;
+			bool instanced = false;
+		};
+
 		/*
 		 * Extends the Reference class to include information about the
 		 * shader to bind, the number of vertices, and the type contained
 		 * in the index buffer part of a draw object.
 		 *
-		 * The Reference refers to a VAO object, and none of the objects
-		 * contained within are discarded when the object is destroyed.
+		 * The Reference refers to the name of its shared VAO, and none of
+		 * the objects contained within are discarded when the object is
+		 * destroyed; the VAO is deleted with the last draw object using it.
+		 * Texture bindings are not VAO state, so they are kept alongside
+		 * and bound when the object is drawn.
+		 *
+		 * The state key puts the program name in the upper 12 bits and a
+		 * hash of the VAO and texture bindings in the lower 20.
 		 */
 		class DrawObjectReference : public Reference {
 		public:
+			struct TextureBinding {
+				int unit;
+				OpenGlStateCache::TextureTarget target;
+				uint32_t texture;
+			};
+
+			VertexArray *vertexArray = nullptr;
 			ShaderReference *shader;
 			uint32_t vertexCount;
 			IndexBufferItemType indexBufferItemType;
+			std::vector<TextureBinding> textures;
+			uint32_t stateKey = 0;
+			bool instanced = false;
+			size_t indexOffset = 0;
+			int32_t baseVertex = 0;
 
 			DrawObjectReference(uint32_t pResource, const DrawObjectOptions &pOptions)
 				: Reference(pResource),
@@ -117,6 +212,40 @@ namespace aurora {
 
 		int m_Max1DDim, m_Max2DDim, m_Max3DDim;
 
+		bool m_HasInstancedArrays = false;
+		uint32_t m_InstanceBuffer = 0;
+		std::vector<StreamBufferReference *> m_StreamBuffers;
+
+		// Keyed by vertexArrayKey() of the program and buffer names.
+		std::unordered_map<std::string, VertexArray> m_VertexArrays;
+
+		/*
+		 * The Camera and Objects blocks are written to this ring, and bound
+		 * from it by range.
+		 *
+		 * Unlike other stream buffers, the ring is orphaned when one frame
+		 * fills it. Each Objects block is only read by the draw issued right
+		 * after it is bound, but the Camera block stays bound for the whole
+		 * pass, so it is written again and rebound into the new store.
+		 */
+		static constexpr size_t uniformRingSize = 4 * 1024 * 1024;
+		StreamBufferReference *m_UniformBuffer = nullptr;
+		size_t m_UniformAlignment = 1;
+		CameraBlock m_CameraBlock{};
+		bool m_HasCameraBlock = false;
+		bool m_CameraBlockLost = false;
+
+		OpenGlStateCache m_State;
+
+		size_t writeUniformBlock(const void *pData, size_t pSize, size_t pBlockSize);
+		void bindCameraBlock();
+		VertexArray *acquireVertexArray(ShaderReference *pShader, Reference *pVertexBuffer, Reference *pIndexBuffer,
+		                                const VertexArrangement &pArrangement);
+		void releaseVertexArray(VertexArray *pVertexArray) noexcept;
+		void bindDrawState(DrawObjectReference *pRef, const MatrixSet &pMatrices);
+		void setObjectMatrix(DrawObjectReference *pRef, const glm::mat4 &pObject);
+		void drawObjectBlocks(DrawObjectReference *pRef, const glm::mat4 *pObjects, uint32_t pCount);
+
 		DefaultFramebufferReference m_DefaultFramebufferRef{0};
 
 	public:
@@ -134,9 +263,13 @@ namespace aurora {
 		void performClear(ClearOptions pOptions) override;
 		ObjRefBase *createBuffer(BufferType pType) override;
 		void destroyBuffer(ObjRefBase *pObject) noexcept override;
-		void updateBufferData(ObjRefBase *pObject, void *pData, size_t pSize) override;
-		void updateBufferData(ObjRefBase *pObject, void *pData, size_t pSize, size_t pOffset) override;
+		void updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize) override;
+		void updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize, size_t pOffset) override;
 		void retrieveBufferData(ObjRefBase *pObject, void *pData, size_t pSize, size_t pOffset) override;
+		ObjRefBase *createStreamBuffer(BufferType pType, size_t pSize) override;
+		void destroyStreamBuffer(ObjRefBase *pObject) noexcept override;
+		StreamBufferRange mapStreamBuffer(ObjRefBase *pObject, size_t pSize, size_t pAlignment) override;
+		void unmapStreamBuffer(ObjRefBase *pObject) override;
 		ObjRefBase *createTexture2D() override;
 		void destroyTexture2D(ObjRefBase *pObject) noexcept override;
 		void setTexture2DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) override;
@@ -147,6 +280,12 @@ namespace aurora {
 		ObjRefBase *createDrawObject(const DrawObjectOptions &pOptions) override;
 		void destroyDrawObject(ObjRefBase *pObject) noexcept override;
 		void performDraw(ObjRefBase *pDrawObject, const MatrixSet &pMatrices) override;
+		void setCameraUniforms(const glm::mat4 &pView, const glm::mat4 &pPerspective, float pTime) override;
+		void performDrawInstanced(ObjRefBase *pDrawObject, const MatrixSet &pMatrices, const glm::mat4 *pObjects,
+		                          uint32_t pCount) override;
+		uint32_t getDrawObjectStateKey(ObjRefBase *pDrawObject) override;
+		void setDrawObjectRange(ObjRefBase *pDrawObject, size_t pIndexOffset, uint32_t pIndexCount,
+		                        int32_t pBaseVertex) override;
 		ObjRefBase *createTexture1D() override;
 		void destroyTexture1D(ObjRefBase *pObject) noexcept override;
 		void setTexture1DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) override;
@@ -175,9 +314,309 @@ namespace aurora {
 		void activateFramebuffer(ObjRefBase *pObject) override;
 	};
 
+	/*
+	 * Built on direct state access: resources are created with their
+	 * target, given immutable storage, and edited by name, so nothing has to
+	 * be bound to change it. Binding is left for drawing.
+	 *
+	 * Immutable storage cannot be resized. Buffers and textures whose size
+	 * changes get a new name, so draw objects and framebuffers keep a pointer
+	 * to the reference and pick up the current name when they use it. A draw
+	 * object must therefore be destroyed before the buffers and textures it
+	 * was created with.
+	 */
 	template<>
 	class OpenGlImplementation<4, 5> : public Implementation {
+		/*
+		 * Contains an ambiguous reference to a resource created by
+		 * OpenGL.
+		 */
+		class Reference : public ObjRefBase {
+		public:
+			uint32_t resource;
+
+			explicit Reference(uint32_t pResource) : resource(pResource) {}
+
+			~Reference() override = default;
+		};
+
+		/*
+		 * As in the 3.2 implementation, except that samplers and uniforms
+		 * are set with glProgramUniform*, so the program is never bound to
+		 * set them.
+		 */
+		class ShaderReference : public Reference {
+		public:
+			struct Uniform {
+				int32_t location;
+				ShaderUniformType type;
+			};
+
+			std::vector<Uniform> uniforms;
+			int32_t instanceLocation = -1;
+			size_t objectBlockSize = 0;
+			uint32_t objectCapacity = 0;
+
+			explicit ShaderReference(uint32_t pResource) : Reference(pResource) {}
+
+			~ShaderReference() override = default;
+		};
+
+		/*
+		 * capacity is the size of the immutable storage, and size is how
+		 * much of it the last full update filled. Storage is only replaced
+		 * when an update no longer fits.
+		 */
+		class BufferReference : public Reference {
+		public:
+			BufferType type;
+			size_t size = 0;
+			size_t capacity = 0;
+
+			BufferReference(uint32_t pResource, BufferType pType) : Reference(pResource), type(pType) {}
+
+			~BufferReference() override = default;
+		};
+
+		/*
+		 * A ring in storage that stays mapped for the life of the buffer,
+		 * so a write is a plain copy.
+		 *
+		 * used counts the bytes from the oldest range the GPU might still
+		 * read up to head, including any skipped when the ring wrapped.
+		 * The bytes written in one frame are covered by a fence when it
+		 * ends; a range is only reused once the fence of the frame that
+		 * wrote it has signalled.
+		 */
+		class StreamBufferReference : public BufferReference {
+		public:
+			struct Frame {
+				void *fence; // GLsync
+				size_t bytes;
+			};
+
+			uint8_t *mapping = nullptr;
+			size_t head = 0;
+			size_t used = 0;
+			size_t pending = 0;
+			std::deque<Frame> frames;
 
+			StreamBufferReference(uint32_t pResource, BufferType pType) : BufferReference(pResource, pType) {}
+
+			~StreamBufferReference() override = default;
+		};
+
+		/*
+		 * Keeps what is needed to give the texture new storage: the size of
+		 * the current storage, zero until the first upload, and the
+		 * parameters set on it, which do not carry over to a new name. A
+		 * parameter that is zero was never set and keeps the OpenGL default.
+		 */
+		class TextureReference : public Reference {
+		public:
+			OpenGlStateCache::TextureTarget target;
+			uint32_t internalFormat;
+			int width = 0, height = 0, depth = 0;
+			int32_t wrap = 0, minFilter = 0, magFilter = 0;
+			bool hasBorder = false;
+			float borderColor[4]{};
+
+			TextureReference(uint32_t pResource, OpenGlStateCache::TextureTarget pTarget, uint32_t pInternalFormat)
+				: Reference(pResource), target(pTarget), internalFormat(pInternalFormat) {}
+
+			~TextureReference() override = default;
+		};
+
+		/*
+		 * A VAO shared as in the 3.2 implementation. The vertex buffer is on
+		 * binding 0 and the instance buffer, when instanced is set, on
+		 * binding 1.
+		 *
+		 * boundVertexBuffer and boundIndexBuffer are the names the VAO
+		 * currently reads from; when a buffer has been given new storage
+		 * they differ from its resource, and the VAO is pointed at the new
+		 * name before the next draw.
+		 */
+		struct VertexArray {
+			std::string key;
+			uint32_t resource;
+			int refs = 0;
+			BufferReference *vertexBuffer, *indexBuffer;
+			uint32_t boundVertexBuffer = 0, boundIndexBuffer = 0;
+			int32_t stride = 0;
+			bool instanced = false;
+		};
+
+		/*
+		 * Refers to the name of its shared VAO. The state key is built as in
+		 * the 3.2 implementation.
+		 */
+		class DrawObjectReference : public Reference {
+		public:
+			struct TextureBinding {
+				int unit;
+				TextureReference *texture;
+			};
+
+			VertexArray *vertexArray = nullptr;
+			ShaderReference *shader;
+			uint32_t vertexCount;
+			IndexBufferItemType indexBufferItemType;
+			std::vector<TextureBinding> textures;
+			uint32_t stateKey = 0;
+			bool instanced = false;
+			size_t indexOffset = 0;
+			int32_t baseVertex = 0;
+
+			DrawObjectReference(uint32_t pResource, const DrawObjectOptions &pOptions)
+				: Reference(pResource),
+				  shader(dynamic_cast<ShaderReference *>(pOptions.shader)),
+				  vertexCount(pOptions.vertexCount),
+				  indexBufferItemType(pOptions.indexBufferItemType) {}
+
+			~DrawObjectReference() override = default;
+		};
+
+		/*
+		 * The colorTexture and depthTexture stay the same objects for the
+		 * life of the framebuffer; resizing only gives them new storage.
+		 * Both are discarded when the framebuffer is destroyed.
+		 */
+		class FramebufferReference : public Reference {
+		public:
+			TextureReference *colorTexture;
+			TextureReference *depthTexture;
+
+			int width = 0, height = 0;
+
+			FramebufferReference(uint32_t pResource, TextureReference *pColorTexture,
+			                     TextureReference *pDepthTexture)
+				: Reference(pResource), colorTexture(pColorTexture), depthTexture(pDepthTexture) {}
+
+			~FramebufferReference() override = default;
+		};
+
+		class DefaultFramebufferReference : public Reference {
+		public:
+			explicit DefaultFramebufferReference(uint32_t pResource) : Reference(pResource) {}
+
+			~DefaultFramebufferReference() override = default;
+		};
+
+		int m_Max1DDim, m_Max2DDim, m_Max3DDim;
+
+		uint32_t m_InstanceBuffer = 0;
+		std::vector<StreamBufferReference *> m_StreamBuffers;
+
+		// Keyed by vertexArrayKey() of the shader and buffer references.
+		std::unordered_map<std::string, VertexArray> m_VertexArrays;
+
+		/*
+		 * As in the 3.2 implementation, except that when one frame fills the
+		 * ring, it waits for the GPU to finish that frame so far instead of
+		 * orphaning.
+		 */
+		static constexpr size_t uniformRingSize = 4 * 1024 * 1024;
+		StreamBufferReference *m_UniformBuffer = nullptr;
+		size_t m_UniformAlignment = 1;
+		CameraBlock m_CameraBlock{};
+		bool m_HasCameraBlock = false;
+		bool m_CameraBlockLost = false;
+
+		OpenGlStateCache m_State;
+
+		void fenceStreamBuffer(StreamBufferReference *pRef);
+		void waitStreamBuffer(StreamBufferReference *pRef);
+		size_t writeUniformBlock(const void *pData, size_t pSize, size_t pBlockSize);
+		void bindCameraBlock();
+		VertexArray *acquireVertexArray(ShaderReference *pShader, BufferReference *pVertexBuffer,
+		                                BufferReference *pIndexBuffer, const VertexArrangement &pArrangement);
+		void releaseVertexArray(VertexArray *pVertexArray) noexcept;
+
+		TextureReference *createTexture(OpenGlStateCache::TextureTarget pTarget, uint32_t pInternalFormat);
+		void destroyTexture(ObjRefBase *pObject) noexcept;
+		TextureReference *getTexture(ObjRefBase *pObject, OpenGlStateCache::TextureTarget pTarget);
+		void applyTextureParameters(TextureReference *pRef);
+		void allocateTexture(TextureReference *pRef, int pWidth, int pHeight, int pDepth, int pLevels);
+		void setTextureWrap(ObjRefBase *pObject, OpenGlStateCache::TextureTarget pTarget, TextureWrapType pWrap);
+		void setTextureBorder(ObjRefBase *pObject, OpenGlStateCache::TextureTarget pTarget, glm::vec3 pColor);
+		void setTextureFilter(ObjRefBase *pObject, OpenGlStateCache::TextureTarget pTarget, TextureMinFilter pMin,
+		                      TextureMagFilter pMag);
+		void updateTextureData(ObjRefBase *pObject, OpenGlStateCache::TextureTarget pTarget, int pWidth, int pHeight,
+		                       int pDepth, const void *pDataRgba);
+		void updateTextureMipmap(ObjRefBase *pObject, OpenGlStateCache::TextureTarget pTarget);
+
+		void bindDrawState(DrawObjectReference *pRef, const MatrixSet &pMatrices);
+		void setObjectMatrix(DrawObjectReference *pRef, const glm::mat4 &pObject);
+		void drawObjectBlocks(DrawObjectReference *pRef, const glm::mat4 *pObjects, uint32_t pCount);
+		uint32_t getFramebufferName(ObjRefBase *pObject);
+
+		DefaultFramebufferReference m_DefaultFramebufferRef{0};
+
+	public:
+		~OpenGlImplementation() override = default;
+
+		// See base class for documentation.
+
+		ObjRefBase *createShader(const aether::Shader &pShader) override;
+		void destroyShader(ObjRefBase *pObject) noexcept override;
+		void setupWindowHints() override;
+		void setupWindowPostCreate() override;
+		void updateViewportSize(int pWidth, int pHeight) override;
+		void performFinishFrame(Window *pWindow) override;
+		void setClearColor(float pRed, float pGreen, float pBlue, float pAlpha) override;
+		void performClear(ClearOptions pOptions) override;
+		ObjRefBase *createBuffer(BufferType pType) override;
+		void destroyBuffer(ObjRefBase *pObject) noexcept override;
+		void updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize) override;
+		void updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize, size_t pOffset) override;
+		void retrieveBufferData(ObjRefBase *pObject, void *pData, size_t pSize, size_t pOffset) override;
+		ObjRefBase *createStreamBuffer(BufferType pType, size_t pSize) override;
+		void destroyStreamBuffer(ObjRefBase *pObject) noexcept override;
+		StreamBufferRange mapStreamBuffer(ObjRefBase *pObject, size_t pSize, size_t pAlignment) override;
+		void unmapStreamBuffer(ObjRefBase *pObject) override;
+		ObjRefBase *createTexture2D() override;
+		void destroyTexture2D(ObjRefBase *pObject) noexcept override;
+		void setTexture2DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) override;
+		void setTexture2DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3 pColor) override;
+		void setTexture2DFilter(ObjRefBase *pObject, TextureMinFilter pMin, TextureMagFilter pMag) override;
+		void updateTexture2DData(ObjRefBase *pObject, const sail::image &pImage) override;
+		void updateTexture2DMipmap(ObjRefBase *pObject) override;
+		ObjRefBase *createDrawObject(const DrawObjectOptions &pOptions) override;
+		void destroyDrawObject(ObjRefBase *pObject) noexcept override;
+		void performDraw(ObjRefBase *pDrawObject, const MatrixSet &pMatrices) override;
+		void setCameraUniforms(const glm::mat4 &pView, const glm::mat4 &pPerspective, float pTime) override;
+		void performDrawInstanced(ObjRefBase *pDrawObject, const MatrixSet &pMatrices, const glm::mat4 *pObjects,
+		                          uint32_t pCount) override;
+		uint32_t getDrawObjectStateKey(ObjRefBase *pDrawObject) override;
+		void setDrawObjectRange(ObjRefBase *pDrawObject, size_t pIndexOffset, uint32_t pIndexCount,
+		                        int32_t pBaseVertex) override;
+		ObjRefBase *createTexture1D() override;
+		void destroyTexture1D(ObjRefBase *pObject) noexcept override;
+		void setTexture1DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) override;
+		void setTexture1DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3 pColor) override;
+		void setTexture1DFilter(ObjRefBase *pObject, TextureMinFilter pMin, TextureMagFilter pMag) override;
+		void updateTexture1DData(ObjRefBase *pObject, int pWidth, const uint8_t *pDataRgba) override;
+		void updateTexture1DMipmap(ObjRefBase *pObject) override;
+		ObjRefBase *createTexture3D() override;
+		void destroyTexture3D(ObjRefBase *pObject) noexcept override;
+		void setTexture3DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) override;
+		void setTexture3DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3 pColor) override;
+		void setTexture3DFilter(ObjRefBase *pObject, TextureMinFilter pMin, TextureMagFilter pMag) override;
+		void updateTexture3DData(ObjRefBase *pObject, int pWidth, int pHeight, int pDepth,
+		                         const uint8_t *pDataRgba) override;
+		void updateTexture3DMipmap(ObjRefBase *pObject) override;
+		void updateTexture2DData(ObjRefBase *pObject, int pWidth, int pHeight, const uint8_t *pDataRgba) override;
+		ObjRefBase *createFramebuffer(int pWidth, int pHeight) override;
+		void reinitializeFramebuffer(ObjRefBase *pObject, int pWidth, int pHeight) override;
+		void destroyFramebuffer(ObjRefBase *pObject) noexcept override;
+		ObjRefBase *getFramebufferColorTexture2D(ObjRefBase *pObject) override;
+		ObjRefBase *getFramebufferDepthTexture2D(ObjRefBase *pObject) override;
+		void performBlitFramebuffer(ObjRefBase *pSource, ObjRefBase *pTarget) override;
+		void performBlitFramebuffer(ObjRefBase *pSource, ObjRefBase *pTarget, int pSourceStartX, int pSourceStartY,
+		                            int pTargetStartX, int pTargetStartY, int pWidth, int pHeight) override;
+		ObjRefBase *getDefaultFramebuffer() override;
+		void activateFramebuffer(ObjRefBase *pObject) override;
 	};
 
 }// namespace aurora
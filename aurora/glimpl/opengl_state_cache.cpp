@@ -0,0 +1,151 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include <GL/glew.h>
+#include "opengl_state_cache.h"
+#include "aurora/aether/profiler.h"
+#include <stdexcept>
+#include <string>
+
+namespace aurora {
+	namespace {
+		constexpr GLenum textureTargets[3]{GL_TEXTURE_1D, GL_TEXTURE_2D, GL_TEXTURE_3D};
+		constexpr GLenum textureBindings[3]{GL_TEXTURE_BINDING_1D, GL_TEXTURE_BINDING_2D, GL_TEXTURE_BINDING_3D};
+
+#ifdef AURORA_GL_VALIDATE_STATE
+		void validate(GLenum pBinding, uint32_t pExpected, const char *pName) {
+			GLint actual;
+			glGetIntegerv(pBinding, &actual);
+			if(static_cast<uint32_t>(actual) != pExpected) {
+				throw std::runtime_error(std::string("OpenGL state cache is out of sync: ") + pName + " is " +
+				                         std::to_string(actual) + ", expected " + std::to_string(pExpected));
+			}
+		}
+#else
+		inline void validate(GLenum, uint32_t, const char *) {}
+#endif
+	}
+
+	void OpenGlStateCache::activateUnit(int pUnit) {
+		validate(GL_ACTIVE_TEXTURE, GL_TEXTURE0 + m_ActiveUnit, "active texture unit");
+		if(m_ActiveUnit == pUnit) { return; }
+
+		glActiveTexture(GL_TEXTURE0 + pUnit);
+		AURORA_PROFILE_COUNT(StateChanges, 1);
+		m_ActiveUnit = pUnit;
+	}
+
+	void OpenGlStateCache::useProgram(uint32_t pProgram) {
+		validate(GL_CURRENT_PROGRAM, m_Program, "program");
+		if(m_Program == pProgram) { return; }
+
+		glUseProgram(pProgram);
+		AURORA_PROFILE_COUNT(StateChanges, 1);
+		m_Program = pProgram;
+	}
+
+	void OpenGlStateCache::bindVertexArray(uint32_t pVertexArray) {
+		validate(GL_VERTEX_ARRAY_BINDING, m_VertexArray, "vertex array");
+		if(m_VertexArray == pVertexArray) { return; }
+
+		glBindVertexArray(pVertexArray);
+		AURORA_PROFILE_COUNT(StateChanges, 1);
+		m_VertexArray = pVertexArray;
+	}
+
+	void OpenGlStateCache::bindArrayBuffer(uint32_t pBuffer) {
+		validate(GL_ARRAY_BUFFER_BINDING, m_ArrayBuffer, "array buffer");
+		if(m_ArrayBuffer == pBuffer) { return; }
+
+		glBindBuffer(GL_ARRAY_BUFFER, pBuffer);
+		AURORA_PROFILE_COUNT(StateChanges, 1);
+		m_ArrayBuffer = pBuffer;
+	}
+
+	void OpenGlStateCache::bindTexture(int pUnit, TextureTarget pTarget, uint32_t pTexture) {
+		activateUnit(pUnit);
+		bindTexture(pTarget, pTexture);
+	}
+
+	void OpenGlStateCache::bindTexture(TextureTarget pTarget, uint32_t pTexture) {
+		auto target = static_cast<int>(pTarget);
+		auto &bound = m_Textures[m_ActiveUnit][target];
+
+		validate(textureBindings[target], bound, "texture");
+		if(bound == pTexture) { return; }
+
+		glBindTexture(textureTargets[target], pTexture);
+		AURORA_PROFILE_COUNT(StateChanges, 1);
+		bound = pTexture;
+	}
+
+	void OpenGlStateCache::bindTextureUnit(int pUnit, TextureTarget pTarget, uint32_t pTexture) {
+		auto target = static_cast<int>(pTarget);
+		auto &bound = m_Textures[pUnit][target];
+
+		// Only the active unit's bindings can be queried.
+		if(pUnit == m_ActiveUnit) { validate(textureBindings[target], bound, "texture"); }
+		if(bound == pTexture) { return; }
+
+		glBindTextureUnit(pUnit, pTexture);
+		AURORA_PROFILE_COUNT(StateChanges, 1);
+		bound = pTexture;
+	}
+
+	void OpenGlStateCache::bindFramebuffer(uint32_t pFramebuffer) {
+		validate(GL_READ_FRAMEBUFFER_BINDING, m_ReadFramebuffer, "read framebuffer");
+		validate(GL_DRAW_FRAMEBUFFER_BINDING, m_DrawFramebuffer, "draw framebuffer");
+		if(m_ReadFramebuffer == pFramebuffer && m_DrawFramebuffer == pFramebuffer) { return; }
+
+		glBindFramebuffer(GL_FRAMEBUFFER, pFramebuffer);
+		AURORA_PROFILE_COUNT(StateChanges, 1);
+		m_ReadFramebuffer = m_DrawFramebuffer = pFramebuffer;
+	}
+
+	void OpenGlStateCache::bindReadFramebuffer(uint32_t pFramebuffer) {
+		validate(GL_READ_FRAMEBUFFER_BINDING, m_ReadFramebuffer, "read framebuffer");
+		if(m_ReadFramebuffer == pFramebuffer) { return; }
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, pFramebuffer);
+		AURORA_PROFILE_COUNT(StateChanges, 1);
+		m_ReadFramebuffer = pFramebuffer;
+	}
+
+	void OpenGlStateCache::bindDrawFramebuffer(uint32_t pFramebuffer) {
+		validate(GL_DRAW_FRAMEBUFFER_BINDING, m_DrawFramebuffer, "draw framebuffer");
+		if(m_DrawFramebuffer == pFramebuffer) { return; }
+
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, pFramebuffer);
+		AURORA_PROFILE_COUNT(StateChanges, 1);
+		m_DrawFramebuffer = pFramebuffer;
+	}
+
+	void OpenGlStateCache::forgetProgram(uint32_t pProgram) {
+		// A deleted program stays in use until another replaces it, which
+		// would keep it alive; unbind it so that it is freed right away.
+		if(m_Program == pProgram) { useProgram(0); }
+	}
+
+	void OpenGlStateCache::forgetVertexArray(uint32_t pVertexArray) {
+		if(m_VertexArray == pVertexArray) { m_VertexArray = 0; }
+	}
+
+	void OpenGlStateCache::forgetBuffer(uint32_t pBuffer) {
+		if(m_ArrayBuffer == pBuffer) { m_ArrayBuffer = 0; }
+	}
+
+	void OpenGlStateCache::forgetTexture(uint32_t pTexture) {
+		for(auto &unit: m_Textures) {
+			for(auto &bound: unit) {
+				if(bound == pTexture) { bound = 0; }
+			}
+		}
+	}
+
+	void OpenGlStateCache::forgetFramebuffer(uint32_t pFramebuffer) {
+		if(m_ReadFramebuffer == pFramebuffer) { m_ReadFramebuffer = 0; }
+		if(m_DrawFramebuffer == pFramebuffer) { m_DrawFramebuffer = 0; }
+	}
+}// namespace aurora
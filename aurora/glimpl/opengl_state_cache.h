@@ -0,0 +1,80 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_OPENGL_STATE_CACHE_H
+#define AURORA_OPENGL_STATE_CACHE_H
+
+#include <array>
+#include <cstdint>
+
+namespace aurora {
+	/*
+	 * Shadows the OpenGL bindings that the backends change, so that binding
+	 * what is already bound never reaches the driver. Every bind in a backend
+	 * has to go through here, or the shadow goes stale.
+	 *
+	 * Building with AURORA_GL_VALIDATE_STATE checks the shadow against the
+	 * real context on every call, and throws when they disagree.
+	 */
+	class OpenGlStateCache {
+	public:
+		enum class TextureTarget {
+			Texture1D,
+			Texture2D,
+			Texture3D,
+		};
+
+		static constexpr int textureUnitCount = 32;
+
+	private:
+		uint32_t m_Program = 0;
+		uint32_t m_VertexArray = 0;
+		uint32_t m_ArrayBuffer = 0;
+		uint32_t m_ReadFramebuffer = 0;
+		uint32_t m_DrawFramebuffer = 0;
+		int m_ActiveUnit = 0;
+		std::array<std::array<uint32_t, 3>, textureUnitCount> m_Textures{};
+
+		void activateUnit(int pUnit);
+
+	public:
+		void useProgram(uint32_t pProgram);
+		void bindVertexArray(uint32_t pVertexArray);
+		void bindArrayBuffer(uint32_t pBuffer);
+
+		/*
+		 * Binds a texture to a unit for sampling.
+		 */
+		void bindTexture(int pUnit, TextureTarget pTarget, uint32_t pTexture);
+
+		/*
+		 * Binds a texture to edit it, on whichever unit happens to be active.
+		 */
+		void bindTexture(TextureTarget pTarget, uint32_t pTexture);
+
+		/*
+		 * Binds a texture to a unit with glBindTextureUnit, leaving the active
+		 * unit alone. Needs OpenGL 4.5.
+		 */
+		void bindTextureUnit(int pUnit, TextureTarget pTarget, uint32_t pTexture);
+
+		/*
+		 * Binds a framebuffer for both reading and drawing.
+		 */
+		void bindFramebuffer(uint32_t pFramebuffer);
+		void bindReadFramebuffer(uint32_t pFramebuffer);
+		void bindDrawFramebuffer(uint32_t pFramebuffer);
+
+		// Deleting an object unbinds it; these keep the shadow in step.
+
+		void forgetProgram(uint32_t pProgram);
+		void forgetVertexArray(uint32_t pVertexArray);
+		void forgetBuffer(uint32_t pBuffer);
+		void forgetTexture(uint32_t pTexture);
+		void forgetFramebuffer(uint32_t pFramebuffer);
+	};
+}// namespace aurora
+
+#endif// AURORA_OPENGL_STATE_CACHE_H
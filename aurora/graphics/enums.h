@@ -36,6 +36,7 @@ namespace aurora {
 		Boolean,
 	};
 
+	// The texture types are in texture unit order; backends rely on it.
 	enum class ShaderUniformType {
 		Texture0,
 		Texture1,
@@ -75,6 +76,12 @@ namespace aurora {
 		MatrixPerspective,
 	};
 
+	// The value of each block type is the binding point backends give it.
+	enum class ShaderBlockType {
+		Camera,
+		Objects,
+	};
+
 	enum class IndexBufferItemType {
 		UnsignedInt,
 		UnsignedShort,
@@ -0,0 +1,82 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "frustum.h"
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define AURORA_FRUSTUM_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace aurora {
+	Frustum Frustum::fromMatrix(const glm::mat4 &pViewProjection) {
+		// glm is column-major, so row i of the matrix is m[0][i]..m[3][i].
+		const auto &m = pViewProjection;
+		auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+		auto r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+		Frustum f{};
+		f.planes[0] = r3 + r0; // left
+		f.planes[1] = r3 - r0; // right
+		f.planes[2] = r3 + r1; // bottom
+		f.planes[3] = r3 - r1; // top
+		f.planes[4] = r3 + r2; // near
+		f.planes[5] = r3 - r2; // far
+
+		for(auto &plane: f.planes) {
+			auto length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+			if(length > 0) { plane /= length; }
+		}
+
+		return f;
+	}
+
+	size_t Frustum::cullSpheres(const float *pX, const float *pY, const float *pZ, const float *pRadius,
+	                            size_t pCount, uint8_t *pVisible) const {
+		size_t i = 0, visible = 0;
+
+#ifdef AURORA_FRUSTUM_SSE
+		for(; i + 4 <= pCount; i += 4) {
+			auto x = _mm_loadu_ps(pX + i);
+			auto y = _mm_loadu_ps(pY + i);
+			auto z = _mm_loadu_ps(pZ + i);
+			auto negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(pRadius + i));
+
+			// Bits stay set while every plane so far has the sphere at least
+			// partly inside.
+			int mask = 0xf;
+			for(const auto &plane: planes) {
+				auto distance = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+					_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+				mask &= _mm_movemask_ps(_mm_cmpge_ps(distance, negRadius));
+			}
+
+			for(int lane = 0; lane < 4; ++lane) {
+				auto v = static_cast<uint8_t>(mask >> lane & 1);
+				pVisible[i + lane] = v;
+				visible += v;
+			}
+		}
+#endif
+
+		for(; i < pCount; ++i) {
+			bool inside = true;
+			for(const auto &plane: planes) {
+				if(pX[i] * plane.x + pY[i] * plane.y + pZ[i] * plane.z + plane.w < -pRadius[i]) {
+					inside = false;
+					break;
+				}
+			}
+
+			pVisible[i] = inside;
+			visible += inside;
+		}
+
+		return visible;
+	}
+}// namespace aurora
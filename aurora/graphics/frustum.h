@@ -0,0 +1,51 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_FRUSTUM_H
+#define AURORA_FRUSTUM_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace aurora {
+
+	/**
+	 * The six planes bounding what a camera can see.
+	 *
+	 * Each plane is stored as (normal, distance) with the normal pointing
+	 * into the frustum, so a point p is inside a plane when
+	 * dot(normal, p) + distance >= 0.
+	 */
+	struct Frustum {
+		glm::vec4 planes[6];
+
+		/**
+		 * Extracts the planes of a combined perspective * view matrix. The
+		 * normals are normalised so that plane distances are in world units.
+		 */
+		static Frustum fromMatrix(const glm::mat4 &pViewProjection);
+
+		/**
+		 * Tests a batch of bounding spheres against the frustum, four at a
+		 * time where SSE is available.
+		 *
+		 * A sphere counts as visible unless it lies entirely outside one of
+		 * the planes, so a few spheres near the corners are kept although
+		 * they cannot be seen.
+		 *
+		 * @param pX, pY, pZ World-space centres.
+		 * @param pRadius World-space radii.
+		 * @param pCount Number of spheres.
+		 * @param pVisible Receives 1 for every visible sphere and 0 otherwise.
+		 * @return The number of visible spheres.
+		 */
+		size_t cullSpheres(const float *pX, const float *pY, const float *pZ, const float *pRadius, size_t pCount,
+		                   uint8_t *pVisible) const;
+	};
+
+}// namespace aurora
+
+#endif// AURORA_FRUSTUM_H
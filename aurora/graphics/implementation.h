@@ -104,6 +104,45 @@ namespace aurora {
 		};
 	};
 
+	/**
+	 * A range of a stream buffer reserved by
+	 * Implementation::mapStreamBuffer().
+	 */
+	struct StreamBufferRange {
+		/**
+		 * Where the data is to be written. Only valid until the buffer is
+		 * unmapped.
+		 */
+		void *data;
+
+		/**
+		 * Offset (in bytes) of the range from the start of the buffer, for
+		 * draw objects and bindings reading it.
+		 */
+		size_t offset;
+	};
+
+	/**
+	 * The contents of the Camera uniform block, laid out as std140 lays out
+	 * the block in a shader:
+	 *
+	 * ```glsl
+	 * layout(std140) uniform Camera {
+	 *     mat4 view;
+	 *     mat4 perspective;
+	 *     float time;
+	 * };
+	 * ```
+	 *
+	 * A shader may leave out trailing members it does not read.
+	 */
+	struct CameraBlock {
+		glm::mat4 view;
+		glm::mat4 perspective;
+		float time;
+		float padding[3];
+	};
+
 	struct MatrixSet {
 		glm::mat4 object, view, perspective;
 
@@ -287,12 +326,13 @@ namespace aurora {
 		 * automatically.
 		 *
 		 * @param pObject Reference to an existing buffer.
-		 * @param pData Pointer to the data to copy.
+		 * @param pData Pointer to the data to copy, or nullptr to only
+		 * allocate pSize bytes, to be written with the pOffset overload.
 		 * @param pSize Size (in bytes) of the data to copy.
 		 * @throws EInvalidRef The reference does not refer to a buffer.
 		 * @throws std::runtime_error Possible implementation-dependent errors.
 		 */
-		virtual void updateBufferData(ObjRefBase *pObject, void *pData, size_t pSize) = 0;
+		virtual void updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize) = 0;
 
 		/**
 		 * Updates part of the data contained within the specified buffer.
@@ -310,7 +350,7 @@ namespace aurora {
 		 * the buffer.
 		 * @throws std::runtime_error Possible implementation-dependent errors.
 		 */
-		virtual void updateBufferData(ObjRefBase *pObject, void *pData, size_t pSize, size_t pOffset) = 0;
+		virtual void updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize, size_t pOffset) = 0;
 
 		/**
 		 * Retrieves data from the buffer and stores it at the memory pointed to
@@ -330,6 +370,65 @@ namespace aurora {
 		 */
 		virtual void retrieveBufferData(ObjRefBase *pObject, void *pData, size_t pSize, size_t pOffset) = 0;
 
+		// STREAM BUFFERS
+
+		/**
+		 * Creates a buffer for data that is rewritten every frame. It is a
+		 * ring of pSize bytes: every write takes the next free range, so the
+		 * data written in earlier frames is left alone while the GPU might
+		 * still read it.
+		 *
+		 * The returned reference is also a buffer reference, so it can be
+		 * used wherever a buffer can, such as in a draw object.
+		 *
+		 * @param pType The type of the buffer to create.
+		 * @param pSize Size (in bytes) of the ring. This must hold all the
+		 * writes of one frame, and should hold a few frames of them, or
+		 * writing waits for the GPU to catch up.
+		 * @return A reference to the new stream buffer.
+		 * @throws std::runtime_error Possible implementation-dependent errors.
+		 */
+		virtual ObjRefBase *createStreamBuffer(BufferType pType, size_t pSize) = 0;
+
+		/**
+		 * Destroys a stream buffer resource by reference.
+		 *
+		 * This method will never throw an exception.
+		 *
+		 * @param pObject The stream buffer to destroy.
+		 */
+		virtual void destroyStreamBuffer(ObjRefBase *pObject) noexcept = 0;
+
+		/**
+		 * Reserves the next pSize bytes of a stream buffer for writing. The
+		 * range stays valid until the end of the frame, as ranges written in
+		 * the current frame are never reused or orphaned.
+		 *
+		 * The buffer must be unmapped with unmapStreamBuffer() before anything
+		 * reads it, and before it is mapped again.
+		 *
+		 * @param pObject Reference to an existing stream buffer.
+		 * @param pSize Size (in bytes) of the range.
+		 * @param pAlignment The offset of the range is a multiple of this.
+		 * Vertex data should be aligned to the vertex size, so that the
+		 * offset can be turned into a base vertex.
+		 * @return Where to write and where the data will be.
+		 * @throws EInvalidRef The reference does not refer to a stream buffer.
+		 * @throws EBufferOverflow pSize is larger than the buffer, or the
+		 * range does not fit beside what the current frame already wrote.
+		 * @throws std::runtime_error Possible implementation-dependent errors.
+		 */
+		virtual StreamBufferRange mapStreamBuffer(ObjRefBase *pObject, size_t pSize, size_t pAlignment) = 0;
+
+		/**
+		 * Finishes the writes to the range returned by the last
+		 * mapStreamBuffer(), making them visible to the GPU.
+		 *
+		 * @param pObject Reference to an existing stream buffer.
+		 * @throws EInvalidRef The reference does not refer to a stream buffer.
+		 */
+		virtual void unmapStreamBuffer(ObjRefBase *pObject) = 0;
+
 		// TEXTURE 1D
 
 		/**
@@ -782,6 +881,77 @@ namespace aurora {
 		 */
 		virtual void performDraw(ObjRefBase *pDrawObject, const MatrixSet &pMatrices) = 0;
 
+		/**
+		 * Sets the Camera uniform block read by every following draw, until
+		 * it is next set. Shaders that declare the block read their view and
+		 * perspective matrices from it once per camera, instead of being
+		 * sent those of the MatrixSet with every draw.
+		 *
+		 * Shaders that declare an Objects block read their object matrices
+		 * from it, indexed by gl_InstanceID:
+		 *
+		 * ```glsl
+		 * layout(std140) uniform Objects {
+		 *     mat4 objects[256];
+		 * };
+		 * ```
+		 *
+		 * The backend packs the matrices of each batch into the block, so
+		 * that a batch costs one draw per block-full of objects and no
+		 * uniform calls. The array may be any length that fits in a uniform
+		 * block; 256 matrices fill the 16 KiB that every backend supports.
+		 *
+		 * @param pView The view matrix.
+		 * @param pPerspective The perspective matrix.
+		 * @param pTime Seconds of simulation time, for animating shaders.
+		 */
+		virtual void setCameraUniforms(const glm::mat4 &pView, const glm::mat4 &pPerspective, float pTime) = 0;
+
+		/**
+		 * Draws the passed draw object once for every object matrix. The
+		 * object matrix in pMatrices is ignored.
+		 *
+		 * Shaders that take the object matrix as an instance input are drawn
+		 * with a single call when the backend supports it, and shaders with
+		 * an Objects block with one call per block-full of matrices. Any
+		 * other shader is drawn once per matrix, as if by performDraw().
+		 *
+		 * @param pDrawObject The object to draw.
+		 * @param pMatrices The view and perspective matrices.
+		 * @param pObjects Object matrices, one per instance.
+		 * @param pCount Number of matrices in pObjects.
+		 * @throws EInvalidRef The reference does not refer to a draw object.
+		 */
+		virtual void performDrawInstanced(ObjRefBase *pDrawObject, const MatrixSet &pMatrices,
+		                                  const glm::mat4 *pObjects, uint32_t pCount) = 0;
+
+		/**
+		 * Gets a key that is equal for draw objects binding the same shader,
+		 * buffers and textures, and that groups draw objects sharing a shader
+		 * when sorted. The value has no meaning beyond that.
+		 *
+		 * @param pDrawObject The draw object to get the key of.
+		 * @return The state key of the draw object.
+		 * @throws EInvalidRef The reference does not refer to a draw object.
+		 */
+		virtual uint32_t getDrawObjectStateKey(ObjRefBase *pDrawObject) = 0;
+
+		/**
+		 * Changes which part of its buffers a draw object reads. This lets a
+		 * draw object draw data written to a stream buffer, or one of many
+		 * meshes packed into the same buffers.
+		 *
+		 * @param pDrawObject The draw object to change.
+		 * @param pIndexOffset Offset (in bytes) of the first index in the
+		 * index buffer.
+		 * @param pIndexCount Number of indices to draw. This replaces the
+		 * vertexCount the draw object was created with.
+		 * @param pBaseVertex Added to every index before the vertex is read.
+		 * @throws EInvalidRef The reference does not refer to a draw object.
+		 */
+		virtual void setDrawObjectRange(ObjRefBase *pDrawObject, size_t pIndexOffset, uint32_t pIndexCount,
+		                                int32_t pBaseVertex) = 0;
+
 		// WINDOW
 
 		/**
@@ -812,7 +982,8 @@ namespace aurora {
 		 * the end of a frame, after everything else has been done.
 		 *
 		 * @param pWindow Window to swap to. Should be the currently bound
-		 * window.
+		 * window. nullptr when running headless, which only backends that
+		 * need no window are asked to do.
 		 */
 		virtual void performFinishFrame(Window *pWindow) = 0;
 	};
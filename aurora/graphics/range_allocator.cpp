@@ -0,0 +1,96 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "range_allocator.h"
+#include <iterator>
+#include <stdexcept>
+
+namespace aurora {
+	RangeAllocator::RangeAllocator(size_t pCapacity) : m_Capacity(pCapacity), m_FreeBytes(0) {
+		if(pCapacity > 0) { insertFree(0, pCapacity); }
+	}
+
+	void RangeAllocator::insertFree(size_t pOffset, size_t pSize) {
+		m_ByOffset.emplace(pOffset, pSize);
+		m_BySize.emplace(pSize, pOffset);
+		m_FreeBytes += pSize;
+	}
+
+	void RangeAllocator::eraseFree(std::map<size_t, size_t>::iterator pRange) {
+		auto [first, last] = m_BySize.equal_range(pRange->second);
+		for(auto it = first; it != last; ++it) {
+			if(it->second == pRange->first) {
+				m_BySize.erase(it);
+				break;
+			}
+		}
+
+		m_FreeBytes -= pRange->second;
+		m_ByOffset.erase(pRange);
+	}
+
+	size_t RangeAllocator::allocate(size_t pSize, size_t pAlignment) {
+		if(pSize == 0) { return invalid; }
+		if(pAlignment == 0) { pAlignment = 1; }
+
+		// Ranges are tried from the smallest that could fit; one whose start
+		// has to be pushed out to the alignment may still be too short.
+		for(auto it = m_BySize.lower_bound(pSize); it != m_BySize.end(); ++it) {
+			auto offset = it->second, end = it->second + it->first;
+			auto start = (offset + pAlignment - 1) / pAlignment * pAlignment;
+			if(start + pSize > end) { continue; }
+
+			eraseFree(m_ByOffset.find(offset));
+			if(start > offset) { insertFree(offset, start - offset); }
+			if(start + pSize < end) { insertFree(start + pSize, end - start - pSize); }
+			return start;
+		}
+
+		return invalid;
+	}
+
+	void RangeAllocator::free(size_t pOffset, size_t pSize) {
+		if(pSize == 0) { return; }
+
+		if(pOffset > m_Capacity || pSize > m_Capacity - pOffset) {
+			throw std::runtime_error("range is outside the allocator");
+		}
+
+		// Both neighbours are checked before either is merged, so that a bad
+		// free leaves the allocator as it was.
+		if(!isAllocated(pOffset, pSize)) { throw std::runtime_error("range is already free"); }
+
+		auto end = pOffset + pSize;
+		auto next = m_ByOffset.lower_bound(pOffset);
+		if(next != m_ByOffset.end() && next->first == end) {
+			end += next->second;
+			eraseFree(next);
+		}
+
+		next = m_ByOffset.lower_bound(pOffset);
+		if(next != m_ByOffset.begin()) {
+			auto previous = std::prev(next);
+			if(previous->first + previous->second == pOffset) {
+				pOffset = previous->first;
+				eraseFree(previous);
+			}
+		}
+
+		insertFree(pOffset, end - pOffset);
+	}
+
+	bool RangeAllocator::isAllocated(size_t pOffset, size_t pSize) const {
+		if(pOffset > m_Capacity || pSize > m_Capacity - pOffset) { return false; }
+
+		auto next = m_ByOffset.lower_bound(pOffset);
+		if(next != m_ByOffset.end() && next->first < pOffset + pSize) { return false; }
+		if(next != m_ByOffset.begin()) {
+			auto previous = std::prev(next);
+			if(previous->first + previous->second > pOffset) { return false; }
+		}
+
+		return true;
+	}
+}// namespace aurora
@@ -0,0 +1,77 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_RANGE_ALLOCATOR_H
+#define AURORA_RANGE_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace aurora {
+
+	/**
+	 * Hands out ranges of a space of fixed size, such as a GPU buffer, and
+	 * takes them back. Nothing is stored in the space itself, so it can
+	 * manage memory the CPU cannot touch.
+	 *
+	 * Free ranges are kept twice: by offset, so that a freed range merges
+	 * with free neighbours and the space does not splinter, and by size, so
+	 * that an allocation takes the smallest free range it fits in.
+	 */
+	class RangeAllocator {
+	public:
+		static constexpr size_t invalid = SIZE_MAX;
+
+	private:
+		size_t m_Capacity;
+		size_t m_FreeBytes;
+
+		// offset -> size, and size -> offset.
+		std::map<size_t, size_t> m_ByOffset;
+		std::multimap<size_t, size_t> m_BySize;
+
+		void insertFree(size_t pOffset, size_t pSize);
+		void eraseFree(std::map<size_t, size_t>::iterator pRange);
+
+	public:
+		explicit RangeAllocator(size_t pCapacity);
+
+		/**
+		 * Takes a range of pSize bytes.
+		 *
+		 * @param pAlignment The offset is a multiple of this, which need not
+		 * be a power of two, so that vertex data can be aligned to its
+		 * stride.
+		 * @return The offset of the range, or invalid if no free range can
+		 * hold it.
+		 */
+		size_t allocate(size_t pSize, size_t pAlignment = 1);
+
+		/**
+		 * Gives back a range from allocate(). pSize must be the size it was
+		 * allocated with.
+		 *
+		 * @throws std::runtime_error The range is outside the allocator, or
+		 * part of it is already free. The allocator is left as it was.
+		 */
+		void free(size_t pOffset, size_t pSize);
+
+		/**
+		 * @return Whether the range lies in the allocator and no part of it
+		 * is free, so that free() would take it.
+		 */
+		[[nodiscard]] bool isAllocated(size_t pOffset, size_t pSize) const;
+
+		[[nodiscard]] size_t getCapacity() const { return m_Capacity; }
+
+		[[nodiscard]] size_t getFreeBytes() const { return m_FreeBytes; }
+
+		[[nodiscard]] bool isEmpty() const { return m_FreeBytes == m_Capacity; }
+	};
+
+}// namespace aurora
+
+#endif// AURORA_RANGE_ALLOCATOR_H
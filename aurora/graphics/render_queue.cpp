@@ -0,0 +1,170 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "render_queue.h"
+#include "../global.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace aurora {
+	uint64_t RenderQueue::makeKey(uint8_t pLayer, uint32_t pState, float pDepth) {
+		// Non-negative floats order the same as their bit patterns; dropping
+		// the sign bit and the lowest mantissa bits leaves 24 ordered bits.
+		auto depth = std::bit_cast<uint32_t>(std::max(pDepth, 0.0f)) >> 7;
+
+		return static_cast<uint64_t>(pLayer) << layerShift |
+		       static_cast<uint64_t>(pState) << stateShift |
+		       (depth & depthMask);
+	}
+
+	void RenderQueue::begin(const glm::mat4 &pView, const glm::mat4 &pPerspective, float pTime) {
+		m_Packets.clear();
+		m_View = pView;
+		m_Perspective = pPerspective;
+		m_Time = pTime;
+		m_Frustum = Frustum::fromMatrix(pPerspective * pView);
+	}
+
+	void RenderQueue::submit(ObjRefBase *pDrawObject, const glm::mat4 &pObject, uint8_t pLayer) {
+		// The camera looks down -Z, so the distance is the negated view-space Z.
+		auto depth = -(m_View * pObject[3]).z;
+		submit(makeKey(pLayer, global->getImpl()->getDrawObjectStateKey(pDrawObject), depth), pDrawObject, pObject);
+	}
+
+	void RenderQueue::submit(ObjRefBase *pDrawObject, const glm::mat4 &pObject, const aether::Bounds &pBounds,
+	                         uint8_t pLayer) {
+		auto depth = -(m_View * pObject[3]).z;
+		submit(makeKey(pLayer, global->getImpl()->getDrawObjectStateKey(pDrawObject), depth), pDrawObject, pObject,
+		       glm::vec4(pBounds.getCenter(), pBounds.getRadius()));
+	}
+
+	void RenderQueue::submit(uint64_t pKey, ObjRefBase *pDrawObject, const glm::mat4 &pObject) {
+		submit(pKey, pDrawObject, pObject, glm::vec4(0, 0, 0, -1));
+	}
+
+	void RenderQueue::submit(uint64_t pKey, ObjRefBase *pDrawObject, const glm::mat4 &pObject,
+	                         const glm::vec4 &pSphere) {
+		m_Packets.push_back({pKey, pDrawObject, pObject, pSphere});
+	}
+
+	void RenderQueue::cull(const Packet *pPackets, size_t pCount) {
+		m_CullX.clear();
+		m_CullY.clear();
+		m_CullZ.clear();
+		m_CullRadius.clear();
+		m_CullIndex.clear();
+
+		for(uint32_t i = 0; i < pCount; ++i) {
+			const auto &packet = pPackets[i];
+			if(packet.sphere.w < 0) {
+				m_Order.push_back({packet.key, packet.drawObject, i, 0});
+				continue;
+			}
+
+			// The sphere grows by the largest singular value of the linear
+			// part M. Its square is the largest eigenvalue of M^T M, which the
+			// Gershgorin bound below never underestimates. Without shear the
+			// columns are orthogonal, and the bound is exactly the squared
+			// length of the longest axis.
+			const auto &m = packet.object;
+			auto centre = m * glm::vec4(packet.sphere.x, packet.sphere.y, packet.sphere.z, 1);
+			glm::vec3 x(m[0]), y(m[1]), z(m[2]);
+			auto xy = std::abs(glm::dot(x, y)), xz = std::abs(glm::dot(x, z)), yz = std::abs(glm::dot(y, z));
+			auto scale = std::max({
+				                      glm::dot(x, x) + xy + xz,
+				                      glm::dot(y, y) + xy + yz,
+				                      glm::dot(z, z) + xz + yz
+			                      });
+
+			m_CullX.push_back(centre.x);
+			m_CullY.push_back(centre.y);
+			m_CullZ.push_back(centre.z);
+			m_CullRadius.push_back(packet.sphere.w * std::sqrt(scale));
+			m_CullIndex.push_back(i);
+		}
+
+		m_CullVisible.resize(m_CullIndex.size());
+		auto visible = m_Frustum.cullSpheres(m_CullX.data(), m_CullY.data(), m_CullZ.data(), m_CullRadius.data(),
+		                                     m_CullIndex.size(), m_CullVisible.data());
+		m_Culled = m_CullIndex.size() - visible;
+
+		for(size_t i = 0; i < m_CullIndex.size(); ++i) {
+			if(!m_CullVisible[i]) { continue; }
+
+			const auto &packet = pPackets[m_CullIndex[i]];
+			m_Order.push_back({packet.key, packet.drawObject, m_CullIndex[i], 0});
+		}
+	}
+
+	void RenderQueue::groupBatches() {
+		// The entries are in depth order. Within each run of one layer and
+		// state, every draw of a draw object is moved up to its nearest one,
+		// so the batches are drawn front-to-back by their nearest instance
+		// and each keeps its instances in depth order.
+		for(size_t begin = 0; begin < m_Order.size();) {
+			auto stateKey = m_Order[begin].key >> stateShift;
+			auto end = begin;
+
+			m_BatchOf.clear();
+			for(; end < m_Order.size() && m_Order[end].key >> stateShift == stateKey; ++end) {
+				auto [iter, inserted] = m_BatchOf.try_emplace(m_Order[end].drawObject,
+				                                              static_cast<uint32_t>(m_BatchOf.size()));
+				m_Order[end].batch = iter->second;
+			}
+
+			// A run of a single draw object is already in order.
+			if(m_BatchOf.size() > 1) {
+				std::stable_sort(m_Order.begin() + static_cast<ptrdiff_t>(begin),
+				                 m_Order.begin() + static_cast<ptrdiff_t>(end),
+				                 [](const SortEntry &pA, const SortEntry &pB) { return pA.batch < pB.batch; });
+			}
+
+			begin = end;
+		}
+	}
+
+	void RenderQueue::execute() {
+		execute(m_Packets.data(), m_Packets.size());
+		m_Packets.clear();
+	}
+
+	void RenderQueue::execute(const Packet *pPackets, size_t pCount) {
+		// Sorting the small entries and not the packets avoids moving the
+		// matrices around.
+		m_Order.clear();
+		m_Order.reserve(pCount);
+		cull(pPackets, pCount);
+
+		std::sort(m_Order.begin(), m_Order.end(), [](const SortEntry &pA, const SortEntry &pB) {
+			return pA.key != pB.key ? pA.key < pB.key : pA.index < pB.index;
+		});
+		groupBatches();
+
+		auto impl = global->getImpl();
+		impl->setCameraUniforms(m_View, m_Perspective, m_Time);
+
+		// Only shaders without a Camera block still read the camera from here.
+		MatrixSet matrices(glm::identity<glm::mat4>(), m_View, m_Perspective);
+		for(size_t i = 0; i < m_Order.size();) {
+			auto drawObject = m_Order[i].drawObject;
+			auto stateKey = m_Order[i].key >> stateShift;
+
+			m_Instances.clear();
+			for(; i < m_Order.size() && m_Order[i].drawObject == drawObject &&
+			      m_Order[i].key >> stateShift == stateKey; ++i) {
+				m_Instances.push_back(pPackets[m_Order[i].index].object);
+			}
+
+			if(m_Instances.size() == 1) {
+				matrices.object = m_Instances[0];
+				impl->performDraw(drawObject, matrices);
+			} else {
+				impl->performDrawInstanced(drawObject, matrices, m_Instances.data(),
+				                           static_cast<uint32_t>(m_Instances.size()));
+			}
+		}
+	}
+}// namespace aurora
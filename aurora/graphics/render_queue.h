@@ -0,0 +1,197 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_RENDER_QUEUE_H
+#define AURORA_RENDER_QUEUE_H
+
+#include "frustum.h"
+#include "implementation.h"
+#include "aurora/aether/aether.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace aurora {
+
+	/**
+	 * Collects the draws of a single camera so that they can be sorted
+	 * before any of them reach the implementation.
+	 *
+	 * Every draw carries a 64-bit key, compared as an unsigned integer:
+	 *
+	 * | Bits   | Field                                                  |
+	 * |--------|--------------------------------------------------------|
+	 * | 63..56 | Layer; lower layers are drawn first.                   |
+	 * | 55..24 | State key of the draw object (shader, textures).       |
+	 * | 23..0  | View-space depth, so each state is drawn front-to-back.|
+	 *
+	 * A queue only ever targets the framebuffer of the camera it was begun
+	 * for, so the framebuffer does not need any bits of its own.
+	 *
+	 * Draws of the same draw object that share a layer and state are
+	 * gathered and performed as one instanced draw. Within such a batch the
+	 * instances stay in depth order, and the batches of a layer and state
+	 * are drawn in the order of their nearest instance.
+	 *
+	 * Draws submitted with bounds are tested against the camera's frustum
+	 * before sorting, so that culled draws cost neither sorting nor a draw
+	 * call.
+	 */
+	class RenderQueue {
+	public:
+		static constexpr int layerShift = 56;
+		static constexpr int stateShift = 24;
+		static constexpr uint64_t depthMask = (1ull << stateShift) - 1;
+
+		struct Packet {
+			uint64_t key;
+			ObjRefBase *drawObject;
+			glm::mat4 object;
+
+			/**
+			 * Bounding sphere in object space as (centre, radius). A negative
+			 * radius means the draw is never culled.
+			 */
+			glm::vec4 sphere;
+		};
+
+	private:
+		struct SortEntry {
+			uint64_t key;
+			ObjRefBase *drawObject;
+			uint32_t index;
+
+			// Order of the draw object's nearest draw within its layer and state.
+			uint32_t batch;
+		};
+
+		std::vector<Packet> m_Packets;
+		std::vector<SortEntry> m_Order;
+		std::vector<glm::mat4> m_Instances;
+		std::unordered_map<ObjRefBase *, uint32_t> m_BatchOf;
+		glm::mat4 m_View = glm::identity<glm::mat4>();
+		glm::mat4 m_Perspective = glm::identity<glm::mat4>();
+		float m_Time = 0;
+		Frustum m_Frustum{};
+		size_t m_Culled = 0;
+
+		// World-space spheres of the bounded packets, split by component so
+		// that they can be culled four at a time.
+		std::vector<float> m_CullX, m_CullY, m_CullZ, m_CullRadius;
+		std::vector<uint32_t> m_CullIndex;
+		std::vector<uint8_t> m_CullVisible;
+
+		void cull(const Packet *pPackets, size_t pCount);
+		void groupBatches();
+
+	public:
+		/**
+		 * Builds a sort key from its parts.
+		 *
+		 * @param pLayer Coarse ordering, such as opaque geometry before
+		 * overlays.
+		 * @param pState A state key from Implementation::getDrawObjectStateKey().
+		 * @param pDepth Distance in front of the camera. Negative values are
+		 * treated as zero.
+		 */
+		static uint64_t makeKey(uint8_t pLayer, uint32_t pState, float pDepth);
+
+		/**
+		 * Drops anything that was submitted and sets the camera matrices that
+		 * the following draws will use.
+		 *
+		 * @param pTime Seconds of simulation time, passed on to shaders in
+		 * the Camera block.
+		 */
+		void begin(const glm::mat4 &pView, const glm::mat4 &pPerspective, float pTime = 0);
+
+		/**
+		 * Queues a draw, deriving its key from the state of the draw object
+		 * and the depth of the object matrix's origin.
+		 *
+		 * @throws EInvalidRef The reference does not refer to a draw object.
+		 */
+		void submit(ObjRefBase *pDrawObject, const glm::mat4 &pObject, uint8_t pLayer = 0);
+
+		/**
+		 * Queues a draw like above, skipping it when the bounds, moved by the
+		 * object matrix, are outside the camera's frustum.
+		 *
+		 * @param pBounds Bounds of the drawn mesh in object space.
+		 * @throws EInvalidRef The reference does not refer to a draw object.
+		 */
+		void submit(ObjRefBase *pDrawObject, const glm::mat4 &pObject, const aether::Bounds &pBounds,
+		            uint8_t pLayer = 0);
+
+		/**
+		 * Queues a draw with a key that the caller built.
+		 */
+		void submit(uint64_t pKey, ObjRefBase *pDrawObject, const glm::mat4 &pObject);
+
+		/**
+		 * Queues a draw with a key that the caller built and a bounding
+		 * sphere in object space.
+		 */
+		void submit(uint64_t pKey, ObjRefBase *pDrawObject, const glm::mat4 &pObject, const glm::vec4 &pSphere);
+
+		/**
+		 * Culls the queued draws, sorts the rest by key and performs them in
+		 * that order, batching repeated draw objects. Draws with equal keys
+		 * keep their submission order. The queue is empty afterwards.
+		 *
+		 * The camera is set with Implementation::setCameraUniforms() once,
+		 * before the first draw.
+		 */
+		void execute();
+
+		/**
+		 * Culls, sorts and performs draws recorded elsewhere, such as in a
+		 * frame snapshot, with the matrices of the last begin(). The queued
+		 * draws are left alone.
+		 */
+		void execute(const Packet *pPackets, size_t pCount);
+
+		/**
+		 * The draws queued since begin(), for handing them to another thread
+		 * to execute.
+		 */
+		[[nodiscard]] const std::vector<Packet> &getPackets() const {
+			return m_Packets;
+		}
+
+		/**
+		 * Drops the queued draws without performing them.
+		 */
+		void clear() {
+			m_Packets.clear();
+		}
+
+		[[nodiscard]] size_t size() const {
+			return m_Packets.size();
+		}
+
+		/**
+		 * @return How many draws the last execute() culled.
+		 */
+		[[nodiscard]] size_t getCulledCount() const {
+			return m_Culled;
+		}
+
+		[[nodiscard]] const Frustum &getFrustum() const {
+			return m_Frustum;
+		}
+
+		[[nodiscard]] const glm::mat4 &getViewMatrix() const {
+			return m_View;
+		}
+
+		[[nodiscard]] const glm::mat4 &getPerspectiveMatrix() const {
+			return m_Perspective;
+		}
+	};
+
+}// namespace aurora
+
+#endif// AURORA_RENDER_QUEUE_H
@@ -10,6 +10,15 @@ namespace aurora {
 		m_AssetLoader = new AssetLoader(pAssetPath);
 		m_Implementation = pFinder->construct();
 		m_Graphics = new Graphics(m_Implementation);
+		m_Jobs = new JobSystem();
+	}
+
+	Instance::~Instance() {
+		// Jobs and loaded assets may still use the implementation.
+		delete m_Jobs;
+		delete m_AssetLoader;
+		delete m_Graphics;
+		delete m_Implementation;
 	}
 
 }// namespace aurora
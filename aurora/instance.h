@@ -10,6 +10,7 @@
 #include "graphics/graphics.h"
 #include "graphics/implementation.h"
 #include "graphics/implementation_finder.h"
+#include "jobs.h"
 
 namespace aurora {
 
@@ -18,22 +19,61 @@ namespace aurora {
 		Implementation *m_Implementation;
 		AssetLoader *m_AssetLoader;
 		Graphics *m_Graphics;
-		Window *m_Window;
+		Window *m_Window = nullptr;
+		JobSystem *m_Jobs;
+		glm::ivec2 m_HeadlessViewportSize{1280, 720};
 
 	public:
 		Instance(ImplementationFinder *pFinder, const std::filesystem::path &pAssetPath);
 
+		/**
+		 * Joins the job and loader threads, then destroys the implementation.
+		 * The window belongs to whoever set it.
+		 */
+		~Instance();
+
+		Instance(const Instance &) = delete;
+		Instance &operator=(const Instance &) = delete;
+
 		[[nodiscard]] inline Implementation *getImpl() const { return m_Implementation; }
 
 		[[nodiscard]] inline AssetLoader *getAssetLoader() const { return m_AssetLoader; }
 
 		[[nodiscard]] inline Graphics *getGraphics() const { return m_Graphics; }
 
+		/**
+		 * @return The window, or nullptr when running headless.
+		 */
 		[[nodiscard]] inline Window *getWindow() const { return m_Window; }
 
+		[[nodiscard]] inline JobSystem *getJobs() const { return m_Jobs; }
+
 		void setWindow(Window *pWindow) {
 			m_Window = pWindow;
 		}
+
+		/**
+		 * @return The size of the window, or the headless viewport size when
+		 * there is no window.
+		 */
+		[[nodiscard]] glm::ivec2 getViewportSize() const {
+			return m_Window != nullptr ? m_Window->getSize() : m_HeadlessViewportSize;
+		}
+
+		/**
+		 * @return Whether frames are seen; always true without a window.
+		 */
+		[[nodiscard]] bool isViewportVisible() const {
+			return m_Window == nullptr || m_Window->isReallyVisible();
+		}
+
+		/**
+		 * Sets the size that cameras and framebuffers use when there is no
+		 * window.
+		 */
+		void setHeadlessViewportSize(glm::ivec2 pSize) {
+			m_HeadlessViewportSize = pSize;
+		}
 	};
 
 }// namespace aurora
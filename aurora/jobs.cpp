@@ -0,0 +1,172 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "jobs.h"
+#include "aether/profiler.h"
+#include <utility>
+
+namespace aurora {
+	namespace {
+		thread_local const JobSystem *currentSystem = nullptr;
+		thread_local size_t currentWorkerSlot = 0;
+	}
+
+	JobSystem::JobSystem(unsigned pWorkerCount) {
+		for(unsigned i = 0; i <= pWorkerCount; ++i) { m_Queues.emplace_back(std::make_unique<Queue>()); }
+		for(unsigned i = 1; i <= pWorkerCount; ++i) { m_Workers.emplace_back(&JobSystem::runWorker, this, i); }
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard lock(m_SleepMutex);
+			m_Stopping = true;
+		}
+		m_SleepCondition.notify_all();
+
+		for(auto &item: m_Workers) { item.join(); }
+	}
+
+	size_t JobSystem::currentSlot() const {
+		return currentSystem == this ? currentWorkerSlot : 0;
+	}
+
+	void JobSystem::push(Task pTask) {
+		auto &queue = *m_Queues[currentSlot()];
+		{
+			std::lock_guard lock(queue.mutex);
+			queue.tasks.push_back(std::move(pTask));
+		}
+
+		// A worker going to sleep counts itself before it checks m_Queued, so
+		// either it sees this job or this sees it sleeping.
+		++m_Queued;
+		if(m_Sleeping.load() > 0) {
+			{ std::lock_guard lock(m_SleepMutex); }
+			m_SleepCondition.notify_one();
+		}
+	}
+
+	bool JobSystem::tryRunOne(size_t pSlot) {
+		Task task;
+		bool found = false;
+
+		{
+			auto &own = *m_Queues[pSlot];
+			std::lock_guard lock(own.mutex);
+			if(!own.tasks.empty()) {
+				task = std::move(own.tasks.back());
+				own.tasks.pop_back();
+				found = true;
+			}
+		}
+
+		for(size_t i = 1; !found && i < m_Queues.size(); ++i) {
+			auto &other = *m_Queues[(pSlot + i) % m_Queues.size()];
+			std::lock_guard lock(other.mutex);
+			if(!other.tasks.empty()) {
+				task = std::move(other.tasks.front());
+				other.tasks.pop_front();
+				found = true;
+			}
+		}
+
+		if(!found) { return false; }
+		--m_Queued;
+
+		try {
+			task.job();
+		} catch(...) {
+			std::lock_guard lock(task.group->m_Mutex);
+			if(!task.group->m_Error) { task.group->m_Error = std::current_exception(); }
+		}
+
+		finish(task.group);
+		return true;
+	}
+
+	void JobSystem::finish(Group *pGroup) {
+		// The group may be destroyed as soon as a waiter sees it done, so
+		// m_Finishing keeps it looking busy until this is done touching it.
+		++pGroup->m_Finishing;
+
+		std::vector<std::pair<Group *, Job>> continuations;
+		if(--pGroup->m_Pending == 0) {
+			std::lock_guard lock(pGroup->m_Mutex);
+			continuations.swap(pGroup->m_Continuations);
+		}
+
+		--pGroup->m_Finishing;
+
+		// Their groups counted them when they were added.
+		for(auto &item: continuations) { push({std::move(item.second), item.first}); }
+	}
+
+	void JobSystem::runWorker(size_t pSlot) {
+		currentSystem = this;
+		currentWorkerSlot = pSlot;
+		AURORA_PROFILE_THREAD("Job worker " + std::to_string(pSlot));
+
+		while(true) {
+			if(tryRunOne(pSlot)) { continue; }
+
+			std::unique_lock lock(m_SleepMutex);
+			++m_Sleeping;
+			m_SleepCondition.wait(lock, [this]() { return m_Queued.load() > 0 || m_Stopping; });
+			--m_Sleeping;
+
+			if(m_Stopping && m_Queued.load() == 0) { return; }
+		}
+	}
+
+	void JobSystem::submit(Group &pGroup, Job pJob) {
+		++pGroup.m_Pending;
+		push({std::move(pJob), &pGroup});
+	}
+
+	void JobSystem::submitAfter(Group &pDependency, Group &pGroup, Job pJob) {
+		++pGroup.m_Pending;
+
+		{
+			std::lock_guard lock(pDependency.m_Mutex);
+			if(pDependency.m_Pending.load() > 0) {
+				pDependency.m_Continuations.emplace_back(&pGroup, std::move(pJob));
+				return;
+			}
+		}
+
+		push({std::move(pJob), &pGroup});
+	}
+
+	void JobSystem::wait(Group &pGroup) {
+		auto slot = currentSlot();
+		while(!pGroup.isDone()) {
+			if(!tryRunOne(slot)) { std::this_thread::yield(); }
+		}
+
+		std::exception_ptr error;
+		{
+			std::lock_guard lock(pGroup.m_Mutex);
+			error = std::exchange(pGroup.m_Error, nullptr);
+		}
+
+		if(error) { std::rethrow_exception(error); }
+	}
+
+	void JobSystem::parallelFor(size_t pCount, size_t pGrain, const std::function<void(size_t, size_t)> &pBody) {
+		if(pGrain == 0) { pGrain = 1; }
+		if(pCount <= pGrain) {
+			if(pCount > 0) { pBody(0, pCount); }
+			return;
+		}
+
+		Group group;
+		for(size_t begin = 0; begin < pCount; begin += pGrain) {
+			auto end = std::min(begin + pGrain, pCount);
+			submit(group, [&pBody, begin, end]() { pBody(begin, end); });
+		}
+
+		wait(group);
+	}
+}// namespace aurora
@@ -0,0 +1,135 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_JOBS_H
+#define AURORA_JOBS_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace aurora {
+
+	/**
+	 * Runs short jobs on a pool of worker threads.
+	 *
+	 * Every worker has its own deque. A worker pushes and pops its own jobs
+	 * at the back, so nested work stays hot in its cache, and steals from
+	 * the front of the others' deques when it runs dry. Threads outside the
+	 * pool share one extra deque.
+	 *
+	 * Waiting for a group never blocks outright: the waiting thread runs
+	 * queued jobs until the group is done, so jobs may wait for jobs of
+	 * their own.
+	 *
+	 * Blocking work such as file access belongs in the AssetLoader, which
+	 * keeps threads of its own for it.
+	 */
+	class JobSystem {
+	public:
+		using Job = std::function<void()>;
+
+		/**
+		 * Tracks a set of jobs. A group must not be destroyed while jobs
+		 * submitted to it are unfinished; wait() for it first.
+		 */
+		class Group {
+			friend class JobSystem;
+
+			std::atomic<size_t> m_Pending{0};
+			std::atomic<size_t> m_Finishing{0};
+			std::mutex m_Mutex;
+			std::vector<std::pair<Group *, Job>> m_Continuations;
+			std::exception_ptr m_Error;
+
+		public:
+			Group() = default;
+			Group(const Group &) = delete;
+			Group &operator=(const Group &) = delete;
+
+			[[nodiscard]] bool isDone() const {
+				return m_Pending.load() == 0 && m_Finishing.load() == 0;
+			}
+		};
+
+	private:
+		struct Task {
+			Job job;
+			Group *group;
+		};
+
+		struct Queue {
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		// Slot 0 is for threads outside the pool, the workers use the rest.
+		std::vector<std::unique_ptr<Queue>> m_Queues;
+		std::vector<std::thread> m_Workers;
+
+		std::atomic<size_t> m_Queued{0};
+		std::atomic<size_t> m_Sleeping{0};
+		std::mutex m_SleepMutex;
+		std::condition_variable m_SleepCondition;
+		bool m_Stopping = false;
+
+		[[nodiscard]] size_t currentSlot() const;
+		void push(Task pTask);
+		bool tryRunOne(size_t pSlot);
+		void finish(Group *pGroup);
+		void runWorker(size_t pSlot);
+
+	public:
+		/**
+		 * @param pWorkerCount Number of threads to start. The thread that waits
+		 * on a group works too, so the default leaves one core for it.
+		 */
+		explicit JobSystem(unsigned pWorkerCount = std::max(1u, std::thread::hardware_concurrency()) - 1);
+		~JobSystem();
+
+		JobSystem(const JobSystem &) = delete;
+		JobSystem &operator=(const JobSystem &) = delete;
+
+		/**
+		 * Queues a job as part of a group.
+		 */
+		void submit(Group &pGroup, Job pJob);
+
+		/**
+		 * Queues a job as part of pGroup once every job of pDependency has
+		 * finished. It is queued at once if pDependency is already done.
+		 */
+		void submitAfter(Group &pDependency, Group &pGroup, Job pJob);
+
+		/**
+		 * Runs queued jobs on this thread until every job of the group,
+		 * including its continuations, has finished.
+		 *
+		 * @throws std::exception The first exception thrown by a job of the
+		 * group.
+		 */
+		void wait(Group &pGroup);
+
+		/**
+		 * Calls pBody with consecutive ranges of [0, pCount), each at most
+		 * pGrain long, spread over the pool. Returns when all have finished.
+		 */
+		void parallelFor(size_t pCount, size_t pGrain, const std::function<void(size_t, size_t)> &pBody);
+
+		[[nodiscard]] size_t getWorkerCount() const {
+			return m_Workers.size();
+		}
+	};
+
+}// namespace aurora
+
+#endif// AURORA_JOBS_H
@@ -0,0 +1,240 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "aabb_tree.h"
+#include <algorithm>
+#include <cmath>
+
+namespace aurora::level {
+	namespace {
+		aether::Bounds combine(const aether::Bounds &pA, const aether::Bounds &pB) {
+			return {glm::min(pA.min, pB.min), glm::max(pA.max, pB.max)};
+		}
+
+		float area(const aether::Bounds &pBox) {
+			auto d = pBox.max - pBox.min;
+			return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+		}
+
+		bool contains(const aether::Bounds &pOuter, const aether::Bounds &pInner) {
+			return pOuter.min.x <= pInner.min.x && pOuter.min.y <= pInner.min.y && pOuter.min.z <= pInner.min.z &&
+			       pOuter.max.x >= pInner.max.x && pOuter.max.y >= pInner.max.y && pOuter.max.z >= pInner.max.z;
+		}
+	}
+
+	aether::Bounds AabbTree::transform(const aether::Bounds &pBounds, const glm::mat4 &pMatrix) {
+		// Each world axis of the box is the sum of the absolute contributions
+		// of the three local axes.
+		auto centre = glm::vec3(pMatrix * glm::vec4(pBounds.getCenter(), 1));
+		auto extent = (pBounds.max - pBounds.min) * 0.5f;
+
+		glm::vec3 world;
+		for(int row = 0; row < 3; ++row) {
+			world[row] = std::abs(pMatrix[0][row]) * extent.x +
+			             std::abs(pMatrix[1][row]) * extent.y +
+			             std::abs(pMatrix[2][row]) * extent.z;
+		}
+
+		return {centre - world, centre + world};
+	}
+
+	uint32_t AabbTree::allocateNode() {
+		if(m_FreeList == none) {
+			m_Nodes.emplace_back();
+			m_Nodes.back().height = 0;
+			return static_cast<uint32_t>(m_Nodes.size() - 1);
+		}
+
+		auto index = m_FreeList;
+		m_FreeList = m_Nodes[index].parent;
+		m_Nodes[index] = Node{};
+		m_Nodes[index].height = 0;
+		return index;
+	}
+
+	void AabbTree::freeNode(uint32_t pNode) {
+		m_Nodes[pNode].parent = m_FreeList;
+		m_Nodes[pNode].height = -1;
+		m_FreeList = pNode;
+	}
+
+	AabbTree::Proxy AabbTree::createProxy(const aether::Bounds &pBounds, void *pUserData) {
+		auto leaf = allocateNode();
+		glm::vec3 margin(m_Margin, m_Margin, m_Margin);
+		m_Nodes[leaf].box = {pBounds.min - margin, pBounds.max + margin};
+		m_Nodes[leaf].userData = pUserData;
+
+		insertLeaf(leaf);
+		++m_ProxyCount;
+		return leaf;
+	}
+
+	void AabbTree::destroyProxy(Proxy pProxy) {
+		removeLeaf(pProxy);
+		freeNode(pProxy);
+		--m_ProxyCount;
+	}
+
+	bool AabbTree::moveProxy(Proxy pProxy, const aether::Bounds &pBounds) {
+		if(contains(m_Nodes[pProxy].box, pBounds)) { return false; }
+
+		removeLeaf(pProxy);
+		glm::vec3 margin(m_Margin, m_Margin, m_Margin);
+		m_Nodes[pProxy].box = {pBounds.min - margin, pBounds.max + margin};
+		insertLeaf(pProxy);
+		return true;
+	}
+
+	void AabbTree::insertLeaf(uint32_t pLeaf) {
+		if(m_Root == none) {
+			m_Root = pLeaf;
+			m_Nodes[pLeaf].parent = none;
+			return;
+		}
+
+		// Walk down towards the sibling where adding the leaf costs the least
+		// new surface area, counting the growth of every ancestor on the way.
+		auto box = m_Nodes[pLeaf].box;
+		auto index = m_Root;
+		while(!m_Nodes[index].isLeaf()) {
+			const auto &node = m_Nodes[index];
+			auto nodeArea = area(node.box);
+			auto combinedArea = area(combine(node.box, box));
+
+			// Making a new parent for this node and the leaf.
+			auto cost = 2.0f * combinedArea;
+			// What every level further down pays for this node growing.
+			auto inheritance = 2.0f * (combinedArea - nodeArea);
+
+			auto descend = [&](uint32_t pChild) {
+				const auto &child = m_Nodes[pChild];
+				auto grown = area(combine(child.box, box));
+				return child.isLeaf() ? grown + inheritance : grown - area(child.box) + inheritance;
+			};
+
+			auto cost1 = descend(node.child1);
+			auto cost2 = descend(node.child2);
+			if(cost < cost1 && cost < cost2) { break; }
+
+			index = cost1 < cost2 ? node.child1 : node.child2;
+		}
+
+		auto sibling = index;
+		auto oldParent = m_Nodes[sibling].parent;
+		auto newParent = allocateNode();
+
+		m_Nodes[newParent].parent = oldParent;
+		m_Nodes[newParent].box = combine(box, m_Nodes[sibling].box);
+		m_Nodes[newParent].height = m_Nodes[sibling].height + 1;
+		m_Nodes[newParent].child1 = sibling;
+		m_Nodes[newParent].child2 = pLeaf;
+		m_Nodes[sibling].parent = newParent;
+		m_Nodes[pLeaf].parent = newParent;
+
+		if(oldParent == none) {
+			m_Root = newParent;
+		} else if(m_Nodes[oldParent].child1 == sibling) {
+			m_Nodes[oldParent].child1 = newParent;
+		} else {
+			m_Nodes[oldParent].child2 = newParent;
+		}
+
+		refit(m_Nodes[pLeaf].parent);
+	}
+
+	void AabbTree::removeLeaf(uint32_t pLeaf) {
+		if(pLeaf == m_Root) {
+			m_Root = none;
+			return;
+		}
+
+		auto parent = m_Nodes[pLeaf].parent;
+		auto grandParent = m_Nodes[parent].parent;
+		auto sibling = m_Nodes[parent].child1 == pLeaf ? m_Nodes[parent].child2 : m_Nodes[parent].child1;
+
+		// The sibling takes the place of the parent.
+		m_Nodes[sibling].parent = grandParent;
+		freeNode(parent);
+
+		if(grandParent == none) {
+			m_Root = sibling;
+			return;
+		}
+
+		if(m_Nodes[grandParent].child1 == parent) {
+			m_Nodes[grandParent].child1 = sibling;
+		} else {
+			m_Nodes[grandParent].child2 = sibling;
+		}
+
+		refit(grandParent);
+	}
+
+	void AabbTree::refit(uint32_t pNode) {
+		for(auto index = pNode; index != none; index = m_Nodes[index].parent) {
+			index = balance(index);
+
+			auto &node = m_Nodes[index];
+			const auto &child1 = m_Nodes[node.child1];
+			const auto &child2 = m_Nodes[node.child2];
+			node.box = combine(child1.box, child2.box);
+			node.height = 1 + std::max(child1.height, child2.height);
+		}
+	}
+
+	uint32_t AabbTree::balance(uint32_t pNode) {
+		// Rotates the taller grandchild up when one side of pNode is more than
+		// one level deeper than the other, and returns the node now in its
+		// place.
+		auto &a = m_Nodes[pNode];
+		if(a.isLeaf() || a.height < 2) { return pNode; }
+
+		auto b = a.child1, c = a.child2;
+		auto difference = m_Nodes[c].height - m_Nodes[b].height;
+
+		auto rotate = [this, pNode](uint32_t pUp, uint32_t pStay) {
+			auto &node = m_Nodes[pNode];
+			auto &up = m_Nodes[pUp];
+			auto f = up.child1, g = up.child2;
+
+			// pUp replaces pNode under its parent, and pNode becomes a child
+			// of pUp.
+			up.child1 = pNode;
+			up.parent = node.parent;
+			node.parent = pUp;
+
+			if(up.parent == none) {
+				m_Root = pUp;
+			} else if(m_Nodes[up.parent].child1 == pNode) {
+				m_Nodes[up.parent].child1 = pUp;
+			} else {
+				m_Nodes[up.parent].child2 = pUp;
+			}
+
+			// The taller of pUp's children stays with it; the other moves to
+			// pNode in pUp's old place.
+			auto keep = f, give = g;
+			if(m_Nodes[f].height < m_Nodes[g].height) { std::swap(keep, give); }
+
+			up.child2 = keep;
+			if(node.child1 == pUp) {
+				node.child1 = give;
+			} else {
+				node.child2 = give;
+			}
+			m_Nodes[give].parent = pNode;
+
+			node.box = combine(m_Nodes[pStay].box, m_Nodes[give].box);
+			node.height = 1 + std::max(m_Nodes[pStay].height, m_Nodes[give].height);
+			up.box = combine(node.box, m_Nodes[keep].box);
+			up.height = 1 + std::max(node.height, m_Nodes[keep].height);
+			return pUp;
+		};
+
+		if(difference > 1) { return rotate(c, b); }
+		if(difference < -1) { return rotate(b, c); }
+		return pNode;
+	}
+} // aurora::level
@@ -0,0 +1,285 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_AABB_TREE_H
+#define AURORA_AABB_TREE_H
+
+#include "../aether/aether.h"
+#include "../graphics/frustum.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace aurora::level {
+
+	/**
+	 * A dynamic bounding volume hierarchy of axis-aligned boxes.
+	 *
+	 * Every proxy is stored with a box enlarged by a margin, so small moves
+	 * leave the tree untouched; only a move out of that box removes and
+	 * reinserts the leaf. Insertion picks the sibling that grows the total
+	 * surface area the least, and rotations keep the tree balanced.
+	 *
+	 * Queries report proxies whose enlarged box matches, so callers that need
+	 * exact answers test the proxies they are given.
+	 */
+	class AabbTree {
+	public:
+		using Proxy = uint32_t;
+
+		static constexpr uint32_t none = UINT32_MAX;
+
+	private:
+		struct Node {
+			aether::Bounds box;
+			void *userData = nullptr;
+
+			// Doubles as the next free node while the node is unused.
+			uint32_t parent = none;
+			uint32_t child1 = none;
+			uint32_t child2 = none;
+
+			// Zero for a leaf, -1 for a free node.
+			int32_t height = -1;
+
+			[[nodiscard]] bool isLeaf() const { return child1 == none; }
+		};
+
+		/*
+		 * The traversal stack of a query. It lives on the caller's stack, so
+		 * queries do not allocate; a depth-first walk holds at most one entry
+		 * per level, and balancing keeps even a million proxies well within
+		 * the inline entries. Deeper trees spill to the heap.
+		 */
+		template<typename T>
+		class Stack {
+		private:
+			static constexpr size_t inlineSize = 64;
+
+			T m_Inline[inlineSize];
+			std::vector<T> m_Spill;
+			size_t m_Size = 0;
+
+		public:
+			explicit Stack(const T &pFirst) { push(pFirst); }
+
+			void push(const T &pValue) {
+				if(m_Size < inlineSize) { m_Inline[m_Size] = pValue; }
+				else { m_Spill.push_back(pValue); }
+				++m_Size;
+			}
+
+			T pop() {
+				if(--m_Size < inlineSize) { return m_Inline[m_Size]; }
+
+				auto value = m_Spill.back();
+				m_Spill.pop_back();
+				return value;
+			}
+
+			[[nodiscard]] bool empty() const {
+				return m_Size == 0;
+			}
+		};
+
+		std::vector<Node> m_Nodes;
+		uint32_t m_Root = none;
+		uint32_t m_FreeList = none;
+		size_t m_ProxyCount = 0;
+		float m_Margin;
+
+		uint32_t allocateNode();
+		void freeNode(uint32_t pNode);
+		void insertLeaf(uint32_t pLeaf);
+		void removeLeaf(uint32_t pLeaf);
+		uint32_t balance(uint32_t pNode);
+		void refit(uint32_t pNode);
+
+		static bool overlaps(const aether::Bounds &pA, const aether::Bounds &pB) {
+			return pA.min.x <= pB.max.x && pA.max.x >= pB.min.x &&
+			       pA.min.y <= pB.max.y && pA.max.y >= pB.min.y &&
+			       pA.min.z <= pB.max.z && pA.max.z >= pB.min.z;
+		}
+
+	public:
+		/**
+		 * @param pMargin How far the stored boxes reach past the real ones on
+		 * every side, in world units.
+		 */
+		explicit AabbTree(float pMargin = 0.1f) : m_Margin(pMargin) {}
+
+		/**
+		 * Adds a box to the tree.
+		 *
+		 * @return A proxy that stays valid until it is destroyed.
+		 */
+		Proxy createProxy(const aether::Bounds &pBounds, void *pUserData);
+
+		void destroyProxy(Proxy pProxy);
+
+		/**
+		 * Updates the box of a proxy.
+		 *
+		 * @return Whether the leaf had to be reinserted.
+		 */
+		bool moveProxy(Proxy pProxy, const aether::Bounds &pBounds);
+
+		[[nodiscard]] void *getUserData(Proxy pProxy) const {
+			return m_Nodes[pProxy].userData;
+		}
+
+		/**
+		 * @return The enlarged box that the tree stores for a proxy.
+		 */
+		[[nodiscard]] const aether::Bounds &getFatBounds(Proxy pProxy) const {
+			return m_Nodes[pProxy].box;
+		}
+
+		[[nodiscard]] size_t size() const {
+			return m_ProxyCount;
+		}
+
+		[[nodiscard]] int32_t getHeight() const {
+			return m_Root == none ? 0 : m_Nodes[m_Root].height;
+		}
+
+		/**
+		 * @return The box that pBounds covers once moved by pMatrix.
+		 */
+		static aether::Bounds transform(const aether::Bounds &pBounds, const glm::mat4 &pMatrix);
+
+		/**
+		 * Calls pCallback(Proxy) for every proxy overlapping pBounds, until it
+		 * returns false.
+		 */
+		template<typename F>
+		void query(const aether::Bounds &pBounds, F &&pCallback) const {
+			if(m_Root == none) { return; }
+
+			Stack<uint32_t> stack(m_Root);
+			while(!stack.empty()) {
+				auto index = stack.pop();
+				const auto &node = m_Nodes[index];
+
+				if(!overlaps(node.box, pBounds)) { continue; }
+
+				if(node.isLeaf()) {
+					if(!pCallback(static_cast<Proxy>(index))) { return; }
+				} else {
+					stack.push(node.child1);
+					stack.push(node.child2);
+				}
+			}
+		}
+
+		/**
+		 * Calls pCallback(Proxy) for every proxy that is at least partly
+		 * inside pFrustum, until it returns false. Subtrees entirely inside
+		 * are reported without testing their leaves.
+		 */
+		template<typename F>
+		void query(const Frustum &pFrustum, F &&pCallback) const {
+			if(m_Root == none) { return; }
+
+			// The flag is set once a node is known to be entirely inside.
+			Stack<std::pair<uint32_t, bool>> stack({m_Root, false});
+			while(!stack.empty()) {
+				auto [index, inside] = stack.pop();
+				const auto &node = m_Nodes[index];
+
+				if(!inside) {
+					bool outside = false;
+					inside = true;
+
+					for(const auto &plane: pFrustum.planes) {
+						// The corners furthest along and against the normal.
+						glm::vec3 positive(plane.x >= 0 ? node.box.max.x : node.box.min.x,
+						                   plane.y >= 0 ? node.box.max.y : node.box.min.y,
+						                   plane.z >= 0 ? node.box.max.z : node.box.min.z);
+						glm::vec3 negative(plane.x >= 0 ? node.box.min.x : node.box.max.x,
+						                   plane.y >= 0 ? node.box.min.y : node.box.max.y,
+						                   plane.z >= 0 ? node.box.min.z : node.box.max.z);
+
+						if(plane.x * positive.x + plane.y * positive.y + plane.z * positive.z + plane.w < 0) {
+							outside = true;
+							break;
+						}
+						if(plane.x * negative.x + plane.y * negative.y + plane.z * negative.z + plane.w < 0) {
+							inside = false;
+						}
+					}
+
+					if(outside) { continue; }
+				}
+
+				if(node.isLeaf()) {
+					if(!pCallback(static_cast<Proxy>(index))) { return; }
+				} else {
+					stack.push({node.child1, inside});
+					stack.push({node.child2, inside});
+				}
+			}
+		}
+
+		/**
+		 * Walks the proxies whose boxes a ray passes through.
+		 *
+		 * pCallback(Proxy, float pDistance) is given the distance at which the
+		 * ray enters the proxy's box and returns how far along the ray to keep
+		 * searching: pMaxDistance to see every proxy, the distance of an exact
+		 * hit to narrow down to the closest one, or 0 to stop.
+		 *
+		 * @param pDirection Need not be normalised; distances are measured in
+		 * multiples of it.
+		 */
+		template<typename F>
+		void raycast(const glm::vec3 &pOrigin, const glm::vec3 &pDirection, float pMaxDistance,
+		             F &&pCallback) const {
+			if(m_Root == none) { return; }
+
+			// Division by zero gives infinities, which the slab test handles.
+			glm::vec3 inverse(1.0f / pDirection.x, 1.0f / pDirection.y, 1.0f / pDirection.z);
+			auto slabs = [&](const aether::Bounds &pBox, float pLimit, float &pEnter) {
+				float enter = 0, exit = pLimit;
+				for(int axis = 0; axis < 3; ++axis) {
+					auto t1 = (pBox.min[axis] - pOrigin[axis]) * inverse[axis];
+					auto t2 = (pBox.max[axis] - pOrigin[axis]) * inverse[axis];
+					if(t1 > t2) { std::swap(t1, t2); }
+
+					// Written so that NaN, from a zero direction on a slab
+					// boundary, keeps the box.
+					if(t1 > enter) { enter = t1; }
+					if(t2 < exit) { exit = t2; }
+					if(enter > exit) { return false; }
+				}
+
+				pEnter = enter;
+				return true;
+			};
+
+			auto limit = pMaxDistance;
+			Stack<uint32_t> stack(m_Root);
+			while(!stack.empty()) {
+				auto index = stack.pop();
+				const auto &node = m_Nodes[index];
+
+				float enter;
+				if(!slabs(node.box, limit, enter)) { continue; }
+
+				if(node.isLeaf()) {
+					limit = pCallback(static_cast<Proxy>(index), enter);
+					if(limit <= 0) { return; }
+				} else {
+					stack.push(node.child1);
+					stack.push(node.child2);
+				}
+			}
+		}
+	};
+
+} // aurora::level
+
+#endif //AURORA_AABB_TREE_H
@@ -5,12 +5,13 @@
 
 #include "controller.h"
 #include "aurora/global.h"
+#include <array>
 
 aurora::level::CameraController::CameraController(aurora::level::Level *pLevel, aurora::level::Object *pObject,
                                                   const aurora::aether::Level::Controller &pAether) : Controller(pLevel,
                                                                                                                  pObject,
                                                                                                                  pAether) {
-	auto size = global->getWindow()->getSize();
+	auto size = global->getViewportSize();
 	m_Framebuffers[0] = new Framebuffer(size.x, size.y);
 	m_Framebuffers[1] = new Framebuffer(size.x, size.y);
 	if(!pAether.properties.contains("CameraId")) { throw std::runtime_error("camera controller needs id"); }
@@ -20,8 +21,13 @@ aurora::level::CameraController::CameraController(aurora::level::Level *pLevel,
 
 aurora::level::CameraController::~CameraController() {
 	level->unregisterCamera(m_Id);
-	delete m_Framebuffers[0];
-	delete m_Framebuffers[1];
+
+	// A snapshot that is still being presented may draw into them.
+	auto framebuffers = std::array{m_Framebuffers[0], m_Framebuffers[1]};
+	level->retire([framebuffers]() {
+		delete framebuffers[0];
+		delete framebuffers[1];
+	});
 }
 
 int aurora::level::CameraController::getId() const {
@@ -10,10 +10,18 @@
 #include "level.h"
 #include "object.h"
 #include "aurora/resources/framebuffer.h"
+#include <optional>
 
 namespace aurora::level {
 
 	class Controller {
+	private:
+		friend Controller *createController(Level *, Object *, const aether::Level::Controller &);
+		friend void deleteController(Controller *);
+
+		// Null for controllers that were not created by the registry.
+		ControllerPool *m_Pool = nullptr;
+
 	protected:
 		Level *level;
 		Object *object;
@@ -27,7 +35,54 @@ namespace aurora::level {
 		virtual void render() = 0;
 		virtual void update() = 0;
 
-		virtual std::string getType() = 0;
+		/**
+		 * @return controllerTypeId<T>() of the concrete controller type.
+		 */
+		[[nodiscard]] virtual ControllerTypeId getTypeId() const = 0;
+
+		[[nodiscard]] const std::string &getType() const {
+			return getControllerTypeName(getTypeId());
+		}
+
+		/**
+		 * Exposes an interface the controller implements, such as
+		 * MeshProvider, to Object::findControllerByType().
+		 *
+		 * @return The controller as the interface with that ID, or nullptr.
+		 */
+		[[nodiscard]] virtual void *getInterface(ControllerTypeId pId) {
+			return nullptr;
+		}
+
+		/**
+		 * Parallel-safe controllers are updated from worker threads, at the
+		 * same time as the controllers of other subtrees and before any
+		 * controller that is not. Such a controller may only touch its own
+		 * object and the objects below it, and must not load assets, add or
+		 * remove objects, or use the graphics implementation or the window.
+		 */
+		[[nodiscard]] virtual bool isParallelSafe() const {
+			return false;
+		}
+
+		/**
+		 * Spatial controllers register their bounds with Level::trackBounds().
+		 * They are not rendered by their object, but by the level for each
+		 * camera whose frustum their bounds reach into.
+		 */
+		[[nodiscard]] virtual bool isSpatial() const {
+			return false;
+		}
+
+		/**
+		 * Batched controllers are updated by Level::update() from their pool,
+		 * all of one type together, and skipped by the walk over objects.
+		 * Unlike other parallel-safe controllers, they are updated last, once
+		 * the world transforms of the frame are final.
+		 */
+		[[nodiscard]] bool isBatched() const {
+			return m_Pool != nullptr && m_Pool->isBatched();
+		}
 	};
 
 	class CameraController : public Controller {
@@ -42,9 +97,14 @@ namespace aurora::level {
 		CameraController(Level *pLevel, Object *pObject, const aether::Level::Controller &pAether);
 		~CameraController() override;
 
-		virtual void preRender() {}
-
-		virtual void postRender() {}
+		/**
+		 * The colour the camera's framebuffer is cleared to before it is
+		 * drawn, if any. Read when the camera is recorded, not when it is
+		 * presented.
+		 */
+		[[nodiscard]] virtual std::optional<glm::vec3> getClearColor() const {
+			return std::nullopt;
+		}
 
 		[[nodiscard]] const glm::mat4 &getViewMatrix() const {
 			return m_ViewMatrix;
@@ -0,0 +1,63 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "controller_pool.h"
+#include <new>
+#include <stdexcept>
+
+namespace aurora::level {
+	ControllerPool::ControllerPool(size_t pSize, size_t pAlign, SlotDestructor pDestroy, BatchUpdate pBatchUpdate)
+		: m_Stride((pSize + pAlign - 1) / pAlign * pAlign), m_Align(pAlign), m_Destroy(pDestroy),
+		  m_BatchUpdate(pBatchUpdate) {
+
+	}
+
+	ControllerPool::~ControllerPool() {
+		for(const auto &item: m_Chunks) {
+			for(size_t i = 0; i < chunkSize; ++i) {
+				if(item.live[i]) { m_Destroy(item.data + i * m_Stride); }
+			}
+
+			::operator delete(item.data, std::align_val_t(m_Align));
+		}
+	}
+
+	void *ControllerPool::allocate() {
+		if(m_Free.empty()) {
+			auto data = static_cast<std::byte *>(::operator new(m_Stride * chunkSize, std::align_val_t(m_Align)));
+			m_Chunks.push_back({data});
+
+			// Handed out from the front, so a fresh chunk fills in order.
+			for(auto i = chunkSize; i > 0; --i) { m_Free.push_back(data + (i - 1) * m_Stride); }
+		}
+
+		auto slot = m_Free.back();
+		m_Free.pop_back();
+
+		liveFlag(slot) = 1;
+		++m_Size;
+		return slot;
+	}
+
+	void ControllerPool::release(void *pSlot) {
+		auto &live = liveFlag(pSlot);
+		if(!live) { throw std::runtime_error("controller slot was released twice"); }
+
+		live = 0;
+		m_Free.push_back(pSlot);
+		--m_Size;
+	}
+
+	uint8_t &ControllerPool::liveFlag(const void *pSlot) {
+		// Chunks are few, so finding the owner by address is cheap.
+		auto address = reinterpret_cast<uintptr_t>(pSlot);
+		for(auto &item: m_Chunks) {
+			auto begin = reinterpret_cast<uintptr_t>(item.data);
+			if(address >= begin && address < begin + m_Stride * chunkSize) { return item.live[(address - begin) / m_Stride]; }
+		}
+
+		throw std::runtime_error("controller was not allocated from this pool");
+	}
+} // aurora::level
@@ -0,0 +1,110 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_CONTROLLER_POOL_H
+#define AURORA_CONTROLLER_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../jobs.h"
+
+namespace aurora::level {
+
+	/**
+	 * Storage for the controllers of one type in one level.
+	 *
+	 * Controllers are placed into fixed-size chunks, so they never move and
+	 * controllers of a type sit next to each other in memory. Freed slots are
+	 * reused before a new chunk is added.
+	 */
+	class ControllerPool {
+	public:
+		static constexpr size_t chunkSize = 64;
+
+		/**
+		 * Updates every controller in the pool. Set for types that are
+		 * updated in one batch; see Controller::isBatched().
+		 */
+		using BatchUpdate = void (*)(ControllerPool &, JobSystem &);
+
+		/**
+		 * Destroys the controller in a slot, without releasing the slot.
+		 */
+		using SlotDestructor = void (*)(void *);
+
+	private:
+		struct Chunk {
+			std::byte *data;
+			uint8_t live[chunkSize]{};
+		};
+
+		size_t m_Stride;
+		size_t m_Align;
+		SlotDestructor m_Destroy;
+		BatchUpdate m_BatchUpdate;
+		std::vector<Chunk> m_Chunks;
+		std::vector<void *> m_Free;
+		size_t m_Size = 0;
+
+		uint8_t &liveFlag(const void *pSlot);
+
+	public:
+		ControllerPool(size_t pSize, size_t pAlign, SlotDestructor pDestroy, BatchUpdate pBatchUpdate);
+
+		/**
+		 * Destroys the controllers that are still in the pool.
+		 */
+		~ControllerPool();
+
+		ControllerPool(const ControllerPool &) = delete;
+		ControllerPool &operator=(const ControllerPool &) = delete;
+
+		/**
+		 * @return Uninitialised storage for one controller.
+		 */
+		void *allocate();
+
+		/**
+		 * Returns storage from allocate(). The controller in it must already
+		 * be destroyed.
+		 */
+		void release(void *pSlot);
+
+		/**
+		 * Calls pCallback(void *) for every allocated slot of chunks
+		 * [pBegin, pEnd), in memory order.
+		 */
+		template<typename F>
+		void forEach(size_t pBegin, size_t pEnd, F &&pCallback) {
+			for(auto c = pBegin; c < pEnd; ++c) {
+				const auto &chunk = m_Chunks[c];
+				for(size_t i = 0; i < chunkSize; ++i) {
+					if(chunk.live[i]) { pCallback(chunk.data + i * m_Stride); }
+				}
+			}
+		}
+
+		[[nodiscard]] bool isBatched() const {
+			return m_BatchUpdate != nullptr;
+		}
+
+		void updateBatch(JobSystem &pJobs) {
+			if(m_BatchUpdate != nullptr && m_Size > 0) { m_BatchUpdate(*this, pJobs); }
+		}
+
+		[[nodiscard]] size_t getChunkCount() const {
+			return m_Chunks.size();
+		}
+
+		[[nodiscard]] size_t size() const {
+			return m_Size;
+		}
+	};
+
+} // aurora::level
+
+#endif //AURORA_CONTROLLER_POOL_H
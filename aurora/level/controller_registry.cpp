@@ -8,46 +8,123 @@
 #include "controllers/cameras/camera_3d_controller.h"
 #include "controllers/renderer_controller.h"
 #include "controllers/mesh_asset_controller.h"
+#include <deque>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace aurora::level {
-	struct RegisteredController {
-		std::function<Controller *(Level *, Object *, const aether::Level::Controller &)> createFn;
-		std::function<void(Controller *)> deleteFn;
-	};
+	namespace {
+		struct RegisteredController {
+			size_t size = 0;
+			size_t align = 0;
+			ControllerConstructor createFn = nullptr;
+			ControllerDestructor deleteFn = nullptr;
+			ControllerPool::SlotDestructor destroySlotFn = nullptr;
+			ControllerPool::BatchUpdate batchUpdate = nullptr;
+		};
 
-	std::unordered_map<std::string, RegisteredController> registeredControllers;
+		// Interning may happen from update jobs, the first time a type is
+		// looked up there.
+		std::mutex typeMutex;
+		std::unordered_map<std::string, ControllerTypeId> typeIds;
+		// A deque, as getControllerTypeName() hands out references that have
+		// to survive later names being added.
+		std::deque<std::string> typeNames;
 
-	void registerController(const std::string &pType,
-	                        const std::function<
-		                        Controller *(Level *, Object *, const aether::Level::Controller &)> &pConstruct,
-	                        const std::function<void(Controller *)> &pDelete) {
-		registeredControllers.insert({
-			                             pType,
-			                             {
-				                             pConstruct,
-				                             pDelete
-			                             }});
+		// Indexed by type ID.
+		std::vector<RegisteredController> registeredControllers;
+		bool initialized = false;
+
+		// A game may have registered its own controller under a built-in
+		// type name before the registry was initialised; that one is kept.
+		template<typename T>
+		void registerBuiltin() {
+			auto id = controllerTypeId<T>();
+			if(id < registeredControllers.size() && registeredControllers[id].createFn != nullptr) { return; }
+			registerController<T>();
+		}
+	}
+
+	ControllerTypeId internControllerType(const std::string &pType) {
+		std::lock_guard lock(typeMutex);
+
+		auto it = typeIds.find(pType);
+		if(it != typeIds.end()) { return it->second; }
+
+		if(typeNames.size() >= noControllerType) { throw std::runtime_error("too many controller types"); }
+
+		auto id = static_cast<ControllerTypeId>(typeNames.size());
+		typeNames.push_back(pType);
+		typeIds.emplace(pType, id);
+		return id;
+	}
+
+	ControllerTypeId findControllerType(const std::string &pType) {
+		std::lock_guard lock(typeMutex);
+
+		auto it = typeIds.find(pType);
+		return it != typeIds.end() ? it->second : noControllerType;
+	}
+
+	const std::string &getControllerTypeName(ControllerTypeId pId) {
+		std::lock_guard lock(typeMutex);
+		return typeNames.at(pId);
+	}
+
+	ControllerTypeId registerController(const std::string &pType, size_t pSize, size_t pAlign,
+	                                    ControllerConstructor pConstruct, ControllerDestructor pDelete,
+	                                    ControllerPool::SlotDestructor pDestroySlot,
+	                                    ControllerPool::BatchUpdate pBatchUpdate) {
+		auto id = internControllerType(pType);
+
+		if(registeredControllers.size() <= id) { registeredControllers.resize(id + 1); }
+		registeredControllers[id] = {pSize, pAlign, pConstruct, pDelete, pDestroySlot, pBatchUpdate};
+		return id;
 	}
 
 	Controller *createController(Level *pLevel, Object *pObject, const aether::Level::Controller &pAether) {
-		if(registeredControllers.empty()) { initializeRegistry(); }
-		if(!registeredControllers.contains(pAether.type)) {
+		if(!initialized) { initializeRegistry(); }
+
+		auto id = findControllerType(pAether.type);
+		if(id >= registeredControllers.size() || registeredControllers[id].createFn == nullptr) {
 			throw std::runtime_error("Controller registry does not contain: " + pAether.type);
 		}
-		return registeredControllers.at(pAether.type).createFn(pLevel, pObject, pAether);
+
+		const auto &entry = registeredControllers[id];
+		auto &pool = pLevel->getControllerPool(id, entry.size, entry.align, entry.destroySlotFn,
+		                                       entry.batchUpdate);
+		auto slot = pool.allocate();
+
+		Controller *controller;
+		try {
+			controller = entry.createFn(slot, pLevel, pObject, pAether);
+		} catch(...) {
+			pool.release(slot);
+			throw;
+		}
+
+		controller->m_Pool = &pool;
+		return controller;
 	}
 
 	void deleteController(Controller *pController) {
-		registeredControllers.at(pController->getType()).deleteFn(pController);
+		auto pool = pController->m_Pool;
+		if(pool == nullptr) {
+			delete pController;
+			return;
+		}
+
+		const auto &entry = registeredControllers.at(pController->getTypeId());
+		pool->release(entry.deleteFn(pController));
 	}
 
 	void initializeRegistry() {
-		registeredControllers.clear();
+		initialized = true;
 
-		registerController<Camera2DController>();
-		registerController<Camera3DController>();
-		registerController<MeshAssetController>();
-		registerController<RendererController>();
+		registerBuiltin<Camera2DController>();
+		registerBuiltin<Camera3DController>();
+		registerBuiltin<MeshAssetController>();
+		registerBuiltin<RendererController>();
 	}
 }
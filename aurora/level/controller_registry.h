@@ -5,9 +5,11 @@
 #ifndef AURORA_CONTROLLER_REGISTRY_H
 #define AURORA_CONTROLLER_REGISTRY_H
 
+#include <cstdint>
+#include <new>
 #include <string>
-#include <functional>
 #include "../aether/aether.h"
+#include "controller_pool.h"
 
 namespace aurora::level {
 	class Controller;
@@ -16,22 +18,101 @@ namespace aurora::level {
 
 	class Object;
 
-	void registerController(const std::string &pType,
-	                        const std::function<
-		                        Controller *(Level *, Object *, const aether::Level::Controller &)> &pConstruct,
-	                        const std::function<void(Controller *)> &pDelete);
+	/**
+	 * A controller type name interned into a small integer. IDs are handed
+	 * out from zero in the order that names are first seen, so they can
+	 * index flat tables.
+	 */
+	using ControllerTypeId = uint16_t;
+
+	constexpr ControllerTypeId noControllerType = UINT16_MAX;
+
+	/**
+	 * Constructs a controller into storage from a ControllerPool.
+	 */
+	using ControllerConstructor = Controller *(*)(void *, Level *, Object *, const aether::Level::Controller &);
+
+	/**
+	 * Destroys a controller in place.
+	 *
+	 * @return The storage it was constructed into.
+	 */
+	using ControllerDestructor = void *(*)(Controller *);
+
+	/**
+	 * @return The ID of a type name, assigning the next free one if it has
+	 * none yet.
+	 */
+	ControllerTypeId internControllerType(const std::string &pType);
+
+	/**
+	 * @return The ID of a type name, or noControllerType if it was never
+	 * interned.
+	 */
+	ControllerTypeId findControllerType(const std::string &pType);
+
+	const std::string &getControllerTypeName(ControllerTypeId pId);
+
+	/**
+	 * @return The ID of T::type, interned on the first call.
+	 */
+	template<typename T>
+	ControllerTypeId controllerTypeId() {
+		static const ControllerTypeId id = internControllerType(T::type);
+		return id;
+	}
+
+	ControllerTypeId registerController(const std::string &pType, size_t pSize, size_t pAlign,
+	                                    ControllerConstructor pConstruct, ControllerDestructor pDelete,
+	                                    ControllerPool::SlotDestructor pDestroySlot,
+	                                    ControllerPool::BatchUpdate pBatchUpdate);
+
+	/**
+	 * Creates a controller in the level's pool for its type.
+	 */
 	Controller *createController(Level *pLevel, Object *pObject, const aether::Level::Controller &pAether);
+
+	/**
+	 * Destroys a controller and returns its storage to its pool. Controllers
+	 * that were made with new are deleted.
+	 */
 	void deleteController(Controller *pController);
 
+	/**
+	 * Registers T under T::type.
+	 *
+	 * A type that declares `static constexpr bool batchUpdate = true;` is
+	 * updated in one batch per level and frame, walking its pool chunk by
+	 * chunk on the job system, once every object has updated and the world
+	 * transforms are final. Its update() must be parallel-safe and must not
+	 * depend on the order in which controllers are updated.
+	 */
 	template<typename T>
 	void registerController() {
-		registerController(T::type, [](Level *pLevel, Object *pObject, const aether::Level::Controller &pAether) {
-			return new T(pLevel, pObject, pAether);
-		}, [](Controller *pPointer) {
-			delete dynamic_cast<T *>(pPointer);
-		});
+		ControllerPool::BatchUpdate batch = nullptr;
+		if constexpr(requires { requires T::batchUpdate; }) {
+			batch = [](ControllerPool &pPool, JobSystem &pJobs) {
+				pJobs.parallelFor(pPool.getChunkCount(), 1, [&pPool](size_t pBegin, size_t pEnd) {
+					// Qualified, so the call is bound statically.
+					pPool.forEach(pBegin, pEnd, [](void *pSlot) { static_cast<T *>(pSlot)->T::update(); });
+				});
+			};
+		}
+
+		registerController(T::type, sizeof(T), alignof(T),
+		                   [](void *pSlot, Level *pLevel, Object *pObject, const aether::Level::Controller &pAether) {
+			                   return static_cast<Controller *>(new(pSlot) T(pLevel, pObject, pAether));
+		                   }, [](Controller *pPointer) {
+				auto controller = static_cast<T *>(pPointer);
+				controller->~T();
+				return static_cast<void *>(controller);
+			}, [](void *pSlot) { static_cast<T *>(pSlot)->~T(); }, batch);
 	}
 
+	/**
+	 * Registers the built-in controllers, leaving any controller that was
+	 * already registered alone. Called by the first createController().
+	 */
 	void initializeRegistry();
 }
 
@@ -29,7 +29,7 @@ namespace aurora::level {
 	void Camera2DController::render() {}
 
 	void Camera2DController::update() {
-		auto size = global->getWindow()->getSize();
+		auto size = global->getViewportSize();
 		if(m_LastPosition != object->getPosition() ||
 		   m_LastRotation != object->getRotation() ||
 		   size != m_Size) {
@@ -38,14 +38,14 @@ namespace aurora::level {
 		}
 	}
 
-	std::string Camera2DController::getType() {
-		return type;
+	ControllerTypeId Camera2DController::getTypeId() const {
+		return controllerTypeId<Camera2DController>();
 	}
 
 	void Camera2DController::updateMatrices() {
-		if(!global->getWindow()->isReallyVisible()) return;
+		if(!global->isViewportVisible()) return;
 
-		auto wSize = global->getWindow()->getSize();
+		auto wSize = global->getViewportSize();
 		auto t = m_Scale;
 		auto r = ((float) wSize.x / (float) wSize.y) * m_Scale;
 		setPerspectiveMatrix(glm::ortho(-r, r, -t, t, 0.001f, 100.f));
@@ -55,8 +55,7 @@ namespace aurora::level {
 		m_LastPosition = object->getPosition();
 	}
 
-	void Camera2DController::preRender() {
-		CameraController::preRender();
-		global->getGraphics()->clear(m_ClearColor.r, m_ClearColor.g, m_ClearColor.b);
+	std::optional<glm::vec3> Camera2DController::getClearColor() const {
+		return m_ClearColor;
 	}
 } // aurora::level
\ No newline at end of file
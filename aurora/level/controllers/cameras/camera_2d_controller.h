@@ -30,8 +30,8 @@ namespace aurora::level {
 		void updateMatrices();
 		void render() override;
 		void update() override;
-		std::string getType() override;
-		void preRender() override;
+		[[nodiscard]] ControllerTypeId getTypeId() const override;
+		[[nodiscard]] std::optional<glm::vec3> getClearColor() const override;
 	};
 
 } // aurora::level
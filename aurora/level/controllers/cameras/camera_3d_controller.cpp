@@ -35,19 +35,19 @@ namespace aurora::level {
 	void Camera3DController::update() {
 		if(m_LastPosition != object->getPosition() ||
 		   m_LastRotation != object->getRotation() ||
-		   global->getWindow()->getSize() != m_Size) {
+		   global->getViewportSize() != m_Size) {
 			updateMatrices();
 		}
 	}
 
-	std::string Camera3DController::getType() {
-		return type;
+	ControllerTypeId Camera3DController::getTypeId() const {
+		return controllerTypeId<Camera3DController>();
 	}
 
 	void Camera3DController::updateMatrices() {
-		if(!global->getWindow()->isReallyVisible()) return;
+		if(!global->isViewportVisible()) return;
 
-		auto wSize = global->getWindow()->getSize();
+		auto wSize = global->getViewportSize();
 		auto height = m_Scale;
 		auto width = ((float) wSize.x / (float) wSize.y) * m_Scale;
 		setPerspectiveMatrix(glm::perspectiveFov(m_FieldOfView, width, height, 0.001f, 100.f));
@@ -58,8 +58,7 @@ namespace aurora::level {
 		m_Size = wSize;
 	}
 
-	void Camera3DController::preRender() {
-		CameraController::preRender();
-		global->getGraphics()->clear(m_ClearColor.r, m_ClearColor.g, m_ClearColor.b);
+	std::optional<glm::vec3> Camera3DController::getClearColor() const {
+		return m_ClearColor;
 	}
 } // aurora::level
\ No newline at end of file
@@ -11,25 +11,44 @@ namespace aurora::level {
 	MeshAssetController::MeshAssetController(Level *pLevel, Object *pObject,
 	                                         const aether::Level::Controller &pAether) : Controller(pLevel, pObject,
 	                                                                                                pAether) {
-		if(!pAether.properties.contains("AssetId")) {
-			throw std::runtime_error("AssetId must be provided on aurora:mesh");
+		if(pAether.properties.contains("CompiledAssetId")) {
+			m_CompiledMesh = global->getAssetLoader()->load<aether::CompiledMesh>(
+				pAether.properties.at("CompiledAssetId"));
+		} else if(pAether.properties.contains("AssetId")) {
+			m_Mesh = global->getAssetLoader()->load<aether::Mesh>(pAether.properties.at("AssetId"));
+		} else {
+			throw std::runtime_error("AssetId or CompiledAssetId must be provided on aurora:mesh");
 		}
-		m_Mesh = global->getAssetLoader()->load<aether::Mesh>(pAether.properties.at("AssetId"));
 	}
 
 	MeshAssetController::~MeshAssetController() {
-		global->getAssetLoader()->unload<aether::Mesh>(m_Mesh);
+		if(m_Mesh != nullptr) { global->getAssetLoader()->unload<aether::Mesh>(m_Mesh); }
+		if(m_CompiledMesh != nullptr) { global->getAssetLoader()->unload<aether::CompiledMesh>(m_CompiledMesh); }
 	}
 
 	void MeshAssetController::render() {}
 
+	// The mesh is loaded once and never changes, so there is nothing to do.
 	void MeshAssetController::update() {}
 
-	std::string MeshAssetController::getType() {
-		return type;
+	ControllerTypeId MeshAssetController::getTypeId() const {
+		return controllerTypeId<MeshAssetController>();
 	}
 
-	aether::Mesh MeshAssetController::getMesh() {
+	void *MeshAssetController::getInterface(ControllerTypeId pId) {
+		return pId == controllerTypeId<MeshProvider>() ? static_cast<MeshProvider *>(this) : nullptr;
+	}
+
+	const aether::Mesh &MeshAssetController::getMesh() {
+		if(m_Mesh == nullptr) { throw std::runtime_error("aurora:mesh only has a compiled mesh"); }
 		return *m_Mesh;
 	}
+
+	const aether::CompiledMesh *MeshAssetController::getCompiledMesh() {
+		return m_CompiledMesh;
+	}
+
+	aether::Bounds MeshAssetController::getBounds() {
+		return m_CompiledMesh != nullptr ? m_CompiledMesh->getBounds() : m_Mesh->bounds;
+	}
 } // aurora::level
\ No newline at end of file
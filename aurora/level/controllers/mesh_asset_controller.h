@@ -12,7 +12,8 @@ namespace aurora::level {
 
 	class MeshAssetController : public Controller, public MeshProvider {
 	private:
-		aether::Mesh *m_Mesh;
+		aether::Mesh *m_Mesh = nullptr;
+		aether::CompiledMesh *m_CompiledMesh = nullptr;
 
 	public:
 		static const std::string type;
@@ -22,8 +23,15 @@ namespace aurora::level {
 
 		void render() override;
 		void update() override;
-		std::string getType() override;
-		aether::Mesh getMesh() override;
+		[[nodiscard]] ControllerTypeId getTypeId() const override;
+		[[nodiscard]] void *getInterface(ControllerTypeId pId) override;
+
+		[[nodiscard]] bool isParallelSafe() const override {
+			return true;
+		}
+		const aether::Mesh &getMesh() override;
+		const aether::CompiledMesh *getCompiledMesh() override;
+		aether::Bounds getBounds() override;
 	};
 
 } // aurora::level
@@ -6,54 +6,110 @@
 #include "aurora/global.h"
 
 namespace aurora::level {
+	const std::string MeshProvider::type = "aurora:mesh-provider";
+
 	const std::string RendererController::type = "aurora:renderer";
 
 	RendererController::RendererController(Level *pLevel, Object *pObject, const aether::Level::Controller &pAether)
 		: Controller(pLevel, pObject, pAether) {
-		auto mesh = object->findControllerByType<MeshProvider>()->getMesh();
+		auto provider = object->findControllerByType<MeshProvider>();
+		if(provider == nullptr) { throw std::runtime_error("RendererController needs a MeshProvider on its object"); }
 		if(!pAether.properties.contains("ShaderAssetId")) {
 			throw std::runtime_error("RendererController does not have ShaderAssetId property");
 		}
 		m_Shader = global->getAssetLoader()->load<Shader>(pAether.properties.at("ShaderAssetId"));
-		aether::OptimisedMesh opt(mesh, m_Shader->getAether());
-
-		m_VertexBuffer = new Buffer(VertexBuffer);
-		m_IndexBuffer = new Buffer(IndexBuffer);
-		m_VertexBuffer->update(opt.vertexData.data(), opt.vertexData.size() * sizeof(float));
-		m_IndexBuffer->update(opt.indexData.data(), opt.indexData.size() * sizeof(uint32_t));
-
-		m_DrawObject = new DrawObject(DrawObjectOptions{
-			.shader = m_Shader->getReference(),
-			.vertexBuffer = m_VertexBuffer->getReference(),
-			.indexBuffer = m_IndexBuffer->getReference(),
-			.vertexCount = static_cast<uint32_t>(opt.indexData.size()),
-			.indexBufferItemType = IndexBufferItemType::UnsignedInt,
-			.arrangement = m_Shader->getArrangement(),
-		});
+
+		// The destructor does not run for a constructor that throws, so what
+		// was taken so far is given back here.
+		try {
+			m_Geometry = acquireGeometry(provider);
+			m_Proxy = level->trackBounds(this, object, m_Geometry->bounds);
+			m_ObjectMatrix = object->getObjectMatrix();
+		} catch(...) {
+			if(m_Geometry != nullptr) { level->getGeometryCache().release(m_Geometry); }
+			global->getAssetLoader()->unload(m_Shader);
+			throw;
+		}
+	}
+
+	GeometryCache::Geometry *RendererController::acquireGeometry(MeshProvider *pProvider) {
+		auto &cache = level->getGeometryCache();
+		auto compiled = pProvider->getCompiledMesh();
+		auto key = m_Shader->getAether().id + '\n' + (compiled ? compiled->id : pProvider->getMesh().id);
+
+		auto geometry = cache.acquire(key);
+		if(geometry != nullptr) { return geometry; }
+
+		auto &heap = cache.getMeshHeap();
+		MeshHeap::Allocation allocation;
+		uint32_t indexCount;
+		IndexBufferItemType indexType;
+
+		if(compiled) {
+			if(!compiled->matches(m_Shader->getAether())) {
+				throw std::runtime_error("compiled mesh " + compiled->id + " was built for a different vertex layout");
+			}
+
+			// Already interleaved by ameshc; goes straight to the heap.
+			allocation = heap.allocate(compiled->getVertexData(), compiled->getVertexDataSize(),
+			                           compiled->header.vertexStride, compiled->getIndexData(),
+			                           compiled->getIndexDataSize());
+			indexCount = compiled->header.indexCount;
+			indexType = compiled->header.indexSize == sizeof(uint16_t)
+			            ? IndexBufferItemType::UnsignedShort
+			            : IndexBufferItemType::UnsignedInt;
+		} else {
+			aether::OptimisedMesh opt(pProvider->getMesh(), m_Shader->getAether());
+
+			// OptimisedMesh only writes float inputs.
+			size_t stride = 0;
+			for(const auto &node: m_Shader->getAether().vertexNodes) {
+				stride += node.size * sizeof(float);
+			}
+
+			allocation = heap.allocate(opt.vertexData.data(), opt.vertexData.size() * sizeof(float), stride,
+			                           opt.indexData.data(), opt.indexData.size() * sizeof(uint32_t));
+			indexCount = static_cast<uint32_t>(opt.indexData.size());
+			indexType = IndexBufferItemType::UnsignedInt;
+		}
+
+		DrawObject *drawObject;
+		try {
+			drawObject = heap.createDrawObject(allocation, DrawObjectOptions{
+				.shader = m_Shader->getReference(),
+				.vertexCount = indexCount,
+				.indexBufferItemType = indexType,
+				.arrangement = m_Shader->getArrangement(),
+			});
+		} catch(...) {
+			heap.free(allocation);
+			throw;
+		}
+
+		return cache.insert(key, allocation, drawObject, pProvider->getBounds());
 	}
 
 	void RendererController::render() {
-		auto camera = level->getCurrentCameraController();
-		m_DrawObject->draw(MatrixSet{
-			object->getObjectMatrix(),
-			camera->getViewMatrix(),
-			camera->getPerspectiveMatrix()
-		});
+		level->getRenderQueue().submit(m_Geometry->drawObject->getReference(), m_ObjectMatrix, m_Geometry->bounds);
 	}
 
 	void RendererController::update() {
-
+		m_ObjectMatrix = object->getObjectMatrix();
 	}
 
-	std::string RendererController::getType() {
-		return std::string();
+	ControllerTypeId RendererController::getTypeId() const {
+		return controllerTypeId<RendererController>();
 	}
 
 	RendererController::~RendererController() {
-		delete m_DrawObject;
-		delete m_VertexBuffer;
-		delete m_IndexBuffer;
-		global->getAssetLoader()->unload<Shader>(m_Shader);
+		level->untrackBounds(m_Proxy);
+
+		// A snapshot that is still to be presented may draw the geometry, and
+		// its draw object refers to the shader.
+		level->retire([level = level, geometry = m_Geometry, shader = m_Shader]() {
+			level->getGeometryCache().release(geometry);
+			global->getAssetLoader()->unload(shader);
+		});
 	}
 
 } // aurora::level
@@ -9,31 +9,78 @@
 
 #include "../../aether/aether.h"
 #include "../../resources/shader.h"
-#include "../../resources/buffer.h"
 #include "../../resources/draw_object.h"
+#include "../../resources/mesh_heap.h"
+#include "../geometry_cache.h"
 
 namespace aurora::level {
 
 	class MeshProvider {
 	public:
-		virtual aether::Mesh getMesh() = 0;
+		static const std::string type;
+
+		virtual ~MeshProvider() = default;
+
+		/**
+		 * @throws std::runtime_error The provider only holds a compiled mesh.
+		 */
+		virtual const aether::Mesh &getMesh() = 0;
+
+		/**
+		 * @return A mesh that was already compiled for a shader layout, or
+		 * nullptr when only the source mesh is available.
+		 */
+		virtual const aether::CompiledMesh *getCompiledMesh() { return nullptr; }
+
+		/**
+		 * @return Bounds of the mesh in object space, used for culling.
+		 */
+		virtual aether::Bounds getBounds() = 0;
 	};
 
+	/**
+	 * Draws the mesh of its object's MeshProvider with a shader.
+	 *
+	 * Renderers using the same mesh and shader share their GPU geometry and
+	 * draw object, which lets the render queue draw all of them with one
+	 * instanced call.
+	 *
+	 * The geometry is kept in the level's GeometryCache, which packs every
+	 * mesh into one MeshHeap, so a level with thousands of distinct meshes
+	 * still uses a few buffers.
+	 *
+	 * Renderers draw their object where the last Level::update() left it.
+	 */
 	class RendererController : public Controller {
 	private:
-		aether::Mesh m_Mesh;
 		Shader *m_Shader;
-		Buffer *m_VertexBuffer, *m_IndexBuffer;
-		DrawObject *m_DrawObject;
+		GeometryCache::Geometry *m_Geometry = nullptr;
+		AabbTree::Proxy m_Proxy = AabbTree::none;
+
+		// Where the object was at the end of the last update, so that
+		// recording reads the renderers one after another rather than the
+		// transform store.
+		glm::mat4 m_ObjectMatrix;
+
+		GeometryCache::Geometry *acquireGeometry(MeshProvider *pProvider);
 
 	public:
 		static const std::string type;
+		static constexpr bool batchUpdate = true;
 
 		RendererController(Level *pLevel, Object *pObject, const aether::Level::Controller &pAether);
 		~RendererController() override;
 		void render() override;
 		void update() override;
-		std::string getType() override;
+		[[nodiscard]] ControllerTypeId getTypeId() const override;
+
+		[[nodiscard]] bool isParallelSafe() const override {
+			return true;
+		}
+
+		[[nodiscard]] bool isSpatial() const override {
+			return true;
+		}
 	};
 
 } // aurora::level
@@ -0,0 +1,80 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_FRAME_SNAPSHOT_H
+#define AURORA_FRAME_SNAPSHOT_H
+
+#include "../graphics/render_queue.h"
+#include "../resources/framebuffer.h"
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace aurora::level {
+
+	/**
+	 * Everything needed to draw one frame of a level, copied out of it so
+	 * that the frame can be drawn while the level moves on to the next.
+	 *
+	 * Draw objects and framebuffers are referenced, not copied. Their owners
+	 * hand them to Level::retire() instead of destroying them, and the next
+	 * snapshot recorded takes them over, so that they outlive every snapshot
+	 * that refers to them.
+	 */
+	struct FrameSnapshot {
+		struct Pass {
+			Framebuffer *framebuffer;
+			std::optional<glm::vec3> clearColor;
+			glm::mat4 view;
+			glm::mat4 perspective;
+			size_t firstPacket;
+			size_t packetCount;
+		};
+
+		std::vector<Pass> passes;
+		std::vector<RenderQueue::Packet> packets;
+
+		/**
+		 * How far the frame lies between the last tick and the next; see
+		 * Application::render().
+		 */
+		float alpha = 0;
+
+		/**
+		 * Seconds of simulation time at the frame, counting the fraction of
+		 * a tick given by alpha.
+		 */
+		float time = 0;
+
+		/**
+		 * What was handed to Level::retire() up to the recording of this
+		 * snapshot. Earlier snapshots may still draw it, but this one does
+		 * not, so it is destroyed once this one has been presented or
+		 * dropped. Left alone by clear().
+		 */
+		std::vector<std::function<void()>> retired;
+
+		void clear() {
+			passes.clear();
+			packets.clear();
+			alpha = 0;
+			time = 0;
+		}
+
+		/**
+		 * Destroys what the snapshot took over from Level::retire(). Must run
+		 * on the context thread, after the snapshot and every one before it
+		 * have been presented or dropped.
+		 */
+		void destroyRetired() {
+			auto items = std::move(retired);
+			retired.clear();
+			for(const auto &item: items) { item(); }
+		}
+	};
+
+} // aurora::level
+
+#endif //AURORA_FRAME_SNAPSHOT_H
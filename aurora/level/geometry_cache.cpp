@@ -0,0 +1,51 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "geometry_cache.h"
+
+namespace aurora::level {
+	GeometryCache::~GeometryCache() {
+		for(const auto &item: m_Geometry) {
+			delete item.second->drawObject;
+			delete item.second;
+		}
+
+		delete m_MeshHeap;
+	}
+
+	GeometryCache::Geometry *GeometryCache::acquire(const std::string &pKey) {
+		auto iter = m_Geometry.find(pKey);
+		if(iter == m_Geometry.end()) { return nullptr; }
+
+		++iter->second->refs;
+		return iter->second;
+	}
+
+	GeometryCache::Geometry *GeometryCache::insert(const std::string &pKey, const MeshHeap::Allocation &pAllocation,
+	                                               DrawObject *pDrawObject, const aether::Bounds &pBounds) {
+		auto geometry = new Geometry{pKey, pAllocation, pDrawObject, pBounds, 1};
+		m_Geometry.emplace(pKey, geometry);
+		return geometry;
+	}
+
+	void GeometryCache::release(Geometry *pGeometry) {
+		if(--pGeometry->refs > 0) { return; }
+
+		m_Geometry.erase(pGeometry->key);
+		delete pGeometry->drawObject;
+		m_MeshHeap->free(pGeometry->allocation);
+		delete pGeometry;
+
+		if(m_Geometry.empty()) {
+			delete m_MeshHeap;
+			m_MeshHeap = nullptr;
+		}
+	}
+
+	MeshHeap &GeometryCache::getMeshHeap() {
+		if(m_MeshHeap == nullptr) { m_MeshHeap = new MeshHeap; }
+		return *m_MeshHeap;
+	}
+} // aurora::level
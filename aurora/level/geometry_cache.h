@@ -0,0 +1,75 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_GEOMETRY_CACHE_H
+#define AURORA_GEOMETRY_CACHE_H
+
+#include "../aether/aether.h"
+#include "../resources/draw_object.h"
+#include "../resources/mesh_heap.h"
+#include <string>
+#include <unordered_map>
+
+namespace aurora::level {
+
+	/**
+	 * The GPU geometry of the meshes drawn in a level, shared by everything
+	 * that draws the same mesh with the same shader. The geometry itself is
+	 * packed into one MeshHeap.
+	 *
+	 * Only used on the context thread.
+	 */
+	class GeometryCache {
+	public:
+		struct Geometry {
+			std::string key;
+			MeshHeap::Allocation allocation;
+			DrawObject *drawObject;
+			aether::Bounds bounds;
+			int refs = 0;
+		};
+
+	private:
+		std::unordered_map<std::string, Geometry *> m_Geometry;
+
+		// Created with the first geometry and destroyed with the last.
+		MeshHeap *m_MeshHeap = nullptr;
+
+	public:
+		GeometryCache() = default;
+		virtual ~GeometryCache();
+
+		GeometryCache(const GeometryCache &) = delete;
+		GeometryCache &operator=(const GeometryCache &) = delete;
+
+		/**
+		 * Takes a reference to the geometry stored under a key.
+		 *
+		 * @return The geometry, or nullptr when there is none yet.
+		 */
+		Geometry *acquire(const std::string &pKey);
+
+		/**
+		 * Stores new geometry under a key, with one reference taken. The
+		 * cache takes ownership of the draw object and the allocation, which
+		 * has to come from getMeshHeap().
+		 */
+		Geometry *insert(const std::string &pKey, const MeshHeap::Allocation &pAllocation, DrawObject *pDrawObject,
+		                 const aether::Bounds &pBounds);
+
+		/**
+		 * Drops a reference, destroying the geometry with the last one.
+		 */
+		void release(Geometry *pGeometry);
+
+		/**
+		 * The heap that geometry is allocated from before insert().
+		 */
+		MeshHeap &getMeshHeap();
+	};
+
+} // aurora::level
+
+#endif //AURORA_GEOMETRY_CACHE_H
@@ -7,7 +7,8 @@
 #include "object.h"
 #include "controller.h"
 #include "aurora/global.h"
-#include <fstream>
+#include "aurora/aether/profiler.h"
+#include <algorithm>
 
 namespace aurora::level {
 	Level::Level() {
@@ -15,11 +16,21 @@ namespace aurora::level {
 	}
 
 	Level::~Level() {
+		// Objects take their children and controllers with them. Whatever is
+		// left in the pools is destroyed next, while the spatial index and
+		// the tracked bounds that controllers give back are still alive.
+		// Each object takes itself out of m_Objects, newest first.
+		while(!m_Objects.empty()) {
+			delete m_Objects.back();
+		}
 
+		m_ControllerPools.clear();
+		destroyRetired();
+		m_Snapshot.destroyRetired();
 	}
 
-	Level::Level(AssetLoader *, const std::filesystem::path &pPath, const std::string &)
-		: Level(aether::Level(nlohmann::json::from_cbor(std::ifstream(pPath)))) {
+	Level::Level(AssetLoader *, const aether::AssetSource &pSource, const std::string &)
+		: Level(aether::Level(pSource.readCbor())) {
 
 	}
 
@@ -39,38 +50,212 @@ namespace aurora::level {
 
 	Level::Level(const aether::Level &pAether) {
 		for(const auto &item: pAether.objects) {
-			m_Objects.emplace_back(parseObject(this, item.second, nullptr));
+			addRoot(parseObject(this, item.second, nullptr));
+		}
+	}
+
+	void Level::addRoot(Object *pObject) {
+		if(std::find(m_Objects.begin(), m_Objects.end(), pObject) == m_Objects.end()) {
+			m_Objects.push_back(pObject);
 		}
 	}
 
+	void Level::removeRoot(Object *pObject) {
+		// Searched from the back, as roots are mostly deleted newest first.
+		auto it = std::find(m_Objects.rbegin(), m_Objects.rend(), pObject);
+		if(it != m_Objects.rend()) { m_Objects.erase(std::next(it).base()); }
+	}
+
 	void Level::render() {
+		m_Snapshot.clear();
+		record(m_Snapshot);
+		present(m_Snapshot);
+		m_Snapshot.destroyRetired();
+	}
+
+	void Level::record(FrameSnapshot &pSnapshot) {
 		if(m_CurrentCamera >= 0) {
+			record(m_CurrentCamera, pSnapshot);
+		} else {
+			takeRetired(pSnapshot);
+		}
+	}
+
+	void Level::record(int pCameraId, FrameSnapshot &pSnapshot) {
+		AURORA_PROFILE_ZONE("Level::record");
+		auto cont = m_Cameras.at(pCameraId);
+		auto framebuffer = cont->getCurrentFramebuffer();
+		auto clearColor = cont->getClearColor();
+		m_RenderQueue.begin(cont->getViewMatrix(), cont->getPerspectiveMatrix());
+
+		for(const auto &item: m_Objects) {
+			item->render();
+		}
+
+		m_Spatial.query(m_RenderQueue.getFrustum(), [this](AabbTree::Proxy pProxy) {
+			static_cast<Controller *>(m_Spatial.getUserData(pProxy))->render();
+			return true;
+		});
+
+		const auto &packets = m_RenderQueue.getPackets();
+		pSnapshot.passes.push_back({
+			                           framebuffer,
+			                           clearColor,
+			                           m_RenderQueue.getViewMatrix(),
+			                           m_RenderQueue.getPerspectiveMatrix(),
+			                           pSnapshot.packets.size(),
+			                           packets.size()
+		                           });
+		pSnapshot.packets.insert(pSnapshot.packets.end(), packets.begin(), packets.end());
+		m_RenderQueue.clear();
+
+		// Taken last, so that anything retired while recording is kept
+		// alive for this snapshot too.
+		takeRetired(pSnapshot);
+	}
+
+	void Level::present(const FrameSnapshot &pSnapshot) {
+		AURORA_PROFILE_ZONE("Level::present");
+		Framebuffer *last = nullptr;
+		for(const auto &item: pSnapshot.passes) {
+			last = presentPass(pSnapshot, item);
+		}
+
+		if(last != nullptr) {
 			auto defaultFb = Framebuffer::getDefault();
-			renderCamera(m_CurrentCamera)->blit(defaultFb);
+			last->blit(defaultFb);
 			delete defaultFb;
 		}
 	}
 
+	void Level::retire(std::function<void()> pDestroy) {
+		std::lock_guard lock(m_RetiredMutex);
+		m_Retired.emplace_back(std::move(pDestroy));
+	}
+
+	void Level::takeRetired(FrameSnapshot &pSnapshot) {
+		std::lock_guard lock(m_RetiredMutex);
+		for(auto &item: m_Retired) { pSnapshot.retired.push_back(std::move(item)); }
+		m_Retired.clear();
+	}
+
+	void Level::destroyRetired() {
+		std::vector<std::function<void()>> retired;
+
+		{
+			std::lock_guard lock(m_RetiredMutex);
+			retired.swap(m_Retired);
+		}
+
+		for(const auto &item: retired) { item(); }
+	}
+
+	Framebuffer *Level::presentPass(const FrameSnapshot &pSnapshot, const FrameSnapshot::Pass &pPass) {
+		global->getImpl()->activateFramebuffer(pPass.framebuffer->getReference());
+		if(auto color = pPass.clearColor) { global->getGraphics()->clear(color->r, color->g, color->b); }
+
+		m_PresentQueue.begin(pPass.view, pPass.perspective, pSnapshot.time);
+		m_PresentQueue.execute(pSnapshot.packets.data() + pPass.firstPacket, pPass.packetCount);
+		return pPass.framebuffer;
+	}
+
 	void Level::update() {
-		for(const auto &item: m_Objects) {
-			item->update();
+		AURORA_PROFILE_ZONE("Level::update");
+
+		// Jobs may read the world transforms of objects above their subtree.
+		// Everything is resolved first, and the store is read-only while jobs
+		// run, so that those reads never write.
+		m_Transforms.update();
+		m_Transforms.setReadOnly(true);
+
+		auto jobs = global->getJobs();
+		try {
+			auto grain = std::max<size_t>(1, m_Objects.size() / ((jobs->getWorkerCount() + 1) * 4));
+			jobs->parallelFor(m_Objects.size(), grain, [this, jobs](size_t pBegin, size_t pEnd) {
+				for(auto i = pBegin; i < pEnd; ++i) { m_Objects[i]->updateParallel(*jobs); }
+			});
+		} catch(...) {
+			m_Transforms.setReadOnly(false);
+			throw;
 		}
+
+		m_Transforms.setReadOnly(false);
+
+		{
+			AURORA_PROFILE_ZONE("Level::update serial");
+			for(const auto &item: m_Objects) {
+				item->updateSerial();
+			}
+		}
+
+		// Batched controllers see the transforms as this frame leaves them.
+		m_Transforms.update();
+		m_Transforms.setReadOnly(true);
+		try {
+			AURORA_PROFILE_ZONE("Level::update batched");
+			for(const auto &item: m_ControllerPools) {
+				if(item) { item->updateBatch(*jobs); }
+			}
+		} catch(...) {
+			m_Transforms.setReadOnly(false);
+			throw;
+		}
+
+		m_Transforms.setReadOnly(false);
+		refitSpatial();
 	}
 
-	Framebuffer *Level::renderCamera(int pCameraId) {
-		auto cont = m_Cameras.at(pCameraId);
-		auto i = global->getImpl();
-		auto f = cont->getCurrentFramebuffer();
-		i->activateFramebuffer(f->getReference());
+	ControllerPool &Level::getControllerPool(ControllerTypeId pType, size_t pSize, size_t pAlign,
+	                                         ControllerPool::SlotDestructor pDestroySlot,
+	                                         ControllerPool::BatchUpdate pBatchUpdate) {
+		if(m_ControllerPools.size() <= pType) { m_ControllerPools.resize(pType + 1); }
 
-		cont->preRender();
+		auto &pool = m_ControllerPools[pType];
+		if(!pool) { pool = std::make_unique<ControllerPool>(pSize, pAlign, pDestroySlot, pBatchUpdate); }
+		return *pool;
+	}
 
-		for(const auto &item: m_Objects) {
-			item->render();
+	AabbTree::Proxy Level::trackBounds(Controller *pController, Object *pObject, const aether::Bounds &pBounds) {
+		auto handle = pObject->getTransform();
+		auto proxy = m_Spatial.createProxy(AabbTree::transform(pBounds, m_Transforms.getObjectMatrix(handle)),
+		                                   pController);
+
+		if(m_TrackedOfProxy.size() <= proxy) { m_TrackedOfProxy.resize(proxy + 1, AabbTree::none); }
+		m_TrackedOfProxy[proxy] = static_cast<uint32_t>(m_Tracked.size());
+		m_Tracked.push_back({pController, handle, pBounds, proxy});
+		return proxy;
+	}
+
+	void Level::untrackBounds(AabbTree::Proxy pProxy) {
+		auto index = m_TrackedOfProxy.at(pProxy);
+		m_Spatial.destroyProxy(pProxy);
+		m_TrackedOfProxy[pProxy] = AabbTree::none;
+
+		if(index + 1 != m_Tracked.size()) {
+			m_Tracked[index] = m_Tracked.back();
+			m_TrackedOfProxy[m_Tracked[index].proxy] = index;
+		}
+		m_Tracked.pop_back();
+	}
+
+	void Level::refitSpatial() {
+		for(const auto &item: m_Tracked) {
+			if(!m_Transforms.wasMoved(item.transform)) { continue; }
+
+			m_Spatial.moveProxy(item.proxy,
+			                    AabbTree::transform(item.bounds, m_Transforms.getObjectMatrix(item.transform)));
 		}
 
-		cont->postRender();
-		return cont->getCurrentFramebuffer(); // this might have changed!
+		m_Transforms.clearMoved();
+	}
+
+	Framebuffer *Level::renderCamera(int pCameraId) {
+		AURORA_PROFILE_ZONE("Level::renderCamera");
+		m_Snapshot.clear();
+		record(pCameraId, m_Snapshot);
+		auto framebuffer = presentPass(m_Snapshot, m_Snapshot.passes.back());
+		m_Snapshot.destroyRetired();
+		return framebuffer;
 	}
 
 	int Level::getCurrentCamera() const {
@@ -9,6 +9,16 @@
 #include "../asset_loader.h"
 #include "../aether/aether.h"
 #include "../resources/framebuffer.h"
+#include "../graphics/render_queue.h"
+#include "transform_store.h"
+#include "aabb_tree.h"
+#include "controller_pool.h"
+#include "controller_registry.h"
+#include "geometry_cache.h"
+#include "frame_snapshot.h"
+#include <functional>
+#include <memory>
+#include <mutex>
 
 namespace aurora::level {
 
@@ -16,26 +26,183 @@ namespace aurora::level {
 
 	class CameraController;
 
+	class Controller;
+
 	class Level {
 	private:
+		struct Tracked {
+			Controller *controller;
+			TransformStore::Handle transform;
+			aether::Bounds bounds;
+			AabbTree::Proxy proxy;
+		};
+
 		std::vector<Object *> m_Objects;
 		std::unordered_map<int, CameraController *> m_Cameras;
 		int m_CurrentCamera = -1;
+		RenderQueue m_RenderQueue;
+		RenderQueue m_PresentQueue;
+		FrameSnapshot m_Snapshot;
+		TransformStore m_Transforms;
+		AabbTree m_Spatial;
+
+		// Declared before the pools, so that it outlives the renderers in them.
+		GeometryCache m_Geometry;
+
+		// Indexed by controller type ID.
+		std::vector<std::unique_ptr<ControllerPool>> m_ControllerPools;
+
+		std::mutex m_RetiredMutex;
+		std::vector<std::function<void()>> m_Retired;
+
+		std::vector<Tracked> m_Tracked;
+		// Index into m_Tracked, by proxy.
+		std::vector<uint32_t> m_TrackedOfProxy;
+
+		void refitSpatial();
+		Framebuffer *presentPass(const FrameSnapshot &pSnapshot, const FrameSnapshot::Pass &pPass);
 
 	public:
 		Level();
 		virtual ~Level();
 		explicit Level(const aether::Level &pAether);
-		Level(AssetLoader *, const std::filesystem::path &pPath, const std::string &);
+		Level(AssetLoader *, const aether::AssetSource &pSource, const std::string &);
+
+		/*
+		 * Parsing the level is left to a loader worker; creating its objects
+		 * and controllers may load GPU resources, so that stays on the
+		 * context thread.
+		 */
+		using Staging = aether::Level;
 
+		static Staging stage(AssetLoader *, const aether::AssetSource &pSource, const std::string &) {
+			return aether::Level(pSource.readCbor());
+		}
+
+		Level(AssetLoader *, const Staging &pStaging, const std::string &) : Level(pStaging) {}
+
+		/**
+		 * @return The objects without a parent, which the level updates,
+		 * renders and deletes.
+		 */
 		[[nodiscard]] const std::vector<Object *> &getObjects() const {
 			return m_Objects;
 		}
 
+		/**
+		 * Makes a parentless object one of the level's roots. Objects that
+		 * are detached with Object::removeChild() are added by it.
+		 */
+		void addRoot(Object *pObject);
+
+		/**
+		 * Stops treating an object as a root, without deleting it. Object
+		 * calls this when it is given a parent or is deleted.
+		 */
+		void removeRoot(Object *pObject);
+
+		/**
+		 * Draws the current camera to the screen; record() and present() in
+		 * one.
+		 */
 		virtual void render();
 		virtual void update();
 
+		/**
+		 * Draws a camera, returning the framebuffer it drew to.
+		 */
 		virtual Framebuffer *renderCamera(int pCameraId);
+
+		/**
+		 * Collects the draws of a camera into a snapshot, as a new pass.
+		 * Calls render() on the controllers, but does not use the graphics
+		 * implementation, so it may run on a thread other than the one that
+		 * owns the context.
+		 */
+		void record(int pCameraId, FrameSnapshot &pSnapshot);
+
+		/**
+		 * Records the current camera, if there is one.
+		 */
+		void record(FrameSnapshot &pSnapshot);
+
+		/**
+		 * Draws every pass of a snapshot and shows the last one on screen.
+		 * Must run on the context thread. Reads nothing from the level but
+		 * the snapshot, so update() may run at the same time. Call
+		 * FrameSnapshot::destroyRetired() once it returns.
+		 */
+		void present(const FrameSnapshot &pSnapshot);
+
+		/**
+		 * Hands over the destruction of GPU objects that a snapshot may still
+		 * draw. The next snapshot recorded takes it over, and it runs once
+		 * that snapshot has been presented or dropped; see
+		 * FrameSnapshot::retired. May be called from any thread.
+		 */
+		void retire(std::function<void()> pDestroy);
+
+		/**
+		 * Moves what was retired into a snapshot. record() does this itself.
+		 */
+		void takeRetired(FrameSnapshot &pSnapshot);
+
+		/**
+		 * Destroys what was retired and not yet taken by a snapshot. Only
+		 * safe on the context thread while no snapshot is still to be
+		 * presented, such as between frames of a serial application.
+		 */
+		void destroyRetired();
+
+		/**
+		 * The queue that renderers submit to while a camera is being
+		 * recorded. It is begun with that camera's matrices; what was
+		 * submitted is moved into the snapshot once every object has
+		 * rendered.
+		 */
+		[[nodiscard]] RenderQueue &getRenderQueue() {
+			return m_RenderQueue;
+		}
+
+		[[nodiscard]] TransformStore &getTransforms() {
+			return m_Transforms;
+		}
+
+		/**
+		 * GPU geometry shared by the renderers of this level.
+		 */
+		[[nodiscard]] GeometryCache &getGeometryCache() {
+			return m_Geometry;
+		}
+
+		/**
+		 * The world-space bounds of every tracked controller. User data of
+		 * its proxies is the Controller.
+		 */
+		[[nodiscard]] const AabbTree &getSpatialIndex() const {
+			return m_Spatial;
+		}
+
+		/**
+		 * Adds a controller to the spatial index. Its bounds follow the world
+		 * transform of pObject, and are refitted at the end of every update()
+		 * in which that transform moved.
+		 *
+		 * @param pBounds Bounds in the object's own space.
+		 * @return The proxy, to be passed to untrackBounds().
+		 */
+		AabbTree::Proxy trackBounds(Controller *pController, Object *pObject, const aether::Bounds &pBounds);
+
+		void untrackBounds(AabbTree::Proxy pProxy);
+
+		/**
+		 * @return The pool holding this level's controllers of a type,
+		 * created with the passed layout the first time it is asked for.
+		 */
+		ControllerPool &getControllerPool(ControllerTypeId pType, size_t pSize, size_t pAlign,
+		                                  ControllerPool::SlotDestructor pDestroySlot,
+		                                  ControllerPool::BatchUpdate pBatchUpdate);
+
 		int getCurrentCamera() const;
 		CameraController *getCurrentCameraController() const;
 		void setCurrentCamera(int pCurrentCamera);
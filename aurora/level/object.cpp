@@ -7,31 +7,59 @@
 #include <algorithm>
 #include <utility>
 #include "controller.h"
+#include "level.h"
 
 namespace aurora::level {
 	Object::Object(Level *pLevel, Object *pParent, const glm::dvec3 &pPosition, const glm::dquat &pRotation,
 	               std::string pName)
-		: m_Level(pLevel), m_Parent(pParent), m_Position(pPosition), m_Rotation(glm::normalize(pRotation)),
-		  m_Name(std::move(pName)) {
-		updateMatrix();
+		: m_Name(std::move(pName)), m_Level(pLevel), m_Parent(pParent),
+		  m_Transform(pLevel->getTransforms().create(pParent != nullptr ? pParent->m_Transform : TransformStore::none,
+		                                             pPosition, pRotation)) {
+
 	}
 
 	Object::~Object() {
+		if(m_Parent != nullptr) {
+			auto it = m_Parent->m_Children.find(m_Name);
+			if(it != m_Parent->m_Children.end() && it->second == this) { m_Parent->m_Children.erase(it); }
+		} else {
+			m_Level->removeRoot(this);
+		}
+
+		// Taken out first, so that the children do not erase themselves from
+		// m_Children while it is being walked.
+		auto children = std::move(m_Children);
+		m_Children.clear();
+		for(const auto &item: children) {
+			delete item.second;
+		}
+
+		// Newest first, as later controllers may use earlier ones, as a
+		// renderer does its mesh.
+		for(auto it = m_Controllers.rbegin(); it != m_Controllers.rend(); ++it) {
+			level::deleteController(*it);
+		}
 
+		m_Level->getTransforms().destroy(m_Transform);
 	}
 
 	void Object::setLocalPosition(const glm::dvec3 &pPosition) {
-		m_Position = pPosition;
-		updateMatrix();
+		m_Level->getTransforms().setLocalPosition(m_Transform, pPosition);
+		markTransformDirty();
 	}
 
 	void Object::setLocalRotation(const glm::dquat &pRotation) {
-		m_Rotation = glm::normalize(pRotation);
-		updateMatrix();
+		m_Level->getTransforms().setLocalRotation(m_Transform, pRotation);
+		markTransformDirty();
 	}
 
-	void Object::updateMatrix() {
-		m_ObjectMatrix = glm::translate(glm::identity<glm::dmat4>(), getPosition()) * glm::toMat4(getRotation());
+	void Object::markTransformDirty() {
+		// Already dirty means the whole subtree is as well.
+		if(!m_Level->getTransforms().markDirty(m_Transform)) { return; }
+
+		for(const auto &item: m_Children) {
+			item.second->markTransformDirty();
+		}
 	}
 
 	Level *Object::getLevel() const {
@@ -51,14 +79,29 @@ namespace aurora::level {
 	}
 
 	const glm::mat4 &Object::getObjectMatrix() const {
-		return m_ObjectMatrix;
+		return m_Level->getTransforms().getObjectMatrix(m_Transform);
+	}
+
+	const glm::dmat4 &Object::getWorldMatrix() const {
+		return m_Level->getTransforms().getWorldMatrix(m_Transform);
 	}
 
 	void Object::addChild(Object *pObject) {
+		if(pObject->m_Parent != this) {
+			m_Level->getTransforms().setParent(pObject->m_Transform, m_Transform);
+			if(pObject->m_Parent != nullptr) {
+				pObject->m_Parent->m_Children.erase(pObject->m_Name);
+			} else {
+				m_Level->removeRoot(pObject);
+			}
+			pObject->m_Parent = this;
+		}
+
 		m_Children.insert({
 			                  pObject->m_Name,
 			                  pObject
 		                  });
+		pObject->markTransformDirty();
 	}
 
 	const std::string &Object::getName() const {
@@ -74,19 +117,33 @@ namespace aurora::level {
 	}
 
 	void Object::removeChild(Object *pObject) {
-		m_Children.erase(pObject->m_Name);
+		auto it = m_Children.find(pObject->m_Name);
+		if(it == m_Children.end() || it->second != pObject) { return; }
+
+		// The object stays in the level as a root.
+		m_Children.erase(it);
+		m_Level->getTransforms().setParent(pObject->m_Transform, TransformStore::none);
+		pObject->m_Parent = nullptr;
+		m_Level->addRoot(pObject);
+		pObject->markTransformDirty();
 	}
 
 	void Object::removeChild(const std::string &pName) {
-		m_Children.erase(pName);
+		auto it = m_Children.find(pName);
+		if(it != m_Children.end()) { removeChild(it->second); }
 	}
 
 	void Object::addController(Controller *pController) {
 		m_Controllers.emplace_back(pController);
+		m_ControllerTypes.emplace_back(pController->getTypeId());
 	}
 
 	void Object::removeController(Controller *pController) {
-		m_Controllers.erase(std::remove(m_Controllers.begin(), m_Controllers.end(), pController), m_Controllers.end());
+		auto it = std::find(m_Controllers.begin(), m_Controllers.end(), pController);
+		if(it == m_Controllers.end()) { return; }
+
+		m_ControllerTypes.erase(m_ControllerTypes.begin() + (it - m_Controllers.begin()));
+		m_Controllers.erase(it);
 	}
 
 	void Object::createController(const aether::Level::Controller &pAether) {
@@ -104,7 +161,7 @@ namespace aurora::level {
 		}
 
 		for(const auto &item: m_Controllers) {
-			item->render();
+			if(!item->isSpatial()) { item->render(); }
 		}
 	}
 
@@ -118,21 +175,76 @@ namespace aurora::level {
 		}
 	}
 
+	void Object::updateParallel(JobSystem &pJobs) {
+		if(m_Children.size() > 1) {
+			std::vector<Object *> children;
+			children.reserve(m_Children.size());
+			for(const auto &item: m_Children) { children.push_back(item.second); }
+
+			// A few jobs per thread; big subtrees split again further down.
+			auto grain = std::max<size_t>(1, children.size() / ((pJobs.getWorkerCount() + 1) * 4));
+			pJobs.parallelFor(children.size(), grain, [&children, &pJobs](size_t pBegin, size_t pEnd) {
+				for(auto i = pBegin; i < pEnd; ++i) { children[i]->updateParallel(pJobs); }
+			});
+		} else {
+			for(const auto &item: m_Children) { item.second->updateParallel(pJobs); }
+		}
+
+		for(const auto &item: m_Controllers) {
+			if(item->isParallelSafe() && !item->isBatched()) { item->update(); }
+		}
+	}
+
+	void Object::updateSerial() {
+		for(const auto &item: m_Children) {
+			item.second->updateSerial();
+		}
+
+		for(const auto &item: m_Controllers) {
+			if(!item->isParallelSafe() && !item->isBatched()) { item->update(); }
+		}
+	}
+
 	glm::dvec3 Object::getPosition() const {
-		return m_Parent != nullptr ? m_Position + m_Parent->getPosition() : m_Position;
+		return glm::dvec3(m_Level->getTransforms().getWorldMatrix(m_Transform)[3]);
 	}
 
 	glm::dquat Object::getRotation() const {
-		return m_Parent != nullptr ? m_Parent->getRotation() * m_Rotation : m_Rotation;
+		return m_Level->getTransforms().getWorldRotation(m_Transform);
+	}
+
+	glm::dvec3 Object::getLocalPosition() const {
+		return m_Level->getTransforms().getLocalPosition(m_Transform);
+	}
+
+	glm::dquat Object::getLocalRotation() const {
+		return m_Level->getTransforms().getLocalRotation(m_Transform);
+	}
+
+	TransformStore::Handle Object::getTransform() const {
+		return m_Transform;
+	}
+
+	Controller *Object::getController(ControllerTypeId pType) const {
+		auto it = std::find(m_ControllerTypes.begin(), m_ControllerTypes.end(), pType);
+		return it != m_ControllerTypes.end() ? m_Controllers[it - m_ControllerTypes.begin()] : nullptr;
 	}
 
 	Controller *Object::getController(const std::string &pType) const {
-		return *std::find_if(m_Controllers.begin(), m_Controllers.end(), [pType](Controller *pController) {
-			return pController->getType() == pType;
-		});
+		auto id = findControllerType(pType);
+		return id != noControllerType ? getController(id) : nullptr;
 	}
 
 	Controller *Object::findController(const std::function<bool(Controller *)> &pPredicate) const {
-		return *std::find_if(m_Controllers.begin(), m_Controllers.end(), pPredicate);
+		auto it = std::find_if(m_Controllers.begin(), m_Controllers.end(), pPredicate);
+		return it != m_Controllers.end() ? *it : nullptr;
+	}
+
+	void *Object::findInterface(ControllerTypeId pInterface) const {
+		for(const auto &item: m_Controllers) {
+			if(auto found = item->getInterface(pInterface)) { return found; }
+		}
+
+		return nullptr;
 	}
 } // aurora::level
\ No newline at end of file
@@ -8,11 +8,14 @@
 
 #include <glm/vec3.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <functional>
 #include <vector>
 #include <unordered_map>
 #include <string>
 #include "../aether/aether.h"
 #include "controller_registry.h"
+#include "transform_store.h"
+#include "../jobs.h"
 
 namespace aurora::level {
 
@@ -20,39 +23,75 @@ namespace aurora::level {
 
 	class Controller;
 
+	/**
+	 * A node of the level's hierarchy. Its position and rotation are relative
+	 * to its parent.
+	 *
+	 * The transform itself lives in the level's TransformStore, which caches
+	 * the world transform. Changing the local transform marks the object and
+	 * everything below it dirty, and the world transform is rebuilt from the
+	 * parent's the next time it is read or when the level updates the store
+	 * once per frame. While the parallel part of Level::update() runs, the
+	 * store is read-only, and reads return the world transform as it was
+	 * when the update started.
+	 */
 	class Object {
 	private:
 		std::string m_Name;
 		Level *m_Level;
 		Object *m_Parent;
-		glm::mat4 m_ObjectMatrix{};
-		glm::dvec3 m_Position;
-		glm::dquat m_Rotation;
+		TransformStore::Handle m_Transform;
 		std::unordered_map<std::string, Object *> m_Children;
 		std::vector<Controller *> m_Controllers;
+		// Type of each controller, so lookups scan a small array and make no
+		// virtual calls.
+		std::vector<ControllerTypeId> m_ControllerTypes;
 
 	public:
 		Object(Level *pLevel, Object *pParent, const glm::dvec3 &pPosition, const glm::dquat &pRotation,
 		       std::string pName);
+
+		/**
+		 * Deletes the children and controllers of the object along with it.
+		 */
 		virtual ~Object();
 
 	private:
-		void updateMatrix();
+		void markTransformDirty();
 
 	public:
 		void setLocalPosition(const glm::dvec3 &pPosition);
 		void setLocalRotation(const glm::dquat &pRotation);
 
 		const std::string &getName() const;
+
+		/**
+		 * @return The world matrix, in single precision for rendering.
+		 */
 		const glm::mat4 &getObjectMatrix() const;
+		[[nodiscard]] const glm::dmat4 &getWorldMatrix() const;
 		[[nodiscard]] Level *getLevel() const;
 		[[nodiscard]] Object *getParent() const;
 		[[nodiscard]] const std::unordered_map<std::string, Object *> &getChildren() const;
 		[[nodiscard]] const std::vector<Controller *> &getControllers() const;
 		[[nodiscard]] glm::dvec3 getPosition() const;
 		[[nodiscard]] glm::dquat getRotation() const;
-
+		[[nodiscard]] glm::dvec3 getLocalPosition() const;
+		[[nodiscard]] glm::dquat getLocalRotation() const;
+		[[nodiscard]] TransformStore::Handle getTransform() const;
+
+		/**
+		 * Makes an object a child of this one, taking it from its previous
+		 * parent. It keeps its local transform, and so moves with its new
+		 * parent from then on.
+		 *
+		 * @throws std::runtime_error The object is this one or above it.
+		 */
 		virtual void addChild(Object *pObject);
+
+		/**
+		 * Detaches a child, which stays in the level as a root.
+		 */
 		virtual void removeChild(Object *pObject);
 		virtual void removeChild(const std::string &pName);
 		[[nodiscard]] virtual Object *child(const std::string &pName);
@@ -62,23 +101,54 @@ namespace aurora::level {
 		virtual void removeController(Controller *pController);
 		virtual void createController(const aether::Level::Controller &pAether);
 		virtual void deleteController(Controller *pController);
+		[[nodiscard]] Controller *getController(ControllerTypeId pType) const;
 		virtual Controller *getController(const std::string &pType) const;
 		virtual Controller *findController(const std::function<bool(Controller *)> &pPredicate) const;
 
+		/**
+		 * @return The first controller of exactly type T, or nullptr.
+		 */
 		template<typename T>
 		T *getController() const {
-			return dynamic_cast<T *>(getController(T::type));
+			return static_cast<T *>(getController(controllerTypeId<T>()));
 		}
 
+		/**
+		 * @return The first controller exposing interface T through
+		 * Controller::getInterface(), or failing that the first controller
+		 * that is a T, or nullptr.
+		 */
 		template<typename T>
 		T *findControllerByType() const {
-			return dynamic_cast<T *>(findController([](Controller *pController) {
-				return dynamic_cast<T *>(pController) != nullptr;
-			}));
+			if constexpr(requires { T::type; }) {
+				if(auto found = findInterface(controllerTypeId<T>())) { return static_cast<T *>(found); }
+			}
+
+			// Controllers that do not override getInterface() are still found.
+			for(const auto &item: m_Controllers) {
+				if(auto found = dynamic_cast<T *>(item)) { return found; }
+			}
+
+			return nullptr;
 		}
 
+		[[nodiscard]] void *findInterface(ControllerTypeId pInterface) const;
+
 		virtual void render();
 		virtual void update();
+
+		/**
+		 * Updates the parallel-safe controllers of this object and everything
+		 * below it. Children are updated before their parent, with large sets
+		 * of children split into jobs.
+		 */
+		void updateParallel(JobSystem &pJobs);
+
+		/**
+		 * Updates every controller below and on this object that is not
+		 * parallel-safe, in the same order as update().
+		 */
+		void updateSerial();
 	};
 
 } // aurora::level
@@ -0,0 +1,228 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "transform_store.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace aurora::level {
+	TransformStore::Handle
+	TransformStore::create(Handle pParent, const glm::dvec3 &pPosition, const glm::dquat &pRotation) {
+		Handle handle;
+		if(!m_FreeHandles.empty()) {
+			handle = m_FreeHandles.back();
+			m_FreeHandles.pop_back();
+		} else {
+			handle = static_cast<Handle>(m_SlotOfHandle.size());
+			m_SlotOfHandle.push_back(none);
+		}
+
+		// Appending keeps the order, as the parent already has a slot.
+		auto slot = static_cast<uint32_t>(m_HandleOfSlot.size());
+		m_SlotOfHandle[handle] = slot;
+
+		m_LocalPosition.push_back(pPosition);
+		m_LocalRotation.push_back(glm::normalize(pRotation));
+		m_WorldMatrix.emplace_back();
+		m_WorldRotation.emplace_back();
+		m_ObjectMatrix.emplace_back();
+		m_Parent.push_back(pParent == none ? none : m_SlotOfHandle.at(pParent));
+		m_Dirty.push_back(1);
+		m_Moved.push_back(1);
+		m_HandleOfSlot.push_back(handle);
+
+		return handle;
+	}
+
+	void TransformStore::destroy(Handle pHandle) {
+		auto slot = m_SlotOfHandle.at(pHandle);
+		m_HandleOfSlot[slot] = none;
+		m_SlotOfHandle[pHandle] = none;
+		m_FreeHandles.push_back(pHandle);
+
+		// The slot stays until enough of them pile up, so that removing many
+		// objects does not shift the arrays every time.
+		if(++m_DeadSlots > 64 && m_DeadSlots > m_HandleOfSlot.size() / 2) { compact(); }
+	}
+
+	void TransformStore::setParent(Handle pHandle, Handle pParent) {
+		auto slot = m_SlotOfHandle.at(pHandle);
+		auto parentSlot = pParent == none ? none : m_SlotOfHandle.at(pParent);
+
+		// Children always come after their parent, so the subtree is found
+		// in one sweep from the transform onwards.
+		std::vector<uint32_t> subtree{slot};
+		std::vector<uint8_t> inSubtree(m_HandleOfSlot.size() - slot, 0);
+		inSubtree[0] = 1;
+		for(auto i = slot + 1; i < m_HandleOfSlot.size(); ++i) {
+			auto parent = m_Parent[i];
+			if(m_HandleOfSlot[i] != none && parent != none && parent >= slot && inSubtree[parent - slot]) {
+				inSubtree[i - slot] = 1;
+				subtree.push_back(i);
+			}
+		}
+
+		if(parentSlot != none && parentSlot >= slot && inSubtree[parentSlot - slot]) {
+			throw std::runtime_error("a transform cannot be moved below itself");
+		}
+
+		if(parentSlot == none || parentSlot < slot) {
+			m_Parent[slot] = parentSlot;
+			for(auto i: subtree) { m_Dirty[i] = 1; }
+			return;
+		}
+
+		// The new parent comes later, so the subtree is appended after it in
+		// its current order, which keeps every parent before its children.
+		std::vector<uint32_t> movedTo(subtree.size());
+		for(size_t i = 0; i < subtree.size(); ++i) {
+			auto from = subtree[i];
+			auto to = static_cast<uint32_t>(m_HandleOfSlot.size());
+			movedTo[i] = to;
+
+			auto parent = m_Parent[from];
+			if(i == 0) {
+				parent = parentSlot;
+			} else {
+				parent = movedTo[std::lower_bound(subtree.begin(), subtree.end(), parent) - subtree.begin()];
+			}
+
+			m_LocalPosition.push_back(m_LocalPosition[from]);
+			m_LocalRotation.push_back(m_LocalRotation[from]);
+			m_WorldMatrix.push_back(m_WorldMatrix[from]);
+			m_WorldRotation.push_back(m_WorldRotation[from]);
+			m_ObjectMatrix.push_back(m_ObjectMatrix[from]);
+			m_Parent.push_back(parent);
+			m_Dirty.push_back(1);
+			m_Moved.push_back(m_Moved[from]);
+			m_HandleOfSlot.push_back(m_HandleOfSlot[from]);
+
+			m_SlotOfHandle[m_HandleOfSlot[from]] = to;
+			m_HandleOfSlot[from] = none;
+		}
+
+		m_DeadSlots += subtree.size();
+		if(m_DeadSlots > 64 && m_DeadSlots > m_HandleOfSlot.size() / 2) { compact(); }
+	}
+
+	void TransformStore::compact() {
+		std::vector<uint32_t> moved(m_HandleOfSlot.size(), none);
+
+		uint32_t to = 0;
+		for(uint32_t from = 0; from < m_HandleOfSlot.size(); ++from) {
+			if(m_HandleOfSlot[from] == none) { continue; }
+			moved[from] = to;
+
+			// Parents were moved first, so their new slot is already known.
+			auto parent = m_Parent[from];
+			m_Parent[to] = parent == none ? none : moved[parent];
+			if(parent != none && m_Parent[to] == none) { m_Dirty[from] = 1; }
+
+			m_LocalPosition[to] = m_LocalPosition[from];
+			m_LocalRotation[to] = m_LocalRotation[from];
+			m_WorldMatrix[to] = m_WorldMatrix[from];
+			m_WorldRotation[to] = m_WorldRotation[from];
+			m_ObjectMatrix[to] = m_ObjectMatrix[from];
+			m_Dirty[to] = m_Dirty[from];
+			m_Moved[to] = m_Moved[from];
+			m_HandleOfSlot[to] = m_HandleOfSlot[from];
+			m_SlotOfHandle[m_HandleOfSlot[to]] = to;
+			++to;
+		}
+
+		m_LocalPosition.resize(to);
+		m_LocalRotation.resize(to);
+		m_WorldMatrix.resize(to);
+		m_WorldRotation.resize(to);
+		m_ObjectMatrix.resize(to);
+		m_Parent.resize(to);
+		m_Dirty.resize(to);
+		m_Moved.resize(to);
+		m_HandleOfSlot.resize(to);
+		m_DeadSlots = 0;
+	}
+
+	bool TransformStore::markDirty(Handle pHandle) {
+		auto &dirty = m_Dirty[m_SlotOfHandle.at(pHandle)];
+		if(dirty) { return false; }
+
+		dirty = 1;
+		return true;
+	}
+
+	void TransformStore::setLocalPosition(Handle pHandle, const glm::dvec3 &pPosition) {
+		m_LocalPosition[m_SlotOfHandle.at(pHandle)] = pPosition;
+	}
+
+	void TransformStore::setLocalRotation(Handle pHandle, const glm::dquat &pRotation) {
+		m_LocalRotation[m_SlotOfHandle.at(pHandle)] = glm::normalize(pRotation);
+	}
+
+	const glm::dvec3 &TransformStore::getLocalPosition(Handle pHandle) const {
+		return m_LocalPosition[m_SlotOfHandle.at(pHandle)];
+	}
+
+	const glm::dquat &TransformStore::getLocalRotation(Handle pHandle) const {
+		return m_LocalRotation[m_SlotOfHandle.at(pHandle)];
+	}
+
+	const glm::dmat4 &TransformStore::getWorldMatrix(Handle pHandle) {
+		auto slot = m_SlotOfHandle.at(pHandle);
+		if(!m_ReadOnly) { resolve(slot); }
+		return m_WorldMatrix[slot];
+	}
+
+	const glm::dquat &TransformStore::getWorldRotation(Handle pHandle) {
+		auto slot = m_SlotOfHandle.at(pHandle);
+		if(!m_ReadOnly) { resolve(slot); }
+		return m_WorldRotation[slot];
+	}
+
+	const glm::mat4 &TransformStore::getObjectMatrix(Handle pHandle) {
+		auto slot = m_SlotOfHandle.at(pHandle);
+		if(!m_ReadOnly) { resolve(slot); }
+		return m_ObjectMatrix[slot];
+	}
+
+	void TransformStore::recompute(uint32_t pSlot) {
+		auto local = glm::translate(glm::identity<glm::dmat4>(), m_LocalPosition[pSlot]) *
+		             glm::toMat4(m_LocalRotation[pSlot]);
+
+		auto parent = m_Parent[pSlot];
+		if(parent != none && m_HandleOfSlot[parent] == none) { parent = m_Parent[pSlot] = none; }
+
+		if(parent != none) {
+			m_WorldMatrix[pSlot] = m_WorldMatrix[parent] * local;
+			m_WorldRotation[pSlot] = m_WorldRotation[parent] * m_LocalRotation[pSlot];
+		} else {
+			m_WorldMatrix[pSlot] = local;
+			m_WorldRotation[pSlot] = m_LocalRotation[pSlot];
+		}
+
+		m_ObjectMatrix[pSlot] = glm::mat4(m_WorldMatrix[pSlot]);
+		m_Dirty[pSlot] = 0;
+		m_Moved[pSlot] = 1;
+	}
+
+	void TransformStore::resolve(uint32_t pSlot) {
+		if(!m_Dirty[pSlot]) { return; }
+
+		// A clean slot never has a dirty parent, so this stops at the first
+		// clean ancestor.
+		auto parent = m_Parent[pSlot];
+		if(parent != none && m_HandleOfSlot[parent] != none) { resolve(parent); }
+		recompute(pSlot);
+	}
+
+	void TransformStore::update() {
+		for(uint32_t i = 0; i < m_Dirty.size(); ++i) {
+			if(m_Dirty[i] && m_HandleOfSlot[i] != none) { recompute(i); }
+		}
+	}
+
+	void TransformStore::clearMoved() {
+		std::fill(m_Moved.begin(), m_Moved.end(), 0);
+	}
+} // aurora::level
@@ -0,0 +1,139 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_TRANSFORM_STORE_H
+#define AURORA_TRANSFORM_STORE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aurora::level {
+
+	/**
+	 * Holds the transforms of every object in a level as parallel arrays.
+	 *
+	 * Slots are kept sorted so that a parent always comes before its
+	 * children. update() can therefore rebuild every dirty world transform in
+	 * one forward sweep, reading the parent's result from a slot it has
+	 * already passed.
+	 *
+	 * Objects refer to their transform by a handle, which stays valid while
+	 * slots are compacted. References returned by the getters are only valid
+	 * until the next create() or destroy().
+	 */
+	class TransformStore {
+	public:
+		using Handle = uint32_t;
+
+		static constexpr uint32_t none = UINT32_MAX;
+
+	private:
+		std::vector<glm::dvec3> m_LocalPosition;
+		std::vector<glm::dquat> m_LocalRotation;
+		std::vector<glm::dmat4> m_WorldMatrix;
+		std::vector<glm::dquat> m_WorldRotation;
+		std::vector<glm::mat4> m_ObjectMatrix;
+		std::vector<uint32_t> m_Parent;
+		std::vector<uint8_t> m_Dirty;
+		std::vector<uint8_t> m_Moved;
+		std::vector<Handle> m_HandleOfSlot;
+
+		std::vector<uint32_t> m_SlotOfHandle;
+		std::vector<Handle> m_FreeHandles;
+		size_t m_DeadSlots = 0;
+		bool m_ReadOnly = false;
+
+		void recompute(uint32_t pSlot);
+		void resolve(uint32_t pSlot);
+		void compact();
+
+	public:
+		/**
+		 * Adds a transform. Its world transform is built on the next update()
+		 * or read.
+		 *
+		 * @param pParent Handle of the parent, or none for a root.
+		 */
+		Handle create(Handle pParent, const glm::dvec3 &pPosition, const glm::dquat &pRotation);
+
+		/**
+		 * Removes a transform. Children of it become roots the next time their
+		 * world transform is rebuilt.
+		 */
+		void destroy(Handle pHandle);
+
+		/**
+		 * Moves a transform, with everything below it, under another parent.
+		 * The moved transforms are marked dirty, and are moved to the end of
+		 * the slots when the new parent would otherwise come after them.
+		 *
+		 * @param pParent Handle of the new parent, or none to make it a root.
+		 * @throws std::runtime_error The new parent is the transform itself
+		 * or one below it.
+		 */
+		void setParent(Handle pHandle, Handle pParent);
+
+		/**
+		 * Marks a transform as needing its world transform rebuilt. This does
+		 * not reach its children; the caller has to mark those too.
+		 *
+		 * @return Whether the transform was clean before.
+		 */
+		bool markDirty(Handle pHandle);
+
+		void setLocalPosition(Handle pHandle, const glm::dvec3 &pPosition);
+		void setLocalRotation(Handle pHandle, const glm::dquat &pRotation);
+
+		[[nodiscard]] const glm::dvec3 &getLocalPosition(Handle pHandle) const;
+		[[nodiscard]] const glm::dquat &getLocalRotation(Handle pHandle) const;
+
+		/*
+		 * The world transform getters rebuild a dirty transform before
+		 * returning it, unless the store is read-only.
+		 */
+		const glm::dmat4 &getWorldMatrix(Handle pHandle);
+		const glm::dquat &getWorldRotation(Handle pHandle);
+		const glm::mat4 &getObjectMatrix(Handle pHandle);
+
+		/**
+		 * While read-only, the world transform getters return what was last
+		 * built and never write to the store, so that jobs may call them at
+		 * the same time. Transforms made dirty in the meantime keep their old
+		 * world transform until the next update().
+		 */
+		void setReadOnly(bool pReadOnly) {
+			m_ReadOnly = pReadOnly;
+		}
+
+		[[nodiscard]] bool isReadOnly() const {
+			return m_ReadOnly;
+		}
+
+		/**
+		 * Rebuilds every dirty world transform in slot order.
+		 */
+		void update();
+
+		/**
+		 * @return Whether the world transform was rebuilt since the last
+		 * clearMoved().
+		 */
+		[[nodiscard]] bool wasMoved(Handle pHandle) const {
+			return m_Moved[m_SlotOfHandle.at(pHandle)];
+		}
+
+		void clearMoved();
+
+		[[nodiscard]] size_t size() const {
+			return m_HandleOfSlot.size() - m_DeadSlots;
+		}
+	};
+
+} // aurora::level
+
+#endif //AURORA_TRANSFORM_STORE_H
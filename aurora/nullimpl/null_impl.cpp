@@ -0,0 +1,550 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "null_impl.h"
+#include "aurora/aether/profiler.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace aurora {
+	void NullImplementation::log(Op pOp, uint32_t pObject, uint64_t pValue) {
+		if(m_Recording) { m_Commands.push_back({pOp, pObject, pValue}); }
+	}
+
+	uint32_t NullImplementation::created() {
+		auto id = m_NextId++;
+		++m_Counters.creates;
+		log(Op::Create, id);
+		return id;
+	}
+
+	void NullImplementation::destroyed(uint32_t pId) {
+		++m_Counters.destroys;
+		log(Op::Destroy, pId);
+
+		if(m_Shader == pId) { m_Shader = 0; }
+		if(m_Framebuffer == pId) { m_Framebuffer = 0; }
+		for(auto &item: m_Textures) {
+			if(item == pId) { item = 0; }
+		}
+	}
+
+	NullImplementation::TextureReference *NullImplementation::texture(ObjRefBase *pObject, int pDimensions) {
+		auto ref = dynamic_cast<TextureReference *>(pObject);
+		if(ref == nullptr || ref->dimensions != pDimensions) {
+			throw EInvalidRef("invalid texture-" + std::to_string(pDimensions) + "d reference");
+		}
+
+		return ref;
+	}
+
+	NullImplementation::BufferReference *NullImplementation::buffer(ObjRefBase *pObject) {
+		auto ref = dynamic_cast<BufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid buffer reference"); }
+
+		return ref;
+	}
+
+	void NullImplementation::bindFramebuffer(uint32_t pId) {
+		if(m_Framebuffer == pId) { return; }
+
+		m_Framebuffer = pId;
+		++m_Counters.framebufferBinds;
+		log(Op::BindFramebuffer, pId);
+		AURORA_PROFILE_COUNT(StateChanges, 1);
+	}
+
+	void NullImplementation::bindDrawState(DrawObjectReference *pRef) {
+		if(m_Shader != pRef->shader) {
+			m_Shader = pRef->shader;
+			++m_Counters.shaderBinds;
+			log(Op::BindShader, pRef->shader);
+			AURORA_PROFILE_COUNT(StateChanges, 1);
+		}
+
+		for(const auto &item: pRef->textures) {
+			auto &bound = m_Textures[item.unit];
+			if(bound == item.texture) { continue; }
+
+			bound = item.texture;
+			++m_Counters.textureBinds;
+			log(Op::BindTexture, item.texture, static_cast<uint64_t>(item.unit));
+			AURORA_PROFILE_COUNT(StateChanges, 1);
+		}
+	}
+
+	ObjRefBase *NullImplementation::createShader(const aether::Shader &pShader) {
+		bool instanced = false;
+		for(const auto &item: pShader.instanceInputs) {
+			if(item.purpose != "MatrixObject") {
+				throw std::runtime_error("invalid shader instance input: " + item.purpose);
+			}
+			instanced = true;
+		}
+
+		// Object matrices read from a block are drawn in instanced batches,
+		// as they would be from an instance input.
+		bool objectBlock = false;
+		for(const auto &item: pShader.blocks) {
+			if(item.purpose != "Camera" && item.purpose != "Objects") {
+				throw std::runtime_error("invalid shader block: " + item.purpose);
+			}
+			objectBlock |= item.purpose == "Objects";
+		}
+		if(objectBlock && instanced) {
+			throw EShaderCompile("shader reads object matrices from an instance input and a block");
+		}
+		instanced |= objectBlock;
+
+		return new ShaderReference(created(), instanced);
+	}
+
+	void NullImplementation::destroyShader(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<ShaderReference *>(pObject);
+		if(ref == nullptr) { return; }
+
+		destroyed(ref->id);
+		delete ref;
+	}
+
+	void NullImplementation::setupWindowHints() {
+		// A window made for this backend needs no context.
+		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+	}
+
+	void NullImplementation::setupWindowPostCreate() {
+
+	}
+
+	void NullImplementation::updateViewportSize(int, int) {
+
+	}
+
+	void NullImplementation::performFinishFrame(Window *) {
+		++m_Counters.frames;
+		log(Op::FinishFrame, 0);
+	}
+
+	void NullImplementation::setClearColor(float, float, float, float) {
+
+	}
+
+	void NullImplementation::performClear(ClearOptions pOptions) {
+		log(Op::Clear, m_Framebuffer, (pOptions.color ? 4u : 0u) | (pOptions.depth ? 2u : 0u) |
+		                              (pOptions.stencil ? 1u : 0u));
+	}
+
+	ObjRefBase *NullImplementation::createBuffer(BufferType pType) {
+		if(pType != VertexBuffer && pType != IndexBuffer) { throw std::runtime_error("invalid buffer type"); }
+
+		return new BufferReference(created(), pType);
+	}
+
+	void NullImplementation::destroyBuffer(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<BufferReference *>(pObject);
+		if(ref == nullptr) { return; }
+
+		destroyed(ref->id);
+		delete ref;
+	}
+
+	void NullImplementation::updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize) {
+		auto ref = buffer(pObject);
+		ref->data.resize(pSize);
+		if(pData != nullptr && pSize > 0) { std::memcpy(ref->data.data(), pData, pSize); }
+
+		m_Counters.bytesUploaded += pSize;
+		log(Op::UpdateBuffer, ref->id, pSize);
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, pSize);
+	}
+
+	void NullImplementation::updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize, size_t pOffset) {
+		auto ref = buffer(pObject);
+		if(pOffset + pSize > ref->data.size()) { throw EBufferOverflow("buffer too small"); }
+		if(pSize > 0) { std::memcpy(ref->data.data() + pOffset, pData, pSize); }
+
+		m_Counters.bytesUploaded += pSize;
+		log(Op::UpdateBuffer, ref->id, pSize);
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, pSize);
+	}
+
+	void NullImplementation::retrieveBufferData(ObjRefBase *pObject, void *pData, size_t pSize, size_t pOffset) {
+		auto ref = buffer(pObject);
+		if(pOffset + pSize > ref->data.size()) { throw EBufferUnderflow("buffer too small"); }
+		if(pSize > 0) { std::memcpy(pData, ref->data.data() + pOffset, pSize); }
+
+		m_Counters.bytesRetrieved += pSize;
+		log(Op::RetrieveBuffer, ref->id, pSize);
+	}
+
+	ObjRefBase *NullImplementation::createStreamBuffer(BufferType pType, size_t pSize) {
+		if(pType != VertexBuffer && pType != IndexBuffer) { throw std::runtime_error("invalid buffer type"); }
+
+		auto ref = new StreamBufferReference(created(), pType);
+		ref->data.resize(pSize);
+		return ref;
+	}
+
+	void NullImplementation::destroyStreamBuffer(ObjRefBase *pObject) noexcept {
+		destroyBuffer(dynamic_cast<StreamBufferReference *>(pObject));
+	}
+
+	StreamBufferRange NullImplementation::mapStreamBuffer(ObjRefBase *pObject, size_t pSize, size_t pAlignment) {
+		auto ref = dynamic_cast<StreamBufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid stream buffer reference"); }
+		if(pSize > ref->data.size()) { throw EBufferOverflow("stream buffer too small"); }
+
+		pAlignment = std::max<size_t>(pAlignment, 1);
+		auto start = (ref->head + pAlignment - 1) / pAlignment * pAlignment;
+		if(start + pSize > ref->data.size()) { start = 0; }
+
+		// As on the GPU backends, a frame may not come round to its own
+		// ranges.
+		if(ref->frameNumber != m_Counters.frames) {
+			ref->frameNumber = m_Counters.frames;
+			ref->frameBytes = 0;
+		}
+		auto consumed = (start >= ref->head ? start - ref->head : ref->data.size() - ref->head + start) + pSize;
+		if(ref->frameBytes + consumed > ref->data.size()) {
+			throw EBufferOverflow("stream buffer cannot hold one frame of writes");
+		}
+
+		ref->frameBytes += consumed;
+		ref->head = start + pSize;
+
+		m_Counters.bytesUploaded += pSize;
+		log(Op::MapStreamBuffer, ref->id, pSize);
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, pSize);
+		return {ref->data.data() + start, start};
+	}
+
+	void NullImplementation::unmapStreamBuffer(ObjRefBase *pObject) {
+		if(dynamic_cast<StreamBufferReference *>(pObject) == nullptr) {
+			throw EInvalidRef("invalid stream buffer reference");
+		}
+	}
+
+	ObjRefBase *NullImplementation::createTexture1D() {
+		return new TextureReference(created(), 1);
+	}
+
+	void NullImplementation::destroyTexture1D(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<TextureReference *>(pObject);
+		if(ref == nullptr || ref->dimensions != 1) { return; }
+
+		destroyed(ref->id);
+		delete ref;
+	}
+
+	void NullImplementation::setTexture1DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) {
+		auto ref = texture(pObject, 1);
+		if(pWrap == TextureWrapType::BorderColor) { throw std::runtime_error("use setTexture1DWrapPropertyBorder"); }
+
+		log(Op::SetTextureParameter, ref->id);
+	}
+
+	void NullImplementation::setTexture1DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3) {
+		log(Op::SetTextureParameter, texture(pObject, 1)->id);
+	}
+
+	void NullImplementation::setTexture1DFilter(ObjRefBase *pObject, TextureMinFilter, TextureMagFilter) {
+		log(Op::SetTextureParameter, texture(pObject, 1)->id);
+	}
+
+	void NullImplementation::updateTexture1DData(ObjRefBase *pObject, int pWidth, const uint8_t *) {
+		auto ref = texture(pObject, 1);
+		if(pWidth > maxTextureSize) {
+			throw ETextureSize("texture too large; no dimension can be larger than " + std::to_string(maxTextureSize));
+		}
+
+		auto bytes = static_cast<uint64_t>(pWidth) * 4;
+		m_Counters.bytesUploaded += bytes;
+		log(Op::UpdateTexture, ref->id, bytes);
+	}
+
+	void NullImplementation::updateTexture1DMipmap(ObjRefBase *pObject) {
+		log(Op::UpdateMipmap, texture(pObject, 1)->id);
+	}
+
+	ObjRefBase *NullImplementation::createTexture2D() {
+		return new TextureReference(created(), 2);
+	}
+
+	void NullImplementation::destroyTexture2D(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<TextureReference *>(pObject);
+		if(ref == nullptr || ref->dimensions != 2) { return; }
+
+		destroyed(ref->id);
+		delete ref;
+	}
+
+	void NullImplementation::setTexture2DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) {
+		auto ref = texture(pObject, 2);
+		if(pWrap == TextureWrapType::BorderColor) { throw std::runtime_error("use setTexture2DWrapPropertyBorder"); }
+
+		log(Op::SetTextureParameter, ref->id);
+	}
+
+	void NullImplementation::setTexture2DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3) {
+		log(Op::SetTextureParameter, texture(pObject, 2)->id);
+	}
+
+	void NullImplementation::setTexture2DFilter(ObjRefBase *pObject, TextureMinFilter, TextureMagFilter) {
+		log(Op::SetTextureParameter, texture(pObject, 2)->id);
+	}
+
+	void NullImplementation::updateTexture2DData(ObjRefBase *pObject, const sail::image &pImage) {
+		updateTexture2DData(pObject, static_cast<int>(pImage.width()), static_cast<int>(pImage.height()), nullptr);
+	}
+
+	void NullImplementation::updateTexture2DData(ObjRefBase *pObject, int pWidth, int pHeight, const uint8_t *) {
+		auto ref = texture(pObject, 2);
+		if(pWidth > maxTextureSize || pHeight > maxTextureSize) {
+			throw ETextureSize("texture too large; no dimension can be larger than " + std::to_string(maxTextureSize));
+		}
+
+		auto bytes = static_cast<uint64_t>(pWidth) * pHeight * 4;
+		m_Counters.bytesUploaded += bytes;
+		log(Op::UpdateTexture, ref->id, bytes);
+	}
+
+	void NullImplementation::updateTexture2DMipmap(ObjRefBase *pObject) {
+		log(Op::UpdateMipmap, texture(pObject, 2)->id);
+	}
+
+	ObjRefBase *NullImplementation::createTexture3D() {
+		return new TextureReference(created(), 3);
+	}
+
+	void NullImplementation::destroyTexture3D(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<TextureReference *>(pObject);
+		if(ref == nullptr || ref->dimensions != 3) { return; }
+
+		destroyed(ref->id);
+		delete ref;
+	}
+
+	void NullImplementation::setTexture3DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) {
+		auto ref = texture(pObject, 3);
+		if(pWrap == TextureWrapType::BorderColor) { throw std::runtime_error("use setTexture3DWrapPropertyBorder"); }
+
+		log(Op::SetTextureParameter, ref->id);
+	}
+
+	void NullImplementation::setTexture3DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3) {
+		log(Op::SetTextureParameter, texture(pObject, 3)->id);
+	}
+
+	void NullImplementation::setTexture3DFilter(ObjRefBase *pObject, TextureMinFilter, TextureMagFilter) {
+		log(Op::SetTextureParameter, texture(pObject, 3)->id);
+	}
+
+	void NullImplementation::updateTexture3DData(ObjRefBase *pObject, int pWidth, int pHeight, int pDepth,
+	                                             const uint8_t *) {
+		auto ref = texture(pObject, 3);
+		if(pWidth > max3DTextureSize || pHeight > max3DTextureSize || pDepth > max3DTextureSize) {
+			throw ETextureSize("texture too large; no dimension can be larger than " +
+			                   std::to_string(max3DTextureSize));
+		}
+
+		auto bytes = static_cast<uint64_t>(pWidth) * pHeight * pDepth * 4;
+		m_Counters.bytesUploaded += bytes;
+		log(Op::UpdateTexture, ref->id, bytes);
+	}
+
+	void NullImplementation::updateTexture3DMipmap(ObjRefBase *pObject) {
+		log(Op::UpdateMipmap, texture(pObject, 3)->id);
+	}
+
+	void NullImplementation::resizeFramebuffer(FramebufferReference *pRef, int pWidth, int pHeight) {
+		// Like the OpenGL backend, the attachments are remade at the new size.
+		if(pRef->colorTexture != nullptr) { destroyTexture2D(pRef->colorTexture); }
+		if(pRef->depthTexture != nullptr) { destroyTexture2D(pRef->depthTexture); }
+
+		pRef->colorTexture = new TextureReference(created(), 2);
+		pRef->depthTexture = new TextureReference(created(), 2);
+		pRef->width = pWidth;
+		pRef->height = pHeight;
+	}
+
+	ObjRefBase *NullImplementation::createFramebuffer(int pWidth, int pHeight) {
+		auto ref = new FramebufferReference(created());
+		resizeFramebuffer(ref, pWidth, pHeight);
+		return ref;
+	}
+
+	void NullImplementation::reinitializeFramebuffer(ObjRefBase *pObject, int pWidth, int pHeight) {
+		auto ref = dynamic_cast<FramebufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
+
+		log(Op::ReinitializeFramebuffer, ref->id, static_cast<uint64_t>(pWidth) << 32 | static_cast<uint32_t>(pHeight));
+		resizeFramebuffer(ref, pWidth, pHeight);
+	}
+
+	void NullImplementation::destroyFramebuffer(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<FramebufferReference *>(pObject);
+		if(ref == nullptr) { return; }
+
+		destroyTexture2D(ref->colorTexture);
+		destroyTexture2D(ref->depthTexture);
+		destroyed(ref->id);
+		delete ref;
+	}
+
+	ObjRefBase *NullImplementation::getFramebufferColorTexture2D(ObjRefBase *pObject) {
+		auto ref = dynamic_cast<FramebufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
+
+		return ref->colorTexture;
+	}
+
+	ObjRefBase *NullImplementation::getFramebufferDepthTexture2D(ObjRefBase *pObject) {
+		auto ref = dynamic_cast<FramebufferReference *>(pObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
+
+		return ref->depthTexture;
+	}
+
+	void NullImplementation::performBlitFramebuffer(ObjRefBase *pSource, ObjRefBase *pTarget) {
+		auto refs = dynamic_cast<FramebufferReference *>(pSource);
+		if(refs == nullptr) { throw EInvalidRef("invalid framebuffer reference"); }
+
+		auto reft = dynamic_cast<Reference *>(pTarget);
+		if(reft == nullptr || (reft != &m_DefaultFramebufferRef && dynamic_cast<FramebufferReference *>(reft) == nullptr)) {
+			throw EInvalidRef("invalid framebuffer reference");
+		}
+
+		log(Op::BlitFramebuffer, refs->id, reft->id);
+	}
+
+	void NullImplementation::performBlitFramebuffer(ObjRefBase *pSource, ObjRefBase *pTarget, int, int, int, int, int,
+	                                                int) {
+		performBlitFramebuffer(pSource, pTarget);
+	}
+
+	ObjRefBase *NullImplementation::getDefaultFramebuffer() {
+		return &m_DefaultFramebufferRef;
+	}
+
+	void NullImplementation::activateFramebuffer(ObjRefBase *pObject) {
+		auto ref = dynamic_cast<Reference *>(pObject);
+		if(ref == nullptr || (ref != &m_DefaultFramebufferRef && dynamic_cast<FramebufferReference *>(ref) == nullptr)) {
+			throw EInvalidRef("invalid framebuffer reference");
+		}
+
+		bindFramebuffer(ref->id);
+	}
+
+	ObjRefBase *NullImplementation::createDrawObject(const DrawObjectOptions &pOptions) {
+		auto sRef = dynamic_cast<ShaderReference *>(pOptions.shader);
+		if(sRef == nullptr) { throw EInvalidRef("invalid shader reference"); }
+		auto vertexBuffer = dynamic_cast<BufferReference *>(pOptions.vertexBuffer);
+		auto indexBuffer = dynamic_cast<BufferReference *>(pOptions.indexBuffer);
+		if(vertexBuffer == nullptr || indexBuffer == nullptr) { throw EInvalidRef("invalid buffer reference"); }
+
+		std::vector<DrawObjectReference::TextureBinding> textures;
+		auto addTextures = [this, &textures](ObjRefBase *const *pTextures, int pCount, int pFirstUnit,
+		                                     int pDimensions) {
+			for(int i = 0; i < pCount; ++i) {
+				if(pTextures[i] != nullptr) { textures.push_back({pFirstUnit + i, texture(pTextures[i], pDimensions)->id}); }
+			}
+		};
+
+		addTextures(pOptions.textures, 16, 0, 2);
+		addTextures(pOptions.textures1D, 8, 16, 1);
+		addTextures(pOptions.textures3D, 8, 24, 3);
+
+		auto ref = new DrawObjectReference(created(), sRef->id, sRef->instanced, pOptions.vertexCount);
+		ref->textures = std::move(textures);
+
+		// The buffers stand in for the VAO an OpenGL backend would share.
+		uint32_t textureHash = 2166136261u;
+		for(auto value: {vertexBuffer->id, indexBuffer->id}) {
+			textureHash ^= value;
+			textureHash *= 16777619u;
+		}
+		for(const auto &item: ref->textures) {
+			for(auto value: {static_cast<uint32_t>(item.unit), item.texture}) {
+				textureHash ^= value;
+				textureHash *= 16777619u;
+			}
+		}
+		ref->stateKey = (sRef->id & 0xfffu) << 20 | ((textureHash ^ textureHash >> 20) & 0xfffffu);
+
+		return ref;
+	}
+
+	void NullImplementation::destroyDrawObject(ObjRefBase *pObject) noexcept {
+		auto ref = dynamic_cast<DrawObjectReference *>(pObject);
+		if(ref == nullptr) { return; }
+
+		destroyed(ref->id);
+		delete ref;
+	}
+
+	void NullImplementation::performDraw(ObjRefBase *pDrawObject, const MatrixSet &pMatrices) {
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+
+		if(ref->instanced) {
+			performDrawInstanced(ref, pMatrices, &pMatrices.object, 1);
+			return;
+		}
+
+		bindDrawState(ref);
+		++m_Counters.draws;
+		++m_Counters.instances;
+		log(Op::Draw, ref->id, ref->vertexCount);
+		AURORA_PROFILE_COUNT(Draws, 1);
+	}
+
+	void NullImplementation::performDrawInstanced(ObjRefBase *pDrawObject, const MatrixSet &,
+	                                              const glm::mat4 *, uint32_t pCount) {
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+		if(pCount == 0) { return; }
+
+		bindDrawState(ref);
+		m_Counters.instances += pCount;
+
+		if(!ref->instanced) {
+			for(uint32_t i = 0; i < pCount; ++i) { log(Op::Draw, ref->id, ref->vertexCount); }
+			m_Counters.draws += pCount;
+			AURORA_PROFILE_COUNT(Draws, pCount);
+			return;
+		}
+
+		// The matrices would be uploaded into the instance buffer.
+		auto bytes = static_cast<uint64_t>(pCount) * sizeof(glm::mat4);
+		m_Counters.bytesUploaded += bytes;
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, bytes);
+
+		++m_Counters.draws;
+		log(Op::DrawInstanced, ref->id, pCount);
+		AURORA_PROFILE_COUNT(Draws, 1);
+	}
+
+	void NullImplementation::setCameraUniforms(const glm::mat4 &, const glm::mat4 &, float) {
+		m_Counters.bytesUploaded += sizeof(CameraBlock);
+		log(Op::SetCamera, 0, sizeof(CameraBlock));
+		AURORA_PROFILE_COUNT(BufferBytesUploaded, sizeof(CameraBlock));
+	}
+
+	uint32_t NullImplementation::getDrawObjectStateKey(ObjRefBase *pDrawObject) {
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+
+		return ref->stateKey;
+	}
+
+	void NullImplementation::setDrawObjectRange(ObjRefBase *pDrawObject, size_t, uint32_t pIndexCount, int32_t) {
+		auto ref = dynamic_cast<DrawObjectReference *>(pDrawObject);
+		if(ref == nullptr) { throw EInvalidRef("invalid draw object reference"); }
+
+		ref->vertexCount = pIndexCount;
+	}
+}// namespace aurora
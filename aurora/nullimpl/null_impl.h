@@ -0,0 +1,311 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_NULL_IMPL_H
+#define AURORA_NULL_IMPL_H
+
+#include "../graphics/implementation.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace aurora {
+
+	/**
+	 * A backend that draws nothing and needs neither a GPU nor a window.
+	 *
+	 * Every call is checked the way a real backend would check it, and is
+	 * counted and appended to a command log. Scene traversal, culling,
+	 * batching and asset loading can then be benchmarked and tested on a
+	 * machine without a display, by looking at what reached the backend.
+	 *
+	 * Bindings are tracked like OpenGlStateCache tracks them, so only the
+	 * shader, texture and framebuffer changes a real backend would make are
+	 * counted as binds.
+	 */
+	class NullImplementation : public Implementation {
+	public:
+		enum class Op : uint8_t {
+			/** value: the ClearOptions bits, color first. */
+			Clear,
+			Create,
+			Destroy,
+			/** value: bytes written. */
+			UpdateBuffer,
+			/** value: bytes read. */
+			RetrieveBuffer,
+			/** value: bytes reserved. */
+			MapStreamBuffer,
+			/** value: bytes of pixel data. */
+			UpdateTexture,
+			UpdateMipmap,
+			/** Wrapping or filtering changed. */
+			SetTextureParameter,
+			/** value: the new width in the high and height in the low 32 bits. */
+			ReinitializeFramebuffer,
+			/** object: 0 for the default framebuffer. */
+			BindFramebuffer,
+			/** object: the source; value: the target, 0 for the default framebuffer. */
+			BlitFramebuffer,
+			/** object: the shader. */
+			BindShader,
+			/** value: the texture unit. */
+			BindTexture,
+			/** value: bytes of the Camera block. */
+			SetCamera,
+			/** value: the index count. */
+			Draw,
+			/** value: the instance count. */
+			DrawInstanced,
+			FinishFrame
+		};
+
+		/**
+		 * One call, or one binding it implied. object is the id of the
+		 * resource the call was about, or 0 where it had none.
+		 */
+		struct Command {
+			Op op;
+			uint32_t object;
+			uint64_t value;
+		};
+
+		struct Counters {
+			uint64_t creates = 0;
+			uint64_t destroys = 0;
+			/** Draw calls a real backend would issue; an instanced draw counts once. */
+			uint64_t draws = 0;
+			/** Objects drawn, counting every instance. */
+			uint64_t instances = 0;
+			uint64_t shaderBinds = 0;
+			uint64_t textureBinds = 0;
+			uint64_t framebufferBinds = 0;
+			uint64_t bytesUploaded = 0;
+			uint64_t bytesRetrieved = 0;
+			uint64_t frames = 0;
+		};
+
+		static constexpr int maxTextureSize = 16384;
+		static constexpr int max3DTextureSize = 2048;
+
+	private:
+		class Reference : public ObjRefBase {
+		public:
+			uint32_t id;
+
+			explicit Reference(uint32_t pId) : id(pId) {}
+
+			~Reference() override = default;
+		};
+
+		class ShaderReference : public Reference {
+		public:
+			bool instanced;
+
+			ShaderReference(uint32_t pId, bool pInstanced) : Reference(pId), instanced(pInstanced) {}
+		};
+
+		/*
+		 * Buffers keep their contents, so that retrieveBufferData() returns
+		 * what was written, and overflows are caught as they would be on a
+		 * GPU.
+		 */
+		class BufferReference : public Reference {
+		public:
+			BufferType type;
+			std::vector<uint8_t> data;
+
+			BufferReference(uint32_t pId, BufferType pType) : Reference(pId), type(pType) {}
+		};
+
+		class StreamBufferReference : public BufferReference {
+		public:
+			size_t head = 0;
+
+			// Bytes taken by the frame in frameNumber, skipped ones included.
+			size_t frameBytes = 0;
+			uint64_t frameNumber = 0;
+
+			StreamBufferReference(uint32_t pId, BufferType pType) : BufferReference(pId, pType) {}
+		};
+
+		class TextureReference : public Reference {
+		public:
+			int dimensions;
+
+			TextureReference(uint32_t pId, int pDimensions) : Reference(pId), dimensions(pDimensions) {}
+		};
+
+		class FramebufferReference : public Reference {
+		public:
+			TextureReference *colorTexture = nullptr;
+			TextureReference *depthTexture = nullptr;
+			int width = 0, height = 0;
+
+			explicit FramebufferReference(uint32_t pId) : Reference(pId) {}
+		};
+
+		class DefaultFramebufferReference : public Reference {
+		public:
+			DefaultFramebufferReference() : Reference(0) {}
+		};
+
+		/*
+		 * The state key is built like the OpenGL one, from the shader id and
+		 * a hash of the texture bindings, so that batching sorts the same way.
+		 */
+		class DrawObjectReference : public Reference {
+		public:
+			struct TextureBinding {
+				int unit;
+				uint32_t texture;
+			};
+
+			uint32_t shader;
+			bool instanced;
+			uint32_t vertexCount;
+			std::vector<TextureBinding> textures;
+			uint32_t stateKey = 0;
+
+			DrawObjectReference(uint32_t pId, uint32_t pShader, bool pInstanced, uint32_t pVertexCount)
+				: Reference(pId), shader(pShader), instanced(pInstanced), vertexCount(pVertexCount) {}
+		};
+
+		static constexpr int textureUnitCount = 32;
+
+		uint32_t m_NextId = 1;
+		std::vector<Command> m_Commands;
+		bool m_Recording = true;
+		Counters m_Counters;
+
+		uint32_t m_Shader = 0;
+		uint32_t m_Framebuffer = 0;
+		std::array<uint32_t, textureUnitCount> m_Textures{};
+
+		DefaultFramebufferReference m_DefaultFramebufferRef;
+
+		void log(Op pOp, uint32_t pObject, uint64_t pValue = 0);
+		uint32_t created();
+		void destroyed(uint32_t pId);
+		TextureReference *texture(ObjRefBase *pObject, int pDimensions);
+		BufferReference *buffer(ObjRefBase *pObject);
+		void bindFramebuffer(uint32_t pId);
+		void bindDrawState(DrawObjectReference *pRef);
+		void resizeFramebuffer(FramebufferReference *pRef, int pWidth, int pHeight);
+
+	public:
+		~NullImplementation() override = default;
+
+		/**
+		 * @return Every call logged since the last clearCommands().
+		 */
+		[[nodiscard]] const std::vector<Command> &getCommands() const { return m_Commands; }
+
+		void clearCommands() { m_Commands.clear(); }
+
+		/**
+		 * Turns the command log on or off. Counters are kept either way, so a
+		 * long benchmark can turn the log off and still read them.
+		 */
+		void setRecording(bool pRecording) { m_Recording = pRecording; }
+
+		[[nodiscard]] bool isRecording() const { return m_Recording; }
+
+		[[nodiscard]] const Counters &getCounters() const { return m_Counters; }
+
+		void resetCounters() { m_Counters = Counters(); }
+
+		/**
+		 * @return How many resources have been created and not yet destroyed.
+		 */
+		[[nodiscard]] uint64_t getLiveObjectCount() const { return m_Counters.creates - m_Counters.destroys; }
+
+		// See base class for documentation.
+
+		ObjRefBase *createShader(const aether::Shader &pShader) override;
+		void destroyShader(ObjRefBase *pObject) noexcept override;
+		void setupWindowHints() override;
+		void setupWindowPostCreate() override;
+		void updateViewportSize(int pWidth, int pHeight) override;
+		void performFinishFrame(Window *pWindow) override;
+		void setClearColor(float pRed, float pGreen, float pBlue, float pAlpha) override;
+		void performClear(ClearOptions pOptions) override;
+		ObjRefBase *createBuffer(BufferType pType) override;
+		void destroyBuffer(ObjRefBase *pObject) noexcept override;
+		void updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize) override;
+		void updateBufferData(ObjRefBase *pObject, const void *pData, size_t pSize, size_t pOffset) override;
+		void retrieveBufferData(ObjRefBase *pObject, void *pData, size_t pSize, size_t pOffset) override;
+		ObjRefBase *createStreamBuffer(BufferType pType, size_t pSize) override;
+		void destroyStreamBuffer(ObjRefBase *pObject) noexcept override;
+		StreamBufferRange mapStreamBuffer(ObjRefBase *pObject, size_t pSize, size_t pAlignment) override;
+		void unmapStreamBuffer(ObjRefBase *pObject) override;
+		ObjRefBase *createTexture1D() override;
+		void destroyTexture1D(ObjRefBase *pObject) noexcept override;
+		void setTexture1DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) override;
+		void setTexture1DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3 pColor) override;
+		void setTexture1DFilter(ObjRefBase *pObject, TextureMinFilter pMin, TextureMagFilter pMag) override;
+		void updateTexture1DData(ObjRefBase *pObject, int pWidth, const uint8_t *pDataRgba) override;
+		void updateTexture1DMipmap(ObjRefBase *pObject) override;
+		ObjRefBase *createTexture2D() override;
+		void destroyTexture2D(ObjRefBase *pObject) noexcept override;
+		void setTexture2DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) override;
+		void setTexture2DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3 pColor) override;
+		void setTexture2DFilter(ObjRefBase *pObject, TextureMinFilter pMin, TextureMagFilter pMag) override;
+		void updateTexture2DData(ObjRefBase *pObject, const sail::image &pImage) override;
+		void updateTexture2DData(ObjRefBase *pObject, int pWidth, int pHeight, const uint8_t *pDataRgba) override;
+		void updateTexture2DMipmap(ObjRefBase *pObject) override;
+		ObjRefBase *createTexture3D() override;
+		void destroyTexture3D(ObjRefBase *pObject) noexcept override;
+		void setTexture3DWrapProperty(ObjRefBase *pObject, TextureWrapType pWrap) override;
+		void setTexture3DWrapPropertyBorder(ObjRefBase *pObject, glm::vec3 pColor) override;
+		void setTexture3DFilter(ObjRefBase *pObject, TextureMinFilter pMin, TextureMagFilter pMag) override;
+		void updateTexture3DData(ObjRefBase *pObject, int pWidth, int pHeight, int pDepth,
+		                         const uint8_t *pDataRgba) override;
+		void updateTexture3DMipmap(ObjRefBase *pObject) override;
+		ObjRefBase *createFramebuffer(int pWidth, int pHeight) override;
+		void reinitializeFramebuffer(ObjRefBase *pObject, int pWidth, int pHeight) override;
+		void destroyFramebuffer(ObjRefBase *pObject) noexcept override;
+		ObjRefBase *getFramebufferColorTexture2D(ObjRefBase *pObject) override;
+		ObjRefBase *getFramebufferDepthTexture2D(ObjRefBase *pObject) override;
+		void performBlitFramebuffer(ObjRefBase *pSource, ObjRefBase *pTarget) override;
+		void performBlitFramebuffer(ObjRefBase *pSource, ObjRefBase *pTarget, int pSourceStartX, int pSourceStartY,
+		                            int pTargetStartX, int pTargetStartY, int pWidth, int pHeight) override;
+		ObjRefBase *getDefaultFramebuffer() override;
+		void activateFramebuffer(ObjRefBase *pObject) override;
+		ObjRefBase *createDrawObject(const DrawObjectOptions &pOptions) override;
+		void destroyDrawObject(ObjRefBase *pObject) noexcept override;
+		void performDraw(ObjRefBase *pDrawObject, const MatrixSet &pMatrices) override;
+		void setCameraUniforms(const glm::mat4 &pView, const glm::mat4 &pPerspective, float pTime) override;
+		void performDrawInstanced(ObjRefBase *pDrawObject, const MatrixSet &pMatrices, const glm::mat4 *pObjects,
+		                          uint32_t pCount) override;
+		uint32_t getDrawObjectStateKey(ObjRefBase *pDrawObject) override;
+		void setDrawObjectRange(ObjRefBase *pDrawObject, size_t pIndexOffset, uint32_t pIndexCount,
+		                        int32_t pBaseVertex) override;
+	};
+
+	/**
+	 * Always valid, and ranked below every real backend, so that it is only
+	 * picked when no other registered backend is valid.
+	 */
+	class NullImplementationNode : public Implementation::Node {
+	public:
+		~NullImplementationNode() override = default;
+
+		int getPriority() override {
+			return 0;
+		}
+
+		bool isValid() override {
+			return true;
+		}
+
+		Implementation *create() override {
+			return new NullImplementation;
+		}
+	};
+
+}// namespace aurora
+
+#endif// AURORA_NULL_IMPL_H
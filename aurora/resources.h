@@ -8,6 +8,8 @@
 
 #include "resources/shader.h"
 #include "resources/buffer.h"
+#include "resources/stream_buffer.h"
+#include "resources/mesh_heap.h"
 #include "resources/texture_2d.h"
 #include "resources/draw_object.h"
 
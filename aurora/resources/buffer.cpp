@@ -15,11 +15,11 @@ namespace aurora {
 		global->getImpl()->destroyBuffer(m_Reference);
 	}
 
-	void Buffer::update(void *pData, size_t pSize) {
+	void Buffer::update(const void *pData, size_t pSize) {
 		global->getImpl()->updateBufferData(m_Reference, pData, pSize);
 	}
 
-	void Buffer::update(void *pData, size_t pSize, size_t pOffset) {
+	void Buffer::update(const void *pData, size_t pSize, size_t pOffset) {
 		global->getImpl()->updateBufferData(m_Reference, pData, pSize, pOffset);
 	}
 
@@ -20,8 +20,8 @@ namespace aurora {
 		explicit Buffer(BufferType pType);
 		virtual ~Buffer();
 
-		virtual void update(void *pData, size_t pSize);
-		virtual void update(void *pData, size_t pSize, size_t pOffset);
+		virtual void update(const void *pData, size_t pSize);
+		virtual void update(const void *pData, size_t pSize, size_t pOffset);
 		virtual void retrieve(void *pData, size_t pSize, size_t pOffset);
 
 		ObjRefBase *getReference() const {
@@ -20,4 +20,8 @@ namespace aurora {
 	void DrawObject::draw(const MatrixSet &pMatrices) {
 		global->getImpl()->performDraw(m_Reference, pMatrices);
 	}
+
+	void DrawObject::setRange(size_t pIndexOffset, uint32_t pIndexCount, int32_t pBaseVertex) {
+		global->getImpl()->setDrawObjectRange(m_Reference, pIndexOffset, pIndexCount, pBaseVertex);
+	}
 } // aurora
\ No newline at end of file
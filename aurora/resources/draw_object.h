@@ -21,6 +21,18 @@ namespace aurora {
 		virtual ~DrawObject();
 
 		void draw(const MatrixSet &pMatrices = MatrixSet());
+
+		/**
+		 * Draws pIndexCount indices from pIndexOffset bytes into the index
+		 * buffer, adding pBaseVertex to each.
+		 *
+		 * @see Implementation::setDrawObjectRange()
+		 */
+		void setRange(size_t pIndexOffset, uint32_t pIndexCount, int32_t pBaseVertex = 0);
+
+		[[nodiscard]] ObjRefBase *getReference() const {
+			return m_Reference;
+		}
 	};
 
 } // aurora
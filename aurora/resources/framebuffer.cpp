@@ -8,11 +8,11 @@
 namespace aurora {
 	Framebuffer::Framebuffer(int pWidth, int pHeight) {
 		m_Reference = global->getImpl()->createFramebuffer(pWidth, pHeight);
-		global->getWindow()->addFramebuffer(this);
+		if(auto window = global->getWindow()) { window->addFramebuffer(this); }
 	}
 
 	Framebuffer::~Framebuffer() {
-		global->getWindow()->removeFramebuffer(this);
+		if(auto window = global->getWindow()) { window->removeFramebuffer(this); }
 		global->getImpl()->destroyFramebuffer(m_Reference);
 	}
 
@@ -6,14 +6,13 @@
 
 #include "icon.h"
 #include <aurora/aether/aether.h>
-#include <fstream>
 #include <sail-c++/sail-c++.h>
 
 namespace aurora {
-	Icon::Icon(AssetLoader*, const std::filesystem::path &pPath, const std::string&) {
-		auto j = nlohmann::json::from_cbor(std::ifstream(pPath));
-		aether::TextureMeta tex(j);
-		m_SailImage = new sail::image((absolute(pPath).parent_path() / tex.path).string());
+	Icon::Icon(AssetLoader *pAssetLoader, const aether::AssetSource &pSource, const std::string&) {
+		aether::TextureMeta tex(pSource.readCbor());
+		auto image = pAssetLoader->openFile(pSource.resolve(tex.path));
+		m_SailImage = new sail::image(sail::image_input(image.getData().data(), image.getData().size()).next_frame());
 		m_SailImage->convert(SAIL_PIXEL_FORMAT_BPP32_RGBA);
 		m_Image = new GLFWimage();
 		m_Image->width = (int)m_SailImage->width();
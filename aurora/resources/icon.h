@@ -21,10 +21,12 @@ namespace aurora {
 
 	public:
 		Icon(sail::image *pSailImage, GLFWimage *pImage) : m_SailImage(pSailImage), m_Image(pImage) {}
-		Icon(AssetLoader*, const std::filesystem::path &pPath, const std::string&);
+		Icon(AssetLoader *pAssetLoader, const aether::AssetSource &pSource, const std::string&);
 		virtual ~Icon();
 	};
 
+	template<> inline constexpr bool isContextFreeAsset<Icon> = true;
+
 } // aurora
 
 #endif //AURORA_ICON_H
@@ -0,0 +1,133 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "mesh_heap.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace aurora {
+	MeshHeap::Block::Block(size_t pVertexSize, size_t pIndexSize)
+		: vertexBuffer(VertexBuffer), indexBuffer(IndexBuffer), vertices(pVertexSize), indices(pIndexSize) {
+		vertexBuffer.update(nullptr, pVertexSize);
+		indexBuffer.update(nullptr, pIndexSize);
+	}
+
+	MeshHeap::MeshHeap(size_t pVertexBlockSize, size_t pIndexBlockSize)
+		: m_VertexBlockSize(pVertexBlockSize), m_IndexBlockSize(pIndexBlockSize) {}
+
+	MeshHeap::~MeshHeap() {
+		for(auto block: m_Blocks) {
+			delete block;
+		}
+	}
+
+	bool MeshHeap::place(uint32_t pBlock, size_t pVertexSize, size_t pStride, size_t pIndexSize,
+	                     Allocation &pAllocation) {
+		auto block = m_Blocks[pBlock];
+
+		auto vertexOffset = block->vertices.allocate(pVertexSize, pStride);
+		if(vertexOffset == RangeAllocator::invalid) { return false; }
+
+		auto indexOffset = block->indices.allocate(pIndexSize, indexAlignment);
+		if(indexOffset == RangeAllocator::invalid) {
+			block->vertices.free(vertexOffset, pVertexSize);
+			return false;
+		}
+
+		pAllocation = {pBlock, vertexOffset, pVertexSize, indexOffset, pIndexSize,
+		               static_cast<int32_t>(vertexOffset / pStride)};
+		return true;
+	}
+
+	MeshHeap::Block *MeshHeap::getBlock(const Allocation &pAllocation) const {
+		if(pAllocation.block >= m_Blocks.size() || m_Blocks[pAllocation.block] == nullptr) {
+			throw std::runtime_error("allocation is not from this mesh heap");
+		}
+
+		return m_Blocks[pAllocation.block];
+	}
+
+	MeshHeap::Allocation MeshHeap::allocate(const void *pVertices, size_t pVertexSize, size_t pStride,
+	                                        const void *pIndices, size_t pIndexSize) {
+		if(pVertexSize == 0 || pIndexSize == 0) { throw std::runtime_error("mesh has no vertices or indices"); }
+		if(pStride == 0 || pVertexSize % pStride != 0) {
+			throw std::runtime_error("vertex data is not a whole number of vertices");
+		}
+
+		Allocation allocation;
+		bool placed = false;
+		for(uint32_t i = 0; i < m_Blocks.size() && !placed; ++i) {
+			if(m_Blocks[i] != nullptr) { placed = place(i, pVertexSize, pStride, pIndexSize, allocation); }
+		}
+
+		if(!placed) {
+			// A new block starts empty, so a mesh that fits its size always
+			// fits in it.
+			auto block = new Block(std::max(m_VertexBlockSize, pVertexSize), std::max(m_IndexBlockSize, pIndexSize));
+			auto slot = static_cast<uint32_t>(std::find(m_Blocks.begin(), m_Blocks.end(), nullptr) - m_Blocks.begin());
+			if(slot == m_Blocks.size()) {
+				m_Blocks.push_back(block);
+			} else {
+				m_Blocks[slot] = block;
+			}
+
+			place(slot, pVertexSize, pStride, pIndexSize, allocation);
+		}
+
+		try {
+			auto block = m_Blocks[allocation.block];
+			block->vertexBuffer.update(pVertices, pVertexSize, allocation.vertexOffset);
+			block->indexBuffer.update(pIndices, pIndexSize, allocation.indexOffset);
+		} catch(...) {
+			free(allocation);
+			throw;
+		}
+
+		return allocation;
+	}
+
+	void MeshHeap::free(const Allocation &pAllocation) {
+		auto block = getBlock(pAllocation);
+
+		// Both ranges are checked before either is given back, so that a bad
+		// free leaves the heap as it was.
+		if(!block->vertices.isAllocated(pAllocation.vertexOffset, pAllocation.vertexSize) ||
+		   !block->indices.isAllocated(pAllocation.indexOffset, pAllocation.indexSize)) {
+			throw std::runtime_error("allocation has already been freed");
+		}
+
+		block->vertices.free(pAllocation.vertexOffset, pAllocation.vertexSize);
+		block->indices.free(pAllocation.indexOffset, pAllocation.indexSize);
+
+		// The first block is kept, so that a level loading and unloading a
+		// single mesh does not create and destroy buffers each time.
+		if(pAllocation.block > 0 && block->vertices.isEmpty() && block->indices.isEmpty()) {
+			delete block;
+			m_Blocks[pAllocation.block] = nullptr;
+		}
+	}
+
+	DrawObject *MeshHeap::createDrawObject(const Allocation &pAllocation, const DrawObjectOptions &pOptions) {
+		auto block = getBlock(pAllocation);
+
+		auto options = pOptions;
+		options.vertexBuffer = block->vertexBuffer.getReference();
+		options.indexBuffer = block->indexBuffer.getReference();
+
+		auto drawObject = new DrawObject(options);
+		try {
+			drawObject->setRange(pAllocation.indexOffset, options.vertexCount, pAllocation.baseVertex);
+		} catch(...) {
+			delete drawObject;
+			throw;
+		}
+
+		return drawObject;
+	}
+
+	size_t MeshHeap::getBlockCount() const {
+		return m_Blocks.size() - std::count(m_Blocks.begin(), m_Blocks.end(), nullptr);
+	}
+} // aurora
@@ -0,0 +1,120 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_MESH_HEAP_H
+#define AURORA_MESH_HEAP_H
+
+#include "buffer.h"
+#include "draw_object.h"
+#include "../graphics/range_allocator.h"
+#include <vector>
+
+namespace aurora {
+
+	/**
+	 * Packs the geometry of many meshes into a few large vertex and index
+	 * buffers, so that a level does not create a pair of buffers for every
+	 * mesh it draws.
+	 *
+	 * The buffers are allocated in blocks, each a vertex buffer and an index
+	 * buffer of fixed size. A mesh is placed in the first block with room
+	 * for both its vertices and its indices, and is drawn from there with a
+	 * base vertex. Draw objects of meshes in one block read the same
+	 * buffers, so the backend can draw them one after another without
+	 * switching vertex state.
+	 */
+	class MeshHeap {
+	public:
+		/**
+		 * Where a mesh was placed. Offsets and sizes are in bytes.
+		 */
+		struct Allocation {
+			uint32_t block = 0;
+			size_t vertexOffset = 0, vertexSize = 0;
+			size_t indexOffset = 0, indexSize = 0;
+
+			/**
+			 * The index of the first vertex of the mesh in the vertex buffer,
+			 * to be added to each of its indices.
+			 */
+			int32_t baseVertex = 0;
+		};
+
+		static constexpr size_t defaultVertexBlockSize = 32 * 1024 * 1024;
+		static constexpr size_t defaultIndexBlockSize = 8 * 1024 * 1024;
+
+	private:
+		// Indices are aligned for the largest index type.
+		static constexpr size_t indexAlignment = sizeof(uint32_t);
+
+		struct Block {
+			Buffer vertexBuffer, indexBuffer;
+			RangeAllocator vertices, indices;
+
+			Block(size_t pVertexSize, size_t pIndexSize);
+		};
+
+		size_t m_VertexBlockSize, m_IndexBlockSize;
+
+		// Blocks emptied by free() are destroyed and leave a nullptr behind,
+		// so that the indices of the others stay valid.
+		std::vector<Block *> m_Blocks;
+
+		bool place(uint32_t pBlock, size_t pVertexSize, size_t pStride, size_t pIndexSize, Allocation &pAllocation);
+		Block *getBlock(const Allocation &pAllocation) const;
+
+	public:
+		/**
+		 * @param pVertexBlockSize Size (in bytes) of the vertex buffer of each
+		 * block. A mesh with more vertex data gets a block of its own.
+		 * @param pIndexBlockSize Likewise for the index buffers.
+		 */
+		explicit MeshHeap(size_t pVertexBlockSize = defaultVertexBlockSize,
+		                  size_t pIndexBlockSize = defaultIndexBlockSize);
+		virtual ~MeshHeap();
+
+		MeshHeap(const MeshHeap &) = delete;
+		MeshHeap &operator=(const MeshHeap &) = delete;
+
+		/**
+		 * Places a mesh in the heap and uploads its geometry.
+		 *
+		 * @param pVertices Interleaved vertex data.
+		 * @param pVertexSize Size (in bytes) of the vertex data.
+		 * @param pStride Size (in bytes) of one vertex. The vertex data is
+		 * aligned to it, so that it starts at a whole vertex.
+		 * @param pIndices Index data, of any index type.
+		 * @param pIndexSize Size (in bytes) of the index data.
+		 * @throws std::runtime_error The mesh is empty, or its vertex data is
+		 * not a whole number of vertices.
+		 */
+		Allocation allocate(const void *pVertices, size_t pVertexSize, size_t pStride, const void *pIndices,
+		                    size_t pIndexSize);
+
+		/**
+		 * Gives the space of a mesh back to the heap. Draw objects created
+		 * for it have to be destroyed first.
+		 *
+		 * @throws std::runtime_error The allocation is not from this heap,
+		 * or has already been freed. The heap is left as it was.
+		 */
+		void free(const Allocation &pAllocation);
+
+		/**
+		 * Creates a draw object drawing the mesh of an allocation. The
+		 * buffers in pOptions are replaced with those of its block, and
+		 * pOptions.vertexCount is the number of indices of the mesh.
+		 */
+		DrawObject *createDrawObject(const Allocation &pAllocation, const DrawObjectOptions &pOptions);
+
+		/**
+		 * @return How many blocks, and so pairs of buffers, are allocated.
+		 */
+		[[nodiscard]] size_t getBlockCount() const;
+	};
+
+} // aurora
+
+#endif //AURORA_MESH_HEAP_H
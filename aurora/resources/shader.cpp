@@ -31,6 +31,6 @@ namespace aurora {
 		global->getImpl()->destroyShader(m_Reference);
 	}
 
-	Shader::Shader(AssetLoader *pLoader, const std::filesystem::path &pPath, const std::string &pAssetId)
-		: Shader(*pLoader->load<aether::Shader>(pAssetId)) {}
+	Shader::Shader(AssetLoader *pLoader, const aether::AssetSource &pSource, const std::string &pAssetId)
+		: Shader(stage(pLoader, pSource, pAssetId)) {}
 }// namespace aurora
\ No newline at end of file
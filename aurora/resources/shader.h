@@ -22,7 +22,14 @@ namespace aurora {
 		VertexArrangement m_Arrangement;
 
 	public:
-		Shader(AssetLoader *pLoader, const std::filesystem::path &pPath, const std::string &pAssetId);
+		using Staging = aether::Shader;
+
+		static Staging stage(AssetLoader *, const aether::AssetSource &pSource, const std::string &) {
+			return aether::Shader(pSource.readCbor());
+		}
+
+		Shader(AssetLoader *pLoader, const aether::AssetSource &pSource, const std::string &pAssetId);
+		Shader(AssetLoader *, const Staging &pStaging, const std::string &) : Shader(pStaging) {}
 		explicit Shader(const aether::Shader &pShader);
 		virtual ~Shader();
 
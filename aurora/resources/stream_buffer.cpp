@@ -0,0 +1,32 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "stream_buffer.h"
+#include "../global.h"
+#include <cstring>
+
+namespace aurora {
+	StreamBuffer::StreamBuffer(BufferType pType, size_t pSize)
+		: m_Reference(global->getImpl()->createStreamBuffer(pType, pSize)) {}
+
+	StreamBuffer::~StreamBuffer() {
+		global->getImpl()->destroyStreamBuffer(m_Reference);
+	}
+
+	StreamBufferRange StreamBuffer::map(size_t pSize, size_t pAlignment) {
+		return global->getImpl()->mapStreamBuffer(m_Reference, pSize, pAlignment);
+	}
+
+	void StreamBuffer::unmap() {
+		global->getImpl()->unmapStreamBuffer(m_Reference);
+	}
+
+	size_t StreamBuffer::write(const void *pData, size_t pSize, size_t pAlignment) {
+		auto range = map(pSize, pAlignment);
+		if(pSize > 0) { std::memcpy(range.data, pData, pSize); }
+		unmap();
+		return range.offset;
+	}
+} // aurora
@@ -0,0 +1,59 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_STREAM_BUFFER_H
+#define AURORA_STREAM_BUFFER_H
+
+#include "../graphics/obj_ref_base.h"
+#include "../graphics/implementation.h"
+
+namespace aurora {
+
+	/**
+	 * A buffer for data that is rewritten every frame, such as dynamic
+	 * geometry, particles or per-frame uniforms.
+	 *
+	 * Each write goes to the next free range of a ring, so nothing waits for
+	 * the GPU to finish with what was written before. Draw objects read a
+	 * written range through DrawObject::setRange().
+	 *
+	 * A range stays valid until the end of the frame it was written in, so
+	 * the ring has to hold every write of one frame; map() throws
+	 * EBufferOverflow rather than reuse a range of the current frame.
+	 */
+	class StreamBuffer {
+	private:
+		ObjRefBase *m_Reference;
+
+	public:
+		/**
+		 * @param pSize Size (in bytes) of the ring. It must hold one frame of
+		 * writes, and should hold a few.
+		 */
+		StreamBuffer(BufferType pType, size_t pSize);
+		virtual ~StreamBuffer();
+
+		/**
+		 * Reserves the next pSize bytes for writing. unmap() has to be called
+		 * once they are written, and before anything is drawn from them.
+		 */
+		StreamBufferRange map(size_t pSize, size_t pAlignment = 1);
+		void unmap();
+
+		/**
+		 * Copies data into the next free range.
+		 *
+		 * @return Offset (in bytes) of the data in the buffer.
+		 */
+		size_t write(const void *pData, size_t pSize, size_t pAlignment = 1);
+
+		[[nodiscard]] ObjRefBase *getReference() const {
+			return m_Reference;
+		}
+	};
+
+} // aurora
+
+#endif //AURORA_STREAM_BUFFER_H
@@ -5,7 +5,6 @@
 
 #include "texture_2d.h"
 #include "../global.h"
-#include <fstream>
 
 namespace aurora {
 	Texture2D::Texture2D(ObjRefBase *pReference) : m_Reference(pReference) {}
@@ -34,32 +33,44 @@ namespace aurora {
 	void Texture2D::update(const sail::image &pImage, bool pUpdateMipmaps) {
 		auto i = global->getImpl();
 		i->updateTexture2DData(m_Reference, pImage);
-		if(pUpdateMipmaps) { i->updateTexture2DMipmap(m_Reference); }
+		m_BaseLevelBytes = size_t(pImage.width()) * pImage.height() * 4;
+		m_HasMipmaps = false;
+		if(pUpdateMipmaps) { updateMipmaps(); }
 	}
 
 	void Texture2D::updateMipmaps() {
 		global->getImpl()->updateTexture2DMipmap(m_Reference);
+		m_HasMipmaps = true;
 	}
 
-	Texture2D::Texture2D(AssetLoader *, const std::filesystem::path &pPath, const std::string &pAssetId) : Texture2D() {
-		if(!exists(pPath)) { throw std::runtime_error("Asset " + pAssetId + ": cannot find " + pPath.string()); }
+	Texture2D::Staging Texture2D::stage(AssetLoader *pAssetLoader, const aether::AssetSource &pSource,
+	                                    const std::string &pAssetId) {
+		auto meta = aether::TextureMeta(pSource.readCbor());
+		auto image = pAssetLoader->openFile(pSource.resolve(meta.path));
+		auto img = sail::image_input(image.getData().data(), image.getData().size()).next_frame();
+		if(!img.is_valid()) { throw std::runtime_error("Asset " + pAssetId + ": cannot decode " + meta.path); }
 
-		sail::image img;
-		auto absPath = absolute(pPath);
-		auto meta = aether::TextureMeta(nlohmann::json::from_cbor(std::ifstream(absPath)));
-		auto texPath = absPath.parent_path() / meta.path;
-		img.load(absolute(texPath).string());
+		return {std::move(meta), std::move(img)};
+	}
+
+	Texture2D::Texture2D(AssetLoader *pAssetLoader, const aether::AssetSource &pSource, const std::string &pAssetId)
+		: Texture2D(pAssetLoader, stage(pAssetLoader, pSource, pAssetId), pAssetId) {}
+
+	Texture2D::Texture2D(AssetLoader *, Staging pStaging, const std::string &) : Texture2D() {
+		const auto &meta = pStaging.meta;
 
 		if(meta.wrap == TextureWrapType::BorderColor) { setWrap(meta.wrap, meta.borderColor); }
 		else { setWrap(meta.wrap); }
 		setFilters(meta.minFilter, meta.magFilter);
-		update(img, meta.useMipmap);
+		update(pStaging.image, meta.useMipmap);
 	}
 
 	void Texture2D::update(int pWidth, int pHeight, const uint8_t *pDataRgba, bool pUpdateMipmaps) {
 		auto i = global->getImpl();
 		i->updateTexture2DData(m_Reference, pWidth, pHeight, pDataRgba);
-		if(pUpdateMipmaps) { i->updateTexture2DMipmap(m_Reference); }
+		m_BaseLevelBytes = size_t(pWidth) * pHeight * 4;
+		m_HasMipmaps = false;
+		if(pUpdateMipmaps) { updateMipmaps(); }
 	}
 
 	const std::string Texture2D::missingAssetName = "aurora:_internal/missing.texture";
@@ -15,13 +15,29 @@ namespace aurora {
 	class Texture2D {
 	private:
 		ObjRefBase *m_Reference;
+		size_t m_BaseLevelBytes = 0;
+		bool m_HasMipmaps = false;
 
 	public:
 		static const std::string missingAssetName;
 
+		struct Staging {
+			aether::TextureMeta meta;
+			sail::image image;
+		};
+
+		/**
+		 * Reads the texture metadata and decodes its image. Does not touch the
+		 * graphics context, so it is safe to call from a loader worker thread.
+		 *
+		 * @throws std::runtime_error The image cannot be found or decoded.
+		 */
+		static Staging stage(AssetLoader *pAssetLoader, const aether::AssetSource &pSource, const std::string &pAssetId);
+
 		explicit Texture2D(ObjRefBase *pReference);
 		Texture2D();
-		Texture2D(AssetLoader *pAssetLoader, const std::filesystem::path &pPath, const std::string &pAssetId);
+		Texture2D(AssetLoader *pAssetLoader, const aether::AssetSource &pSource, const std::string &pAssetId);
+		Texture2D(AssetLoader *, Staging pStaging, const std::string &);
 		virtual ~Texture2D();
 
 		void setWrap(TextureWrapType pWrap);
@@ -34,6 +50,11 @@ namespace aurora {
 		ObjRefBase *getReference() const {
 			return m_Reference;
 		}
+
+		[[nodiscard]] AssetFootprint getFootprint() const {
+			// A full mip chain adds a third on top of the base level.
+			return {sizeof(Texture2D), m_BaseLevelBytes + (m_HasMipmaps ? m_BaseLevelBytes / 3 : 0)};
+		}
 	};
 
 } // aurora
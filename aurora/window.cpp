@@ -21,8 +21,14 @@ namespace aurora {
 			throw std::runtime_error(desc);
 		}
 
+		int width, height;
+		glfwGetWindowSize(m_Window, &width, &height);
+		m_Width = width;
+		m_Height = height;
+
 		glfwSetWindowUserPointer(m_Window, this);
 		glfwSetWindowSizeCallback(m_Window, staticWindowSizeChanged);
+		glfwSetWindowIconifyCallback(m_Window, staticWindowIconified);
 
 		glfwMakeContextCurrent(m_Window);
 		global->getImpl()->setupWindowPostCreate();
@@ -37,12 +43,18 @@ namespace aurora {
 		if(pWidth == 0 || pHeight == 0) return;
 
 		auto self = reinterpret_cast<Window *>(glfwGetWindowUserPointer(pWindow));
+		self->m_Width = pWidth;
+		self->m_Height = pHeight;
 		global->getImpl()->updateViewportSize(pWidth, pHeight);
 		for(const auto &item: self->m_Framebuffers) {
 			item->reinitialize(pWidth, pHeight);
 		}
 	}
 
+	void Window::staticWindowIconified(GLFWwindow *pWindow, int pIconified) {
+		reinterpret_cast<Window *>(glfwGetWindowUserPointer(pWindow))->m_Iconified = pIconified == GLFW_TRUE;
+	}
+
 	bool Window::shouldWindowBeOpen() {
 		return !glfwWindowShouldClose(m_Window);
 	}
@@ -56,11 +68,9 @@ namespace aurora {
 	}
 
 	glm::ivec2 Window::getSize() {
-		int w, h;
-		glfwGetWindowSize(m_Window, &w, &h);
 		return {
-			w,
-			h
+			m_Width.load(),
+			m_Height.load()
 		};
 	}
 
@@ -78,11 +88,11 @@ namespace aurora {
 	}
 
 	bool Window::isVisible() {
-		return glfwGetWindowAttrib(m_Window, GLFW_VISIBLE);
+		return m_Visible;
 	}
 
 	bool Window::isIconified() {
-		return glfwGetWindowAttrib(m_Window, GLFW_ICONIFIED);
+		return m_Iconified;
 	}
 
 	bool Window::isReallyVisible() {
@@ -91,10 +101,12 @@ namespace aurora {
 
 	void Window::hide() {
 		glfwHideWindow(m_Window);
+		m_Visible = false;
 	}
 
 	void Window::show() {
 		glfwShowWindow(m_Window);
+		m_Visible = true;
 	}
 
 	void Window::pollEvents() {
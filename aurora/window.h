@@ -6,6 +6,7 @@
 #ifndef AURORA_WINDOW_H
 #define AURORA_WINDOW_H
 
+#include <atomic>
 #include <string>
 #include <GLFW/glfw3.h>
 #include <glm/vec2.hpp>
@@ -20,6 +21,12 @@ namespace aurora {
 		std::string m_Title;
 		std::vector<Framebuffer *> m_Framebuffers;
 
+		// Kept up to date by GLFW callbacks, so that threads other than the
+		// main thread can ask for them; GLFW itself only answers there.
+		std::atomic<int> m_Width, m_Height;
+		std::atomic<bool> m_Visible = true;
+		std::atomic<bool> m_Iconified = false;
+
 	public:
 		Window(int pWidth, int pHeight, const std::string &pTitle, bool pIsFullscreen);
 		virtual ~Window();
@@ -49,6 +56,7 @@ namespace aurora {
 
 	private:
 		static void staticWindowSizeChanged([[maybe_unused]] GLFWwindow *pWindow, int pWidth, int pHeight);
+		static void staticWindowIconified(GLFWwindow *pWindow, int pIconified);
 	};
 
 }// namespace aurora
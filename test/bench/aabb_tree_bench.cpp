@@ -0,0 +1,128 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "../unit/headless.h"
+#include "aurora/graphics/render_queue.h"
+#include "aurora/level/aabb_tree.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace aurora;
+using namespace aurora::level;
+
+namespace {
+	// Objects are spread through a cube of this half-size around the camera.
+	constexpr float worldSize = 1000;
+
+	struct Item {
+		glm::mat4 object;
+		aether::Bounds bounds;
+	};
+
+	double millisecondsSince(std::chrono::steady_clock::time_point pStart) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pStart).count();
+	}
+
+	// The best of a few runs, to keep page faults and frequency ramp-up out.
+	template<typename F>
+	double bestOf(F &&pRun) {
+		double best = 1e300;
+		for(int run = 0; run < 3; ++run) {
+			auto start = std::chrono::steady_clock::now();
+			pRun();
+			best = std::min(best, millisecondsSince(start));
+		}
+		return best;
+	}
+}
+
+/*
+ * Indexes growing numbers of unit boxes and draws what a camera sees on the
+ * null backend, once by querying the tree and submitting the visible boxes,
+ * and once by submitting every box and leaving the render queue to cull
+ * them. Building, moving within the margin and querying should stay close
+ * to n log n, n and the visible count respectively.
+ */
+int main() {
+	HeadlessInstance instance("aurora_aabb_tree_bench");
+	auto &impl = instance.getImpl();
+	impl.setRecording(false);
+
+	auto shader = impl.createShader(aether::Shader());
+	auto vertices = impl.createBuffer(VertexBuffer);
+	auto indices = impl.createBuffer(IndexBuffer);
+	auto drawObject = impl.createDrawObject({
+		                                        .shader = shader, .vertexBuffer = vertices, .indexBuffer = indices,
+		                                        .vertexCount = 36
+	                                        });
+
+	aether::Bounds unit{{-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}};
+	auto perspective = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+
+	std::printf("%10s %10s %10s %10s %10s %10s %10s\n", "proxies", "visible", "build ms", "move ms", "reinserts",
+	            "tree ms", "flat ms");
+	for(size_t count = 10000; count <= 1000000; count *= 10) {
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> position(-worldSize, worldSize);
+		std::uniform_real_distribution<float> jitter(-0.05f, 0.05f);
+
+		std::vector<Item> items(count);
+		for(auto &item: items) {
+			item.object = glm::translate(glm::identity<glm::mat4>(),
+			                             glm::vec3(position(random), position(random), position(random)));
+			item.bounds = AabbTree::transform(unit, item.object);
+		}
+
+		AabbTree tree;
+		std::vector<AabbTree::Proxy> proxies(count);
+		auto start = std::chrono::steady_clock::now();
+		for(size_t i = 0; i < count; ++i) { proxies[i] = tree.createProxy(items[i].bounds, &items[i]); }
+		auto build = millisecondsSince(start);
+
+		// Moves smaller than the margin, as most objects make from one tick
+		// to the next.
+		size_t reinserts = 0;
+		start = std::chrono::steady_clock::now();
+		for(size_t i = 0; i < count; ++i) {
+			auto offset = glm::vec3(jitter(random), jitter(random), jitter(random));
+			reinserts += tree.moveProxy(proxies[i], {items[i].bounds.min + offset, items[i].bounds.max + offset});
+		}
+		auto move = millisecondsSince(start);
+
+		RenderQueue queue;
+		auto state = impl.getDrawObjectStateKey(drawObject);
+		size_t visible = 0;
+
+		auto viaTree = bestOf([&] {
+			queue.begin(glm::identity<glm::mat4>(), perspective);
+			tree.query(queue.getFrustum(), [&](AabbTree::Proxy pProxy) {
+				auto item = static_cast<const Item *>(tree.getUserData(pProxy));
+				queue.submit(RenderQueue::makeKey(0, state, -item->object[3].z), drawObject, item->object);
+				return true;
+			});
+			visible = queue.size();
+			queue.execute();
+		});
+
+		auto flat = bestOf([&] {
+			queue.begin(glm::identity<glm::mat4>(), perspective);
+			for(const auto &item: items) {
+				queue.submit(RenderQueue::makeKey(0, state, -item.object[3].z), drawObject, item.object,
+				             glm::vec4(unit.getCenter(), unit.getRadius()));
+			}
+			queue.execute();
+		});
+
+		std::printf("%10zu %10zu %10.2f %10.2f %10zu %10.2f %10.2f\n", count, visible, build, move, reinserts,
+		            viaTree, flat);
+	}
+
+	impl.destroyDrawObject(drawObject);
+	impl.destroyBuffer(vertices);
+	impl.destroyBuffer(indices);
+	impl.destroyShader(shader);
+}
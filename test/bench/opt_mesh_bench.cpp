@@ -0,0 +1,68 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "aurora/aether/aether.h"
+#include <chrono>
+#include <cstdio>
+
+using namespace aurora::aether;
+
+namespace {
+	// A flat grid of pSide by pSide quads, two triangles each.
+	Mesh grid(int pSide) {
+		Mesh mesh;
+		mesh.normals.emplace_back(0, 0, 1);
+		for(int y = 0; y <= pSide; ++y) {
+			for(int x = 0; x <= pSide; ++x) {
+				mesh.positions.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.0f);
+				mesh.texCoords.emplace_back(static_cast<float>(x) / static_cast<float>(pSide),
+				                            static_cast<float>(y) / static_cast<float>(pSide));
+			}
+		}
+
+		auto at = [pSide](int pX, int pY) { return pY * (pSide + 1) + pX; };
+		for(int y = 0; y < pSide; ++y) {
+			for(int x = 0; x < pSide; ++x) {
+				int a = at(x, y), b = at(x + 1, y), c = at(x, y + 1), d = at(x + 1, y + 1);
+				mesh.tris.push_back({{a, b, c}, {a, b, c}, {0, 0, 0}});
+				mesh.tris.push_back({{c, b, d}, {c, b, d}, {0, 0, 0}});
+			}
+		}
+
+		return mesh;
+	}
+
+	double weldMilliseconds(const Mesh &pMesh, const Shader &pShader, float pEpsilon) {
+		// The best of a few runs, to keep page faults and frequency ramp-up out.
+		double best = 1e300;
+		for(int run = 0; run < 3; ++run) {
+			auto start = std::chrono::steady_clock::now();
+			OptimisedMesh mesh(pMesh, pShader, {1, 1, 1, 1}, pEpsilon);
+			auto end = std::chrono::steady_clock::now();
+			best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+		return best;
+	}
+}
+
+/*
+ * Welds grids of growing size. The time per triangle staying flat as the
+ * triangle count doubles shows that welding scales linearly.
+ */
+int main() {
+	Shader shader;
+	shader.vertexNodes.emplace_back("v_position", "Float", "position3", 3);
+	shader.vertexNodes.emplace_back("v_texCoord", "Float", "tex2", 2);
+
+	std::printf("%10s %12s %12s %12s %12s\n", "triangles", "exact ms", "exact ns/tri", "near ms", "near ns/tri");
+	for(int side = 64; side <= 1024; side *= 2) {
+		auto mesh = grid(side);
+		auto tris = static_cast<double>(mesh.tris.size());
+		auto exact = weldMilliseconds(mesh, shader, 0.0f);
+		auto near = weldMilliseconds(mesh, shader, 1e-4f);
+		std::printf("%10zu %12.2f %12.1f %12.2f %12.1f\n", mesh.tris.size(), exact, exact * 1e6 / tris, near,
+		            near * 1e6 / tris);
+	}
+}
@@ -22,8 +22,8 @@ public:
 		a->unload<aurora::Icon>(m_WindowIcon);
 	}
 
-	void render() override {
-		Application::render();
+	void render(float pAlpha) override {
+		Application::render(pAlpha);
 	}
 
 	void update() override {
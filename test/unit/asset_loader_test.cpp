@@ -0,0 +1,155 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "aurora/asset_loader.h"
+#include "check.h"
+#include <fstream>
+#include <random>
+
+namespace {
+	std::atomic<int> liveBlobs = 0;
+	std::thread::id contextThread;
+
+	/*
+	 * An asset that only checks that it is never used after being destroyed.
+	 */
+	struct Blob {
+		static constexpr uint32_t aliveMagic = 0xa11fe, deadMagic = 0xdead;
+
+		std::string id;
+		uint32_t magic = aliveMagic;
+
+		Blob(aurora::AssetLoader *, const aurora::aether::AssetSource &, const std::string &pId) : id(pId) {
+			liveBlobs++;
+		}
+
+		~Blob() {
+			CHECK(magic == aliveMagic);
+			magic = deadMagic;
+			liveBlobs--;
+		}
+	};
+
+	/*
+	 * Stands in for an asset with GPU objects, which may only be created and
+	 * destroyed on the context thread.
+	 */
+	struct GpuBlob : Blob {
+		GpuBlob(aurora::AssetLoader *pLoader, const aurora::aether::AssetSource &pSource, const std::string &pId)
+			: Blob(pLoader, pSource, pId) {
+			CHECK(std::this_thread::get_id() == contextThread);
+		}
+
+		~GpuBlob() {
+			CHECK(std::this_thread::get_id() == contextThread);
+		}
+	};
+
+	/*
+	 * An asset created outside the loader and injected into it.
+	 */
+	struct Builtin {
+		Builtin() {
+			liveBlobs++;
+		}
+
+		~Builtin() {
+			CHECK(std::this_thread::get_id() == contextThread);
+			liveBlobs--;
+		}
+	};
+}
+
+template<> inline constexpr bool aurora::isContextFreeAsset<Blob> = true;
+
+int main() {
+	constexpr int threadCount = 8, idCount = 32, iterations = 20000;
+
+	auto root = std::filesystem::temp_directory_path() / "aurora_asset_loader_test";
+	std::filesystem::create_directories(root);
+	{
+		std::vector<aurora::aether::Pack::Entry> entries;
+		for(int i = 0; i < idCount; ++i) {
+			entries.push_back({"blob" + std::to_string(i), "blob" + std::to_string(i), {1}});
+			entries.push_back({"gpu" + std::to_string(i), "gpu" + std::to_string(i), {1}});
+		}
+		std::ofstream out(root / aurora::aether::Pack::fileName, std::ios::binary);
+		aurora::aether::Pack::write(out, entries);
+	}
+
+	{
+		contextThread = std::this_thread::get_id();
+		aurora::AssetLoader loader(root);
+		loader.inject("builtin", new Builtin);
+
+		// Room for a few unreferenced blobs only, so that threads keep
+		// evicting assets that others are about to load again.
+		loader.setCacheBudget({4 * sizeof(Blob), 0});
+
+		std::vector<std::thread> threads;
+		std::atomic<int> finished = 0;
+		for(int t = 0; t < threadCount; ++t) {
+			threads.emplace_back([&loader, &finished, t]() {
+				std::mt19937 random(t);
+				std::vector<Blob *> held;
+
+				for(int i = 0; i < iterations; ++i) {
+					auto id = "blob" + std::to_string(random() % idCount);
+					switch(random() % 5) {
+						case 0:
+						case 1: {
+							auto blob = loader.load<Blob>(id);
+							CHECK(blob->magic == Blob::aliveMagic && blob->id == id);
+							held.push_back(blob);
+							break;
+						}
+						case 2: {
+							auto blob = loader.loadAsync<Blob>(id).get();
+							CHECK(blob->magic == Blob::aliveMagic && blob->id == id);
+							held.push_back(blob);
+							break;
+						}
+						case 3: {
+							id = "gpu" + id.substr(4);
+							Blob *blob = loader.loadAsync<GpuBlob>(id).get();
+							CHECK(blob->magic == Blob::aliveMagic && blob->id == id);
+							held.push_back(blob);
+							break;
+						}
+						default:
+							if(!held.empty()) {
+								auto index = random() % held.size();
+								CHECK(held[index]->magic == Blob::aliveMagic);
+								loader.unload(held[index]);
+								held[index] = held.back();
+								held.pop_back();
+							}
+							if(t == 0 && i % 1000 == 0) { loader.clearCache(); }
+							break;
+					}
+				}
+
+				for(auto blob: held) { loader.unload(blob); }
+				finished++;
+			});
+		}
+
+		// This thread owns the loader, and so runs whatever it queues for
+		// the context thread.
+		while(finished < threadCount) { loader.pumpUploads(std::chrono::milliseconds(1)); }
+		for(auto &thread: threads) { thread.join(); }
+		loader.pumpUploads(std::chrono::milliseconds(1));
+
+		// The injected asset is not in the cache.
+		auto stats = loader.getCacheStats();
+		CHECK(static_cast<size_t>(liveBlobs) == stats.cached + 1);
+		CHECK(stats.cpuBytes == stats.cached * sizeof(Blob));
+	}
+
+	// The loader destroys what it still holds, cached or injected.
+	CHECK(liveBlobs == 0);
+
+	std::filesystem::remove_all(root);
+}
@@ -0,0 +1,42 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_TEST_CHECK_H
+#define AURORA_TEST_CHECK_H
+
+#include <cstdio>
+#include <cstdlib>
+
+/*
+ * Fails the test, which is a plain executable run by ctest, when a condition
+ * does not hold. Unlike assert() it is kept in release builds.
+ */
+#define CHECK(pCondition)                                                                              \
+	do {                                                                                               \
+		if(!(pCondition)) {                                                                            \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #pCondition);       \
+			std::exit(1);                                                                              \
+		}                                                                                              \
+	} while(false)
+
+/*
+ * Fails the test unless the statement throws an exception of the given type.
+ */
+#define CHECK_THROWS(pStatement, pException)                                                           \
+	do {                                                                                               \
+		bool thrown = false;                                                                           \
+		try {                                                                                          \
+			pStatement;                                                                                \
+		} catch(const pException &) {                                                                  \
+			thrown = true;                                                                             \
+		}                                                                                              \
+		if(!thrown) {                                                                                  \
+			std::fprintf(stderr, "%s:%d: %s did not throw %s\n", __FILE__, __LINE__, #pStatement,      \
+			             #pException);                                                                 \
+			std::exit(1);                                                                              \
+		}                                                                                              \
+	} while(false)
+
+#endif// AURORA_TEST_CHECK_H
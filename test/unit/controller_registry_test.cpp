@@ -0,0 +1,97 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "check.h"
+#include "headless.h"
+#include "aurora/level/controller.h"
+
+using namespace aurora;
+using namespace aurora::level;
+
+namespace {
+	// An interface that is only found by its type, as TestController does not
+	// expose it through getInterface().
+	class Greeter {
+	public:
+		virtual ~Greeter() = default;
+
+		[[nodiscard]] virtual int greet() const = 0;
+	};
+
+	class TestController : public Controller, public Greeter {
+	public:
+		static const std::string type;
+		static inline int live = 0;
+
+		TestController(Level *pLevel, Object *pObject, const aether::Level::Controller &pAether)
+			: Controller(pLevel, pObject, pAether) {
+			++live;
+		}
+
+		~TestController() override {
+			--live;
+		}
+
+		void render() override {}
+
+		void update() override {}
+
+		[[nodiscard]] ControllerTypeId getTypeId() const override {
+			return controllerTypeId<TestController>();
+		}
+
+		[[nodiscard]] int greet() const override {
+			return 42;
+		}
+	};
+
+	const std::string TestController::type = "test";
+}
+
+int main() {
+	HeadlessInstance instance("aurora_controller_registry_test");
+
+	// Names handed out stay valid while more are interned.
+	const auto &name = getControllerTypeName(internControllerType("first"));
+	for(int i = 0; i < 1000; ++i) { internControllerType("type" + std::to_string(i)); }
+	CHECK(name == "first");
+
+	// Registering before the registry is initialised survives it.
+	registerController<TestController>();
+	initializeRegistry();
+
+	aether::Level::Controller aether;
+	aether.type = TestController::type;
+	{
+		Level level;
+		Object object(&level, nullptr, {}, glm::identity<glm::dquat>(), "object");
+		object.createController(aether);
+
+		auto greeter = object.findControllerByType<Greeter>();
+		CHECK(greeter != nullptr);
+		CHECK(greeter->greet() == 42);
+		CHECK(object.findControllerByType<CameraController>() == nullptr);
+	}
+	CHECK(TestController::live == 0);
+
+	// Objects take their children and controllers with them, and the pools
+	// destroy controllers that no object holds any more.
+	{
+		auto level = new Level;
+		auto parent = new Object(level, nullptr, {}, glm::identity<glm::dquat>(), "parent");
+		auto child = new Object(level, parent, {}, glm::identity<glm::dquat>(), "child");
+		parent->addChild(child);
+		parent->createController(aether);
+		child->createController(aether);
+		child->createController(aether);
+		child->removeController(child->getControllers().back());
+		CHECK(TestController::live == 3);
+
+		delete parent;
+		CHECK(TestController::live == 1);
+		delete level;
+	}
+	CHECK(TestController::live == 0);
+}
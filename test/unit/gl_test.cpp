@@ -0,0 +1,230 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include <GL/glew.h>
+#include "aurora/global.h"
+#include "aurora/instance.h"
+#include "aurora/window.h"
+#include "aurora/glimpl/opengl_impl_node.h"
+#include "check.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+/*
+ * Runs the OpenGL implementations against a real context, in a hidden
+ * window. Each version without a context is skipped, and the test as a whole
+ * reports itself skipped to ctest when neither has one.
+ */
+
+namespace {
+	constexpr int skipped = 77;
+
+	void testBuffers(aurora::Implementation &pImpl) {
+		auto buffer = pImpl.createBuffer(aurora::VertexBuffer);
+
+		uint8_t data[64];
+		for(int i = 0; i < 64; ++i) { data[i] = static_cast<uint8_t>(i); }
+		pImpl.updateBufferData(buffer, data, sizeof(data));
+
+		uint8_t patch[16];
+		std::memset(patch, 0xab, sizeof(patch));
+		pImpl.updateBufferData(buffer, patch, sizeof(patch), 16);
+		std::memcpy(data + 16, patch, sizeof(patch));
+
+		uint8_t read[64];
+		pImpl.retrieveBufferData(buffer, read, sizeof(read), 0);
+		CHECK(std::memcmp(read, data, sizeof(data)) == 0);
+
+		CHECK_THROWS(pImpl.updateBufferData(buffer, patch, sizeof(patch), 56), aurora::EBufferOverflow);
+		CHECK_THROWS(pImpl.retrieveBufferData(buffer, read, sizeof(patch), 56), aurora::EBufferUnderflow);
+
+		pImpl.destroyBuffer(buffer);
+	}
+
+	void testStreamBuffers(aurora::Implementation &pImpl, aurora::Window *pWindow) {
+		// Three writes a frame do not divide the ring, so that writes wrap
+		// around it at a different place every frame.
+		constexpr size_t ringSize = 4096, writeSize = 1000, writesPerFrame = 3;
+		auto buffer = pImpl.createStreamBuffer(aurora::VertexBuffer, ringSize);
+
+		for(int frame = 0; frame < 16; ++frame) {
+			size_t offsets[writesPerFrame];
+			for(size_t i = 0; i < writesPerFrame; ++i) {
+				auto range = pImpl.mapStreamBuffer(buffer, writeSize, 16);
+				CHECK(range.offset % 16 == 0);
+				CHECK(range.offset + writeSize <= ringSize);
+				std::memset(range.data, static_cast<int>(frame * writesPerFrame + i), writeSize);
+				pImpl.unmapStreamBuffer(buffer);
+				offsets[i] = range.offset;
+			}
+
+			// Every range stays valid until the end of the frame, however many
+			// were written after it.
+			for(size_t i = 0; i < writesPerFrame; ++i) {
+				uint8_t read[writeSize];
+				pImpl.retrieveBufferData(buffer, read, writeSize, offsets[i]);
+
+				std::vector<uint8_t> expected(writeSize, static_cast<uint8_t>(frame * writesPerFrame + i));
+				CHECK(std::memcmp(read, expected.data(), writeSize) == 0);
+			}
+
+			pImpl.performFinishFrame(pWindow);
+		}
+
+		// A frame that does not fit in the ring is refused rather than
+		// written over itself.
+		CHECK_THROWS(pImpl.mapStreamBuffer(buffer, ringSize + 1, 1), aurora::EBufferOverflow);
+		for(size_t i = 0; i < writesPerFrame; ++i) {
+			pImpl.mapStreamBuffer(buffer, writeSize, 16);
+			pImpl.unmapStreamBuffer(buffer);
+		}
+		CHECK_THROWS(pImpl.mapStreamBuffer(buffer, 2 * writeSize, 16), aurora::EBufferOverflow);
+		pImpl.performFinishFrame(pWindow);
+
+		pImpl.destroyStreamBuffer(buffer);
+	}
+
+	aurora::aether::Shader blockShader() {
+		aurora::aether::Shader shader;
+		shader.parts.emplace_back(aurora::aether::Shader::Vertex, R"(
+layout(std140) uniform Camera {
+	mat4 view;
+	mat4 perspective;
+	float time;
+};
+
+layout(std140) uniform Objects {
+	mat4 objects[256];
+};
+
+in vec2 position;
+out float shade;
+
+void main() {
+	shade = time;
+	gl_Position = objects[gl_InstanceID] * vec4(position, 0.0, 1.0);
+}
+)");
+		shader.parts.emplace_back(aurora::aether::Shader::Pixel, R"(
+in float shade;
+out vec4 color;
+
+void main() {
+	color = vec4(shade, 0.0, 0.0, 1.0);
+}
+)");
+		shader.outputs.emplace_back("color", 0);
+		shader.blocks.emplace_back("Camera", "Camera");
+		shader.blocks.emplace_back("Objects", "Objects");
+		return shader;
+	}
+
+	void testUniformBlocks(aurora::Implementation &pImpl, aurora::Window *pWindow) {
+		auto shader = pImpl.createShader(blockShader());
+
+		// One triangle that covers the whole framebuffer.
+		float vertices[] = {-1, -1, 3, -1, -1, 3};
+		uint32_t indices[] = {0, 1, 2};
+		auto vertexBuffer = pImpl.createBuffer(aurora::VertexBuffer);
+		auto indexBuffer = pImpl.createBuffer(aurora::IndexBuffer);
+		pImpl.updateBufferData(vertexBuffer, vertices, sizeof(vertices));
+		pImpl.updateBufferData(indexBuffer, indices, sizeof(indices));
+
+		aurora::DrawObjectOptions options;
+		options.shader = shader;
+		options.vertexBuffer = vertexBuffer;
+		options.indexBuffer = indexBuffer;
+		options.vertexCount = 3;
+		options.arrangement = {A_VNODE(position, Float, 2)};
+		auto drawObject = pImpl.createDrawObject(options);
+
+		auto framebuffer = pImpl.createFramebuffer(16, 16);
+		pImpl.activateFramebuffer(framebuffer);
+		pImpl.updateViewportSize(16, 16);
+
+		for(int frame = 0; frame < 2; ++frame) {
+			pImpl.setClearColor(0, 0, 0, 1);
+			pImpl.performClear();
+
+			aurora::MatrixSet matrices;
+			pImpl.setCameraUniforms(matrices.view, matrices.perspective, 1);
+
+			// More object blocks than the uniform ring holds, none of which
+			// draw anything. Writing them wraps the ring past the Camera block,
+			// which has to be written and bound again for the draw after them.
+			std::vector<glm::mat4> hidden(100000, glm::mat4(0));
+			pImpl.performDrawInstanced(drawObject, matrices, hidden.data(), static_cast<uint32_t>(hidden.size()));
+
+			glm::mat4 shown(1);
+			pImpl.performDrawInstanced(drawObject, matrices, &shown, 1);
+
+			uint8_t pixel[4];
+			glReadPixels(8, 8, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+			CHECK(pixel[0] == 255);
+
+			pImpl.performFinishFrame(pWindow);
+			pImpl.activateFramebuffer(framebuffer);
+		}
+
+		pImpl.destroyFramebuffer(framebuffer);
+		pImpl.destroyDrawObject(drawObject);
+		pImpl.destroyBuffer(indexBuffer);
+		pImpl.destroyBuffer(vertexBuffer);
+		pImpl.destroyShader(shader);
+	}
+
+	template<int major, int minor>
+	bool testImplementation(const std::filesystem::path &pRoot) {
+		aurora::OpenGlImplementationNode<major, minor> node;
+		try {
+			if(!node.isValid()) { return false; }
+		} catch(const std::runtime_error &) {
+			// No display to make a window on.
+			return false;
+		}
+
+		aurora::ImplementationFinder finder;
+		finder.registerImpl(&node);
+		auto instance = new aurora::Instance(&finder, pRoot);
+		aurora::global = instance;
+
+		auto window = new aurora::Window(16, 16, "gl_test", false);
+		window->hide();
+		instance->setWindow(window);
+
+		auto &impl = *instance->getImpl();
+		testBuffers(impl);
+		testStreamBuffers(impl, window);
+		testUniformBlocks(impl, window);
+
+		delete window;
+		delete instance;
+		aurora::global = nullptr;
+		return true;
+	}
+}// namespace
+
+int main() {
+	try {
+		aurora::init();
+	} catch(const std::runtime_error &) {
+		return skipped;
+	}
+
+	auto root = std::filesystem::temp_directory_path() / "aurora_gl_test";
+	std::filesystem::create_directories(root);
+	{
+		std::ofstream out(root / aurora::aether::Pack::fileName, std::ios::binary);
+		aurora::aether::Pack::write(out, {});
+	}
+
+	auto ran = testImplementation<3, 2>(root);
+	if(testImplementation<4, 5>(root)) { ran = true; }
+
+	aurora::terminate();
+	std::filesystem::remove_all(root);
+	return ran ? 0 : skipped;
+}
@@ -0,0 +1,58 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#ifndef AURORA_TEST_HEADLESS_H
+#define AURORA_TEST_HEADLESS_H
+
+#include "aurora/global.h"
+#include "aurora/instance.h"
+#include "aurora/nullimpl/null_impl.h"
+#include <filesystem>
+#include <fstream>
+
+/*
+ * The global Instance of a test, running on the NullImplementation with an
+ * asset pack of the passed entries in a temporary directory.
+ */
+class HeadlessInstance {
+private:
+	std::filesystem::path m_Root;
+	aurora::NullImplementationNode m_Node;
+	aurora::Instance *m_Instance;
+
+public:
+	explicit HeadlessInstance(const std::string &pName, const std::vector<aurora::aether::Pack::Entry> &pAssets = {})
+		: m_Root(std::filesystem::temp_directory_path() / pName) {
+		std::filesystem::create_directories(m_Root);
+		{
+			std::ofstream out(m_Root / aurora::aether::Pack::fileName, std::ios::binary);
+			aurora::aether::Pack::write(out, pAssets);
+		}
+
+		aurora::ImplementationFinder finder;
+		finder.registerImpl(&m_Node);
+		m_Instance = new aurora::Instance(&finder, m_Root);
+		aurora::global = m_Instance;
+	}
+
+	~HeadlessInstance() {
+		delete m_Instance;
+		aurora::global = nullptr;
+		std::filesystem::remove_all(m_Root);
+	}
+
+	HeadlessInstance(const HeadlessInstance &) = delete;
+	HeadlessInstance &operator=(const HeadlessInstance &) = delete;
+
+	[[nodiscard]] aurora::NullImplementation &getImpl() const {
+		return *static_cast<aurora::NullImplementation *>(m_Instance->getImpl());
+	}
+
+	[[nodiscard]] aurora::Instance &getInstance() const {
+		return *m_Instance;
+	}
+};
+
+#endif// AURORA_TEST_HEADLESS_H
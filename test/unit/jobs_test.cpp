@@ -0,0 +1,114 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "aurora/jobs.h"
+#include "check.h"
+#include <chrono>
+#include <stdexcept>
+
+using namespace aurora;
+
+namespace {
+	// Every index of an outer and an inner parallelFor, visited from jobs.
+	void testNestedParallelFor(JobSystem &pJobs) {
+		constexpr size_t outer = 16, inner = 100;
+		std::vector<std::atomic<int>> hits(outer * inner);
+
+		pJobs.parallelFor(outer, 1, [&](size_t pBegin, size_t pEnd) {
+			for(size_t i = pBegin; i < pEnd; ++i) {
+				pJobs.parallelFor(inner, 7, [&, i](size_t pInnerBegin, size_t pInnerEnd) {
+					for(size_t j = pInnerBegin; j < pInnerEnd; ++j) { hits[i * inner + j]++; }
+				});
+			}
+		});
+
+		for(const auto &item: hits) { CHECK(item.load() == 1); }
+	}
+
+	void testSubmitAfter(JobSystem &pJobs) {
+		{
+			JobSystem::Group done;
+			pJobs.submit(done, []() {});
+			pJobs.wait(done);
+
+			// Nothing is left to wait for, so the job is queued at once.
+			JobSystem::Group after;
+			std::atomic<bool> ran = false;
+			pJobs.submitAfter(done, after, [&]() { ran = true; });
+			pJobs.wait(after);
+			CHECK(ran);
+		}
+
+		{
+			JobSystem::Group dependency, after;
+			std::atomic<bool> open = false, dependencyDone = false, ran = false;
+			pJobs.submit(dependency, [&]() {
+				while(!open) { std::this_thread::yield(); }
+				dependencyDone = true;
+			});
+			pJobs.submitAfter(dependency, after, [&]() {
+				CHECK(dependencyDone);
+				ran = true;
+			});
+
+			// The continuation counts towards its group while it waits.
+			CHECK(!after.isDone());
+			open = true;
+			pJobs.wait(after);
+			CHECK(ran);
+			CHECK(dependency.isDone());
+		}
+	}
+
+	void testException(JobSystem &pJobs) {
+		JobSystem::Group group;
+		std::atomic<int> ran = 0;
+		for(int i = 0; i < 8; ++i) {
+			pJobs.submit(group, [&ran, i]() {
+				if(i == 5) { throw std::runtime_error("job failed"); }
+				ran++;
+			});
+		}
+
+		// The other jobs still run, and the error is handed out only once.
+		CHECK_THROWS(pJobs.wait(group), std::runtime_error);
+		CHECK(ran == 7);
+		CHECK(group.isDone());
+		pJobs.wait(group);
+	}
+}
+
+int main() {
+	for(unsigned workers: {0u, 3u}) {
+		JobSystem jobs(workers);
+		CHECK(jobs.getWorkerCount() == workers);
+
+		testNestedParallelFor(jobs);
+		testSubmitAfter(jobs);
+		testException(jobs);
+	}
+
+	{
+		// Destroyed with every worker asleep, and again with some work in
+		// between waking them up.
+		JobSystem jobs(4);
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		JobSystem::Group group;
+		std::atomic<int> ran = 0;
+		for(int i = 0; i < 32; ++i) { jobs.submit(group, [&ran]() { ran++; }); }
+		jobs.wait(group);
+		CHECK(ran == 32);
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	{
+		JobSystem jobs(4);
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "check.h"
+#include "headless.h"
+#include "aurora/level/controller.h"
+#include <algorithm>
+#include <atomic>
+
+using namespace aurora;
+using namespace aurora::level;
+
+namespace {
+	class CountingController : public Controller {
+	public:
+		static const std::string type;
+		static inline int live = 0;
+		static inline std::atomic<int> updates = 0;
+
+		CountingController(Level *pLevel, Object *pObject, const aether::Level::Controller &pAether)
+			: Controller(pLevel, pObject, pAether) {
+			++live;
+		}
+
+		~CountingController() override {
+			--live;
+		}
+
+		void render() override {}
+
+		void update() override {
+			++updates;
+		}
+
+		[[nodiscard]] ControllerTypeId getTypeId() const override {
+			return controllerTypeId<CountingController>();
+		}
+
+		[[nodiscard]] bool isParallelSafe() const override {
+			return true;
+		}
+	};
+
+	const std::string CountingController::type = "counting";
+
+	bool isRoot(const Level &pLevel, Object *pObject) {
+		const auto &roots = pLevel.getObjects();
+		return std::find(roots.begin(), roots.end(), pObject) != roots.end();
+	}
+}
+
+int main() {
+	HeadlessInstance instance("aurora_level_test");
+	registerController<CountingController>();
+
+	aether::Level::Controller aether;
+	aether.type = CountingController::type;
+
+	auto level = new Level;
+	auto a = new Object(level, nullptr, {}, glm::identity<glm::dquat>(), "a");
+	auto b = new Object(level, nullptr, {}, glm::identity<glm::dquat>(), "b");
+	level->addRoot(a);
+	level->addRoot(b);
+	a->createController(aether);
+	b->createController(aether);
+
+	// A root that is given a parent is no longer a root, and is updated once.
+	a->addChild(b);
+	CHECK(level->getObjects().size() == 1);
+	CHECK(!isRoot(*level, b));
+	level->update();
+	CHECK(CountingController::updates == 2);
+
+	// A child that is detached becomes a root, and is still updated.
+	auto c = new Object(level, a, {}, glm::identity<glm::dquat>(), "c");
+	a->addChild(c);
+	c->createController(aether);
+	a->removeChild(c);
+	CHECK(c->getParent() == nullptr);
+	CHECK(isRoot(*level, c));
+	CountingController::updates = 0;
+	level->update();
+	CHECK(CountingController::updates == 3);
+
+	// Deleting a root takes it out of the level.
+	delete c;
+	CHECK(level->getObjects().size() == 1);
+	CHECK(CountingController::live == 2);
+
+	// Every object is deleted exactly once, along with its controllers.
+	delete level;
+	CHECK(CountingController::live == 0);
+}
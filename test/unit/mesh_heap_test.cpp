@@ -0,0 +1,90 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "aurora/resources/mesh_heap.h"
+#include "check.h"
+#include "headless.h"
+#include <stdexcept>
+#include <vector>
+
+using namespace aurora;
+
+namespace {
+	MeshHeap::Allocation allocate(MeshHeap &pHeap, size_t pVertexCount, size_t pStride, size_t pIndexCount) {
+		std::vector<uint8_t> vertices(pVertexCount * pStride);
+		std::vector<uint32_t> indices(pIndexCount);
+		return pHeap.allocate(vertices.data(), vertices.size(), pStride, indices.data(),
+		                      indices.size() * sizeof(uint32_t));
+	}
+}
+
+int main() {
+	HeadlessInstance instance("aurora_mesh_heap_test");
+	auto &impl = instance.getImpl();
+	auto liveObjects = impl.getLiveObjectCount();
+
+	{
+		MeshHeap heap(1024, 256);
+		CHECK(heap.getBlockCount() == 0);
+
+		auto a = allocate(heap, 4, 12, 6);
+		CHECK(a.block == 0 && a.vertexOffset == 0 && a.baseVertex == 0);
+		CHECK(heap.getBlockCount() == 1);
+		CHECK(impl.getLiveObjectCount() == liveObjects + 2);
+
+		// Vertex data starts at a whole vertex of its own stride, which is
+		// what the base vertex counts in.
+		auto b = allocate(heap, 3, 20, 3);
+		CHECK(b.block == 0 && b.vertexOffset == 60 && b.baseVertex == 3);
+		CHECK(b.indexOffset == a.indexSize);
+
+		auto c = allocate(heap, 2, 12, 3);
+		CHECK(c.block == 0 && c.vertexOffset == 120 && c.baseVertex == 10);
+
+		// One vertex fits in the gap left before b.
+		auto d = allocate(heap, 1, 12, 3);
+		CHECK(d.block == 0 && d.vertexOffset == 48 && d.baseVertex == 4);
+
+		// Meshes that no longer fit go to a new block, and one larger than a
+		// block gets a block of its own size.
+		auto e = allocate(heap, 125, 8, 3);
+		CHECK(e.block == 1 && e.baseVertex == 0);
+		auto f = allocate(heap, 256, 8, 3);
+		CHECK(f.block == 2 && f.baseVertex == 0);
+		CHECK(heap.getBlockCount() == 3);
+		CHECK(impl.getLiveObjectCount() == liveObjects + 6);
+
+		// Emptied blocks are destroyed, except for the first.
+		heap.free(f);
+		CHECK(heap.getBlockCount() == 2);
+		CHECK_THROWS(heap.free(f), std::runtime_error);
+		heap.free(e);
+		for(const auto &item: {a, b, c, d}) { heap.free(item); }
+		CHECK(heap.getBlockCount() == 1);
+		CHECK(impl.getLiveObjectCount() == liveObjects + 2);
+
+		// The emptied first block is used from its start again.
+		auto again = allocate(heap, 4, 12, 6);
+		CHECK(again.block == 0 && again.vertexOffset == 0 && again.indexOffset == 0 && again.baseVertex == 0);
+
+		// A free whose index range is already free is refused before its
+		// vertex range is given back.
+		auto other = allocate(heap, 4, 12, 6);
+		heap.free(again);
+		auto bad = other;
+		bad.indexOffset = again.indexOffset;
+		CHECK_THROWS(heap.free(bad), std::runtime_error);
+		heap.free(other);
+		CHECK(heap.getBlockCount() == 1);
+
+		CHECK_THROWS(allocate(heap, 0, 12, 3), std::runtime_error);
+		std::vector<uint8_t> partial(13);
+		uint32_t index = 0;
+		CHECK_THROWS(heap.allocate(partial.data(), partial.size(), 12, &index, sizeof(index)), std::runtime_error);
+	}
+
+	CHECK(impl.getLiveObjectCount() == liveObjects);
+	return 0;
+}
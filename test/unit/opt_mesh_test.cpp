@@ -0,0 +1,81 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "aurora/aether/aether.h"
+#include "check.h"
+
+using namespace aurora::aether;
+
+namespace {
+	Shader layout() {
+		Shader shader;
+		shader.vertexNodes.emplace_back("v_position", "Float", "position3", 3);
+		shader.vertexNodes.emplace_back("v_texCoord", "Float", "tex2", 2);
+		return shader;
+	}
+
+	/*
+	 * A flat grid of pSide by pSide quads. With pJitter set, every triangle
+	 * gets its own copy of its corners, moved by up to pJitter.
+	 */
+	Mesh grid(int pSide, float pJitter = 0) {
+		Mesh mesh;
+		mesh.normals.emplace_back(0, 0, 1);
+
+		auto corner = [&](int pX, int pY, int pCopy) {
+			auto offset = pJitter * static_cast<float>((pCopy * 7 + pX * 3 + pY) % 5 - 2) / 2.0f;
+			mesh.positions.emplace_back(static_cast<float>(pX) + offset, static_cast<float>(pY) - offset, offset);
+			mesh.texCoords.emplace_back(static_cast<float>(pX) / static_cast<float>(pSide),
+			                            static_cast<float>(pY) / static_cast<float>(pSide));
+			return static_cast<int>(mesh.positions.size() - 1);
+		};
+
+		for(int y = 0; y < pSide; ++y) {
+			for(int x = 0; x < pSide; ++x) {
+				int quad[2][3][2]{{{0, 0}, {1, 0}, {0, 1}}, {{0, 1}, {1, 0}, {1, 1}}};
+				for(int t = 0; t < 2; ++t) {
+					MeshTri tri{};
+					for(int i = 0; i < 3; ++i) {
+						auto index = corner(x + quad[t][i][0], y + quad[t][i][1], t * 3 + i);
+						tri.vertices[i] = tri.texVertices[i] = index;
+						tri.normalVertices[i] = 0;
+					}
+					mesh.tris.push_back(tri);
+				}
+			}
+		}
+
+		return mesh;
+	}
+}
+
+int main() {
+	auto shader = layout();
+	constexpr int side = 40;
+	constexpr size_t welded = (side + 1) * (side + 1);
+
+	// Corners shared by neighbouring triangles become one vertex.
+	OptimisedMesh exact(grid(side), shader);
+	CHECK(exact.vertexData.size() == welded * 5);
+	CHECK(exact.indexData.size() == side * side * 6);
+
+	// Copies within the tolerance are welded; without a tolerance they stay apart.
+	auto jittered = grid(side, 0.001f);
+	OptimisedMesh near(jittered, shader, {1, 1, 1, 1}, 0.01f);
+	CHECK(near.vertexData.size() == welded * 5);
+	OptimisedMesh apart(jittered, shader);
+	CHECK(apart.vertexData.size() > welded * 5);
+
+	// Positions far outside the range of a grid cell index must not overflow.
+	Mesh far;
+	far.positions = {{1e30f, 0, 0}, {-1e30f, 0, 0}, {3e38f, 3e38f, -3e38f}};
+	far.texCoords = {{0, 0}};
+	far.normals = {{0, 0, 1}};
+	far.tris = {{{0, 1, 2}, {0, 0, 0}, {0, 0, 0}}, {{2, 1, 0}, {0, 0, 0}, {0, 0, 0}}};
+	OptimisedMesh farWeld(far, shader, {1, 1, 1, 1}, 1e-6f);
+	CHECK(farWeld.vertexData.size() == 3 * 5);
+	CHECK(farWeld.indexData.size() == 6);
+	CHECK(farWeld.indexData[0] == farWeld.indexData[5] && farWeld.indexData[2] == farWeld.indexData[3]);
+}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "aurora/aether/aether.h"
+#include "check.h"
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+using namespace aurora::aether;
+
+namespace {
+	std::vector<uint8_t> writePack(const std::vector<Pack::Entry> &pEntries) {
+		std::ostringstream out;
+		Pack::write(out, pEntries);
+		auto text = out.str();
+		return {text.begin(), text.end()};
+	}
+
+	Pack::Slot *slotOf(std::vector<uint8_t> &pImage, std::string_view pKey) {
+		Pack::Header header;
+		std::memcpy(&header, pImage.data(), sizeof(header));
+		auto slots = reinterpret_cast<Pack::Slot *>(pImage.data() + header.slotsOffset);
+		for(uint32_t i = 0; i < header.slotCount; ++i) {
+			if(slots[i].hash == Pack::hashKey(pKey)) { return &slots[i]; }
+		}
+		return nullptr;
+	}
+}
+
+int main() {
+	std::vector<Pack::Entry> entries{
+		{"mesh", "meshes/cube.amesh", {1, 2, 3}},
+		{"shader", "shaders/flat.ashdr", {4, 5}}
+	};
+	auto image = writePack(entries);
+
+	Pack::validate(image);
+	auto found = Pack::find(image, "shader");
+	CHECK(found.has_value());
+	CHECK(found->path == "shaders/flat.ashdr");
+	CHECK(found->payload.size() == 2 && found->payload[0] == 4);
+	CHECK(!Pack::find(image, "texture").has_value());
+
+	// Strings running past the end of the image.
+	auto badString = image;
+	slotOf(badString, "mesh")->stringOffset = UINT32_MAX - 2;
+	CHECK_THROWS(Pack::find(badString, "mesh"), std::runtime_error);
+
+	// A payload whose end overflows.
+	auto badPayload = image;
+	slotOf(badPayload, "mesh")->payloadOffset = 8;
+	slotOf(badPayload, "mesh")->payloadSize = UINT64_MAX - 4;
+	CHECK_THROWS(Pack::find(badPayload, "mesh"), std::runtime_error);
+
+	// A slot table that does not fit in the image.
+	auto badHeader = image;
+	reinterpret_cast<Pack::Header *>(badHeader.data())->slotCount = 1u << 30;
+	CHECK_THROWS(Pack::validate(badHeader), std::runtime_error);
+
+	// A table with no empty slot left must not be probed forever.
+	auto full = image;
+	Pack::Header header;
+	std::memcpy(&header, full.data(), sizeof(header));
+	auto slots = reinterpret_cast<Pack::Slot *>(full.data() + header.slotsOffset);
+	for(uint32_t i = 0; i < header.slotCount; ++i) {
+		if(slots[i].hash == 0) { slots[i].hash = 1; }
+	}
+	CHECK(!Pack::find(full, "texture").has_value());
+}
@@ -0,0 +1,84 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "aurora/graphics/range_allocator.h"
+#include "check.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace aurora;
+
+int main() {
+	{
+		RangeAllocator allocator(100);
+		CHECK(allocator.allocate(0) == RangeAllocator::invalid);
+
+		// Alignment need not be a power of two; the bytes skipped to reach it
+		// stay free.
+		CHECK(allocator.allocate(10) == 0);
+		CHECK(allocator.allocate(12, 12) == 12);
+		CHECK(allocator.getFreeBytes() == 78);
+
+		// The smallest free range that fits is taken, which is that gap.
+		CHECK(allocator.allocate(2) == 10);
+		CHECK(allocator.getFreeBytes() == 76);
+	}
+
+	{
+		RangeAllocator allocator(64);
+		CHECK(allocator.allocate(5) == 0);
+		CHECK(allocator.allocate(10) == 5);
+		CHECK(allocator.allocate(1) == 15);
+		allocator.free(5, 10);
+
+		// Aligned to 8, the range would start at 8 and run past the gap.
+		CHECK(allocator.allocate(10, 8) == 16);
+		CHECK(allocator.allocate(10) == 5);
+	}
+
+	{
+		RangeAllocator allocator(96);
+		for(size_t i = 0; i < 4; ++i) { CHECK(allocator.allocate(24) == i * 24); }
+		CHECK(allocator.allocate(1) == RangeAllocator::invalid);
+		CHECK(allocator.getFreeBytes() == 0);
+
+		// The last range freed merges with the free ranges on both sides of
+		// it, or the larger allocation after it would not fit anywhere.
+		allocator.free(24, 24);
+		allocator.free(72, 24);
+		allocator.free(48, 24);
+		CHECK(allocator.allocate(72) == 24);
+
+		allocator.free(24, 72);
+		allocator.free(0, 24);
+		CHECK(allocator.isEmpty());
+
+		// Once everything is back, the whole space can be taken again.
+		CHECK(allocator.allocate(96) == 0);
+		CHECK(allocator.getFreeBytes() == 0);
+		allocator.free(0, 96);
+		CHECK(allocator.isEmpty());
+
+		CHECK_THROWS(allocator.free(0, 24), std::runtime_error);
+		CHECK_THROWS(allocator.free(90, 10), std::runtime_error);
+	}
+
+	{
+		RangeAllocator allocator(96);
+		for(size_t i = 0; i < 3; ++i) { CHECK(allocator.allocate(24) == i * 24); }
+		allocator.free(24, 24);
+
+		// The range ends where the free tail starts, but begins inside a free
+		// range. It is refused before the tail is merged with anything.
+		CHECK(!allocator.isAllocated(36, 36));
+		CHECK_THROWS(allocator.free(36, 36), std::runtime_error);
+		CHECK(allocator.getFreeBytes() == 48);
+		auto first = allocator.allocate(24), second = allocator.allocate(24);
+		CHECK(std::min(first, second) == 24 && std::max(first, second) == 72);
+		CHECK(allocator.isAllocated(0, 96));
+	}
+
+	return 0;
+}
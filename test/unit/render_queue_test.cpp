@@ -0,0 +1,93 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "check.h"
+#include "headless.h"
+#include "aurora/graphics/render_queue.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace aurora;
+
+namespace {
+	glm::mat4 at(float pDepth) {
+		return glm::translate(glm::identity<glm::mat4>(), glm::vec3(0, 0, -pDepth));
+	}
+
+	// The draw objects in the order they were drawn.
+	std::vector<uint32_t> drawn(const NullImplementation &pImpl) {
+		std::vector<uint32_t> objects;
+		for(const auto &item: pImpl.getCommands()) {
+			if(item.op == NullImplementation::Op::Draw) { objects.push_back(item.object); }
+		}
+		return objects;
+	}
+}
+
+int main() {
+	HeadlessInstance instance("aurora_render_queue_test");
+	auto &impl = instance.getImpl();
+
+	auto shader = impl.createShader(aether::Shader());
+	auto vertices = impl.createBuffer(VertexBuffer);
+	auto indices = impl.createBuffer(IndexBuffer);
+	DrawObjectOptions options{.shader = shader, .vertexBuffer = vertices, .indexBuffer = indices, .vertexCount = 3};
+	ObjRefBase *objects[2]{impl.createDrawObject(options), impl.createDrawObject(options)};
+	CHECK(impl.getDrawObjectStateKey(objects[0]) == impl.getDrawObjectStateKey(objects[1]));
+
+	auto idOf = [&impl](ObjRefBase *pObject) {
+		impl.clearCommands();
+		impl.performDraw(pObject, MatrixSet(glm::identity<glm::mat4>(), glm::identity<glm::mat4>(),
+		                                    glm::identity<glm::mat4>()));
+		return drawn(impl).at(0);
+	};
+	uint32_t ids[2]{idOf(objects[0]), idOf(objects[1])};
+
+	// Whichever draw object has the nearest draw is drawn first, however
+	// the draw objects happen to compare, and each is drawn as one batch.
+	for(int nearest = 0; nearest < 2; ++nearest) {
+		auto near = objects[nearest], far = objects[1 - nearest];
+
+		RenderQueue queue;
+		queue.begin(glm::identity<glm::mat4>(), glm::identity<glm::mat4>());
+		queue.submit(far, at(4));
+		queue.submit(near, at(3));
+		queue.submit(far, at(2));
+		queue.submit(near, at(1));
+
+		impl.clearCommands();
+		queue.execute();
+		CHECK((drawn(impl) == std::vector<uint32_t>{ids[nearest], ids[nearest], ids[1 - nearest], ids[1 - nearest]}));
+	}
+
+	// Layers still come before depth.
+	RenderQueue queue;
+	queue.begin(glm::identity<glm::mat4>(), glm::identity<glm::mat4>());
+	queue.submit(objects[0], at(1), 1);
+	queue.submit(objects[1], at(9), 0);
+	impl.clearCommands();
+	queue.execute();
+	CHECK((drawn(impl) == std::vector<uint32_t>{ids[1], ids[0]}));
+
+	// A shear can stretch the sphere further than the longest axis. Here
+	// both axes are of unit length, but the mesh reaches 1.28 along X, so
+	// it crosses into the view although its centre is 1.15 outside.
+	auto sheared = glm::identity<glm::mat4>();
+	sheared[1] = glm::vec4(0.8f, 0.6f, 0, 0);
+	sheared[3] = glm::vec4(2.15f, 0, 0, 1);
+	auto state = impl.getDrawObjectStateKey(objects[0]);
+	queue.begin(glm::identity<glm::mat4>(), glm::identity<glm::mat4>());
+	queue.submit(RenderQueue::makeKey(0, state, 0), objects[0], sheared, glm::vec4(0, 0, 0, 1));
+	sheared[3] = glm::vec4(3.0f, 0, 0, 1);
+	queue.submit(RenderQueue::makeKey(0, state, 0), objects[1], sheared, glm::vec4(0, 0, 0, 1));
+	impl.clearCommands();
+	queue.execute();
+	CHECK(queue.getCulledCount() == 1);
+	CHECK((drawn(impl) == std::vector<uint32_t>{ids[0]}));
+
+	for(auto object: objects) { impl.destroyDrawObject(object); }
+	impl.destroyBuffer(vertices);
+	impl.destroyBuffer(indices);
+	impl.destroyShader(shader);
+}
@@ -0,0 +1,79 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include "aurora/level/transform_store.h"
+#include "check.h"
+#include <stdexcept>
+
+using namespace aurora::level;
+
+namespace {
+	glm::dvec3 worldPosition(TransformStore &pStore, TransformStore::Handle pHandle) {
+		return glm::dvec3(pStore.getWorldMatrix(pHandle)[3]);
+	}
+}
+
+int main() {
+	TransformStore store;
+	glm::dquat identity(1, 0, 0, 0);
+
+	auto a = store.create(TransformStore::none, {1, 0, 0}, identity);
+	auto child = store.create(a, {0, 0, 5}, identity);
+	auto b = store.create(TransformStore::none, {0, 10, 0}, identity);
+	CHECK(worldPosition(store, child) == glm::dvec3(1, 0, 5));
+
+	// To a parent that already comes before it.
+	store.setParent(child, b);
+	CHECK(worldPosition(store, child) == glm::dvec3(0, 10, 5));
+
+	// To a parent that was created after it; its own child comes along.
+	store.setParent(b, TransformStore::none);
+	auto later = store.create(TransformStore::none, {0, 0, 1000}, identity);
+	store.setParent(b, later);
+	store.update();
+	CHECK(worldPosition(store, b) == glm::dvec3(0, 10, 1000));
+	CHECK(worldPosition(store, child) == glm::dvec3(0, 10, 1005));
+
+	// Moving the parent still reaches the moved subtree.
+	store.setLocalPosition(later, {0, 0, 2000});
+	store.markDirty(later);
+	store.markDirty(b);
+	store.markDirty(child);
+	store.update();
+	CHECK(worldPosition(store, child) == glm::dvec3(0, 10, 2005));
+
+	// A read-only store hands out the last world transform without building it.
+	store.setLocalPosition(b, {0, 20, 0});
+	store.markDirty(b);
+	store.setReadOnly(true);
+	CHECK(worldPosition(store, b) == glm::dvec3(0, 10, 2000));
+	store.setReadOnly(false);
+	CHECK(worldPosition(store, b) == glm::dvec3(0, 20, 2000));
+	store.setLocalPosition(b, {0, 10, 0});
+	store.markDirty(b);
+	store.markDirty(child);
+
+	// Back to a root.
+	store.setParent(child, TransformStore::none);
+	CHECK(worldPosition(store, child) == glm::dvec3(0, 0, 5));
+
+	CHECK_THROWS(store.setParent(later, later), std::runtime_error);
+	CHECK_THROWS(store.setParent(later, b), std::runtime_error);
+
+	// Enough dead slots to compact, with moved subtrees in between.
+	for(int i = 0; i < 200; ++i) {
+		auto root = store.create(TransformStore::none, {0, 0, 0}, identity);
+		store.setParent(a, root);
+		store.setParent(a, TransformStore::none);
+		store.destroy(root);
+	}
+	store.setParent(a, later);
+	store.setParent(child, a);
+	store.update();
+	CHECK(store.size() == 4);
+	CHECK(worldPosition(store, a) == glm::dvec3(1, 0, 2000));
+	CHECK(worldPosition(store, child) == glm::dvec3(1, 0, 2005));
+	CHECK(worldPosition(store, b) == glm::dvec3(0, 10, 2000));
+}
@@ -4,6 +4,7 @@
  */
 
 #include <aurora/aether/aether.h>
+#include <aurora/aether/profiler.h>
 #include <boost/program_options.hpp>
 #include <iostream>
 #include <fstream>
@@ -162,6 +163,7 @@ int main(int pArgCount, char **pArgs) {
 	desc.add_options()
 		    ("help", "Produce help message")
 		    ("info", "Produce information message")
+		    ("trace", po::value<std::string>(), "Write a Chrome trace of the run to this path")
 		    ("output-file,o", po::value<std::string>(), "Destination path")
 		    ("input-file,i", po::value<std::string>(), "Provide Input file");
 
@@ -179,6 +181,9 @@ int main(int pArgCount, char **pArgs) {
 		return 1;
 	}
 
+	AURORA_PROFILE_SAVE_ON_EXIT(vm.count("trace") ? vm["trace"].as<std::string>() : std::string());
+	AURORA_PROFILE_ZONE("alevelc");
+
 	auto inputPath = vm["input-file"].as<std::string>();
 	auto outputPath = vm["output-file"].as<std::string>();
 
@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <fstream>
 #include <aurora/aether/aether.h>
+#include <aurora/aether/profiler.h>
 
 const char *info = R"(
 --- Information ---------------------------------------------------------------
@@ -10,6 +11,9 @@ const char *info = R"(
 ameshc: Compiles Wavefront OBJ meshes files into a binary mesh format to be loaded
 by an Aurora application.
 
+When --shader is passed, the mesh is instead welded and interleaved for that
+shader's vertex layout and written as a GPU-ready .amesh file.
+
 This tool is part of the Aurora Game Engine. Use --help to view the help message.
 
 --- License -------------------------------------------------------------------
@@ -72,9 +76,12 @@ int main(int pArgCount, char **pArgs) {
 	desc.add_options()
 		    ("help", "Produce help message")
 		    ("info", "Produce information message")
+		    ("trace", po::value<std::string>(), "Write a Chrome trace of the run to this path")
 		    ("output-file,o", po::value<std::string>()->required(), "Destination path")
 		    ("input-file,i", po::value<std::string>()->required(), "Provide Input file")
-		    ("mesh-path,m", po::value<std::string>()->required(), "Provide mesh path");
+		    ("mesh-path,m", po::value<std::string>()->required(), "Provide mesh path")
+		    ("shader,s", po::value<std::string>(), "Compiled shader (.ashdr.aet) whose vertex layout to emit")
+		    ("weld-epsilon", po::value<float>()->default_value(0.0f), "Distance under which vertices are welded");
 
 	po::variables_map vm;
 	po::store(po::command_line_parser(pArgCount, pArgs).options(desc).positional(pd).run(), vm);
@@ -90,6 +97,9 @@ int main(int pArgCount, char **pArgs) {
 		return 1;
 	}
 
+	AURORA_PROFILE_SAVE_ON_EXIT(vm.count("trace") ? vm["trace"].as<std::string>() : std::string());
+	AURORA_PROFILE_ZONE("ameshc");
+
 	auto inputPath = vm["input-file"].as<std::string>();
 	auto outputPath = vm["output-file"].as<std::string>();
 	auto meshPath = vm["mesh-path"].as<std::string>();
@@ -100,7 +110,7 @@ int main(int pArgCount, char **pArgs) {
 	}
 
 	std::ifstream in(inputPath), meshIn(meshPath);
-	std::ofstream out(outputPath);
+	std::ofstream out(outputPath, std::ios::binary);
 
 	nlohmann::json meta = nlohmann::json::parse(in);
 
@@ -165,5 +175,15 @@ int main(int pArgCount, char **pArgs) {
 		} else { throw std::runtime_error("invalid OBJ directive: " + cmdBase); }
 	}
 
-	nlohmann::json::to_cbor(mesh.serialize(), out);
+	mesh.bounds = aurora::aether::Bounds::of(mesh.positions);
+
+	if(vm.count("shader")) {
+		auto shader = aurora::aether::Shader::load(vm["shader"].as<std::string>());
+		aurora::aether::OptimisedMesh opt(mesh, shader, {1, 1, 1, 1}, vm["weld-epsilon"].as<float>());
+		aurora::aether::CompiledMesh compiled(mesh.id, opt, shader, mesh.bounds);
+		const auto &bytes = compiled.serialize();
+		out.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	} else {
+		nlohmann::json::to_cbor(mesh.serialize(), out);
+	}
 }
@@ -4,6 +4,7 @@
  */
 
 #include <aurora/aether/aether.h>
+#include <aurora/aether/profiler.h>
 #include <boost/program_options.hpp>
 #include <iostream>
 #include <fstream>
@@ -61,6 +62,7 @@ int main(int pArgCount, char **pArgs) {
 	desc.add_options()
 		    ("help", "Produce help message")
 		    ("info", "Produce information message")
+		    ("trace", po::value<std::string>(), "Write a Chrome trace of the run to this path")
 		    ("output-file,o", po::value<std::string>(), "Destination path")
 		    ("input-files,i", po::value<std::vector<std::string>>()->multitoken(), "Provide Input files");
 
@@ -78,12 +80,17 @@ int main(int pArgCount, char **pArgs) {
 		return 0;
 	}
 
+	AURORA_PROFILE_SAVE_ON_EXIT(vm.count("trace") ? vm["trace"].as<std::string>() : std::string());
+	AURORA_PROFILE_ZONE("amkindex");
+
 	auto index = nlohmann::json::object();
 
 	for(const auto &item: vm["input-files"].as<std::vector<std::string>>()) {
 		if(item.ends_with(".aet")) {
 			aurora::aether::Resource r(aurora::aether::Resource::readFromFile(item));
 			index[r.id] = item;
+		} else if(item.ends_with(aurora::aether::CompiledMesh::fileExtension)) {
+			index[aurora::aether::CompiledMesh::readId(item)] = item;
 		}
 	}
 
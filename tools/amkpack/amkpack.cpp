@@ -0,0 +1,140 @@
+/*
+ * This file is part of Aurora Game Engine.
+ * https://github.com/liam-lightchild/aurora
+ */
+
+#include <aurora/aether/aether.h>
+#include <aurora/aether/profiler.h>
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <unordered_set>
+
+const char *info = R"(
+--- Information ---------------------------------------------------------------
+
+amkpack: Produces an assets.apack file holding every asset provided by the
+command line, along with the files they refer to (such as texture images), so
+that an Aurora application can map all of its assets from a single file.
+
+This tool is part of the Aurora Game Engine. Use --help to view the help message.
+
+--- License -------------------------------------------------------------------
+
+BSD 3-Clause License
+
+Copyright (c) 2022, der_frühling
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+3. Neither the name of the copyright holder nor the names of its
+   contributors may be used to endorse or promote products derived from
+   this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+-------------------------------------------------------------------------------
+)";
+
+namespace po = boost::program_options;
+
+std::vector<uint8_t> readBytes(const std::filesystem::path &pPath) {
+	std::ifstream in(pPath, std::ios::binary);
+	if(!in) { throw std::runtime_error("cannot open " + pPath.string()); }
+	return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+int main(int pArgCount, char **pArgs) {
+	po::positional_options_description pd;
+	pd.add("input-files", -1);
+	po::options_description desc("Allowed options");
+
+	desc.add_options()
+		    ("help", "Produce help message")
+		    ("info", "Produce information message")
+		    ("trace", po::value<std::string>(), "Write a Chrome trace of the run to this path")
+		    ("output-file,o", po::value<std::string>(), "Destination path")
+		    ("input-files,i", po::value<std::vector<std::string>>()->multitoken(), "Provide Input files");
+
+	po::variables_map vm;
+	po::store(po::command_line_parser(pArgCount, pArgs).options(desc).positional(pd).run(), vm);
+	po::notify(vm);
+
+	if(vm.count("info")) {
+		std::cout << info << std::endl;
+		return 0;
+	}
+
+	if(vm.count("help") || !vm.count("input-files") || !vm.count("output-file")) {
+		std::cout << desc << std::endl;
+		return 0;
+	}
+
+	AURORA_PROFILE_SAVE_ON_EXIT(vm.count("trace") ? vm["trace"].as<std::string>() : std::string());
+	AURORA_PROFILE_ZONE("amkpack");
+
+	std::vector<aurora::aether::Pack::Entry> entries;
+	std::unordered_set<std::string> files;
+
+	for(const auto &item: vm["input-files"].as<std::vector<std::string>>()) {
+		auto path = std::filesystem::path(item).lexically_normal();
+		auto bytes = readBytes(path);
+
+		if(item.ends_with(".aet")) {
+			aurora::aether::AssetSource source(path, std::span<const uint8_t>(bytes));
+			auto json = source.readCbor();
+			aurora::aether::Resource r(json);
+
+			// Textures and icons name their image relative to themselves; pack it alongside.
+			if(json.contains("path") && json["path"].is_string()) {
+				auto file = source.resolve(json["path"].get<std::string>());
+				if(files.emplace(file.generic_string()).second) {
+					entries.emplace_back(aurora::aether::Pack::Entry{
+						.key = aurora::aether::Pack::filePrefix + file.generic_string(),
+						.path = file.generic_string(),
+						.payload = readBytes(file)
+					});
+				}
+			}
+
+			entries.emplace_back(aurora::aether::Pack::Entry{
+				.key = r.id,
+				.path = path.generic_string(),
+				.payload = std::move(bytes)
+			});
+		} else if(item.ends_with(aurora::aether::CompiledMesh::fileExtension)) {
+			entries.emplace_back(aurora::aether::Pack::Entry{
+				.key = aurora::aether::CompiledMesh::readId(path),
+				.path = path.generic_string(),
+				.payload = std::move(bytes)
+			});
+		}
+	}
+
+	auto outPath = std::filesystem::path(vm["output-file"].as<std::string>());
+
+	if(outPath.has_parent_path() && !std::filesystem::exists(outPath.parent_path())) {
+		std::filesystem::create_directories(outPath.parent_path());
+	}
+
+	std::ofstream out(outPath, std::ios::binary);
+	aurora::aether::Pack::write(out, entries);
+}
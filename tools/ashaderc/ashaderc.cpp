@@ -4,7 +4,9 @@
  */
 
 #include <aurora/aether/aether.h>
+#include <aurora/aether/profiler.h>
 #include <boost/program_options.hpp>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <xercesc/dom/DOM.hpp>
@@ -83,6 +85,7 @@ int main(int pArgCount, char **pArgs) {
 	desc.add_options()
 		    ("help", "Produce help message")
 		    ("info", "Produce information message")
+		    ("trace", po::value<std::string>(), "Write a Chrome trace of the run to this path")
 		    ("output-file,o", po::value<std::string>(), "Destination path")
 		    ("input-file,i", po::value<std::string>(), "Provide Input file")
 		    ("encapsulate", po::bool_switch()->default_value(false), "Encapsulates the output as a C++ file")
@@ -105,6 +108,9 @@ int main(int pArgCount, char **pArgs) {
 		return 1;
 	}
 
+	AURORA_PROFILE_SAVE_ON_EXIT(vm.count("trace") ? vm["trace"].as<std::string>() : std::string());
+	AURORA_PROFILE_ZONE("ashaderc");
+
 	auto inputPath = vm["input-file"].as<std::string>();
 	auto outputPath = vm["output-file"].as<std::string>();
 
@@ -175,6 +181,13 @@ int main(int pArgCount, char **pArgs) {
 				sh.vertexNodes.emplace_back(name, elementType, purpose, std::stoi(sizeStr));
 			}
 
+			if(childElementType == "instance" && shaderPartTypeEnum == aurora::aether::Shader::Vertex) {
+				auto name = XMLString::transcode(childElement->getAttributeNS(ashdrNs, XMLString::transcode("name")));
+				auto
+					purpose = XMLString::transcode(childElement->getAttributeNS(ashdrNs, XMLString::transcode("from")));
+				sh.instanceInputs.emplace_back(name, purpose);
+			}
+
 			if(childElementType == "output" && shaderPartTypeEnum == aurora::aether::Shader::Pixel) {
 				auto name = XMLString::transcode(childElement->getAttributeNS(ashdrNs, XMLString::transcode("name")));
 				auto color = XMLString::transcode(childElement->getAttributeNS(ashdrNs, XMLString::transcode("to")));
@@ -191,6 +204,26 @@ int main(int pArgCount, char **pArgs) {
 				sh.uniforms.emplace_back(std::move(uniform));
 			}
 
+			if(childElementType == "block") {
+				std::string name =
+					XMLString::transcode(childElement->getAttributeNS(ashdrNs, XMLString::transcode("name")));
+				std::string
+					purpose = XMLString::transcode(childElement->getAttributeNS(ashdrNs, XMLString::transcode("from")));
+				if(purpose != "Camera" && purpose != "Objects") {
+					throw std::runtime_error("invalid shader block: " + purpose);
+				}
+
+				// Both stages declare a block they share; it is bound once.
+				auto existing = std::find_if(sh.blocks.begin(), sh.blocks.end(), [&](const auto &pBlock) {
+					return pBlock.name == name;
+				});
+				if(existing == sh.blocks.end()) {
+					sh.blocks.emplace_back(name, purpose);
+				} else if(existing->purpose != purpose) {
+					throw std::runtime_error("shader block " + name + " declared with two purposes");
+				}
+			}
+
 			XMLString::release(&childElementTypeX);
 		}
 	}
@@ -1,4 +1,5 @@
 #include <aurora/aether/aether.h>
+#include <aurora/aether/profiler.h>
 #include <boost/program_options.hpp>
 #include <iostream>
 #include <fstream>
@@ -56,6 +57,7 @@ int main(int pArgCount, char **pArgs) {
 	desc.add_options()
 		    ("help", "Produce help message")
 		    ("info", "Produce information message")
+		    ("trace", po::value<std::string>(), "Write a Chrome trace of the run to this path")
 		    ("output-file,o", po::value<std::string>()->required(), "Destination path")
 		    ("input-file,i", po::value<std::string>()->required(), "Provide Input file")
 		    ("texture-path,t", po::value<std::string>()->required(), "Provide texture path");
@@ -73,6 +75,9 @@ int main(int pArgCount, char **pArgs) {
 		return 1;
 	}
 
+	AURORA_PROFILE_SAVE_ON_EXIT(vm.count("trace") ? vm["trace"].as<std::string>() : std::string());
+	AURORA_PROFILE_ZONE("atexturec");
+
 	auto inputPath = vm["input-file"].as<std::string>();
 	auto outputPath = vm["output-file"].as<std::string>();
 	auto texturePath = vm["texture-path"].as<std::string>();